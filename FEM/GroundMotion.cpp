@@ -41,14 +41,11 @@ GroundMotion::GroundMotion(TimeSeries *dispSeries,
 			   double dTintegration, double factor)
 : theAccelSeries(accelSeries), theVelSeries(velSeries),
  theDispSeries(dispSeries), theIntegrator(theIntegratr),
- data(3), delta(dTintegration), fact(factor)
+ data(3), delta(dTintegration), fact(factor),
+ integratedVel(velSeries == 0), integratedDisp(dispSeries == 0),
+ cachedPeaks(0), peakAccel(0.0), peakVel(0.0), peakDisp(0.0)
 {
-
-  if (theAccelSeries != 0 && theVelSeries == 0 ) 
-    theVelSeries = this->integrate(theAccelSeries, delta);
-
-  if (theVelSeries != 0 && theDispSeries == 0 ) 
-    theDispSeries = this->integrate(theVelSeries, delta);
+  this->integrateMissing();
 }
 
 
@@ -56,7 +53,9 @@ GroundMotion::GroundMotion(TimeSeries *dispSeries,
 GroundMotion::GroundMotion(int theClassTag)
 :
  theAccelSeries(0), theVelSeries(0), theDispSeries(0), theIntegrator(0),
- data(3), delta(0.0), fact(1.0)
+ data(3), delta(0.0), fact(1.0),
+ integratedVel(true), integratedDisp(true),
+ cachedPeaks(0), peakAccel(0.0), peakVel(0.0), peakDisp(0.0)
 {
 
 }
@@ -81,6 +80,82 @@ GroundMotion::setIntegrator(TimeSeriesIntegrator *integrator)
     delete theIntegrator;
 
   theIntegrator = integrator;
+
+  // the series integrated with the old integrator are done again
+  if (integratedVel && theVelSeries != 0) {
+    delete theVelSeries;
+    theVelSeries = 0;
+  }
+  if (integratedDisp && theDispSeries != 0) {
+    delete theDispSeries;
+    theDispSeries = 0;
+  }
+  this->integrateMissing();
+  this->invalidate();
+}
+
+void
+GroundMotion::integrateMissing(void)
+{
+  if (theAccelSeries != 0 && theVelSeries == 0 ) 
+    theVelSeries = this->integrate(theAccelSeries, delta);
+
+  if (theVelSeries != 0 && theDispSeries == 0 ) 
+    theDispSeries = this->integrate(theVelSeries, delta);
+}
+
+void
+GroundMotion::invalidate(void)
+{
+  cachedPeaks = 0;
+  accelSamples.clear();
+  velSamples.clear();
+  dispSamples.clear();
+}
+
+const std::vector<double> &
+GroundMotion::samples(TimeSeries *theSeries, std::vector<double> &cache)
+{
+  if (!cache.empty() || theSeries == 0 || delta <= 0.0)
+    return cache;
+
+  // the three arrays have the length of the accelerations if there are any
+  double duration = theAccelSeries != 0 ? theAccelSeries->getDuration() : theSeries->getDuration();
+  // Add one to get ceiling out of type cast
+  int numSteps = (int)(duration/delta + 1.0);
+  if (numSteps < 1)
+    return cache;
+
+  cache.resize(numSteps);
+  theSeries->getFactors(0.0, delta, &cache[0], numSteps);
+  if (fact != 1.0)
+    for (int i = 0; i < numSteps; i++)
+      cache[i] *= fact;
+  return cache;
+}
+
+const std::vector<double> &
+GroundMotion::getAccelSamples(void)
+{
+  return this->samples(theAccelSeries, accelSamples);
+}
+
+const std::vector<double> &
+GroundMotion::getVelSamples(void)
+{
+  // integrates the accelerations if needed
+  if (theVelSeries == 0)
+    this->getPeakVel();
+  return this->samples(theVelSeries, velSamples);
+}
+
+const std::vector<double> &
+GroundMotion::getDispSamples(void)
+{
+  // integrates the velocities if needed
+  if (theDispSeries == 0)
+    this->getPeakDisp();
+  return this->samples(theDispSeries, dispSamples);
 }
 
 TimeSeries*
@@ -124,59 +199,51 @@ GroundMotion::getDuration(void)
 double 
 GroundMotion::getPeakAccel(void)
 {
-  if (theAccelSeries != 0)
-    return fact*(theAccelSeries->getPeakFactor());
-  else
-    return 0.0;
-
+  if ((cachedPeaks & PeakAccel) == 0) {
+    peakAccel = 0.0;
+    if (theAccelSeries != 0)
+      peakAccel = fact*(theAccelSeries->getPeakFactor());
+    cachedPeaks |= PeakAccel;
+  }
+  return peakAccel;
 }
 
 double 
 GroundMotion::getPeakVel(void)
 {
-  if (theVelSeries != 0)
-    return fact*(theVelSeries->getPeakFactor());
+  if ((cachedPeaks & PeakVel) != 0)
+    return peakVel;
 
   // if theAccel is not 0, integrate accel series to get a vel series
-  else if (theAccelSeries != 0) {
+  if (theVelSeries == 0 && theAccelSeries != 0)
     theVelSeries = this->integrate(theAccelSeries, delta);
-    if (theVelSeries != 0)
-      return fact*(theVelSeries->getPeakFactor());      
-    else
-      return 0.0;
-  }
-  return 0.0;
+
+  peakVel = 0.0;
+  if (theVelSeries != 0)
+    peakVel = fact*(theVelSeries->getPeakFactor());
+  cachedPeaks |= PeakVel;
+  return peakVel;
 }
 
 double 
 GroundMotion::getPeakDisp(void)
 {
-  if (theDispSeries != 0)
-    return fact*(theDispSeries->getPeakFactor());
+  if ((cachedPeaks & PeakDisp) != 0)
+    return peakDisp;
 
-  // if theVel is not 0, integrate vel series to get disp series
-  else if (theVelSeries != 0) {
-    theDispSeries = this->integrate(theVelSeries, delta);
-    if (theDispSeries != 0)
-      return fact*(theDispSeries->getPeakFactor());      
-    else
-      return 0.0;
-  }
-
-  // if theAccel is not 0, integrate vel series to get disp series
-  else if (theAccelSeries != 0) {
-    theVelSeries = this->integrate(theAccelSeries, delta);
-    if (theVelSeries != 0) {
+  // integrate the vel series, from the accel series if needed
+  if (theDispSeries == 0) {
+    if (theVelSeries == 0 && theAccelSeries != 0)
+      theVelSeries = this->integrate(theAccelSeries, delta);
+    if (theVelSeries != 0)
       theDispSeries = this->integrate(theVelSeries, delta);
-      if (theDispSeries != 0)
-	return fact*(theDispSeries->getPeakFactor());      
-      else
-	return 0.0;
-    } else
-      return 0.0;
   }
 
-  return 0.0;
+  peakDisp = 0.0;
+  if (theDispSeries != 0)
+    peakDisp = fact*(theDispSeries->getPeakFactor());
+  cachedPeaks |= PeakDisp;
+  return peakDisp;
 }
 
 double 
@@ -42,6 +42,7 @@
 #include <TimeSeries.h>
 #include <TimeSeriesIntegrator.h>
 #include <Vector.h>
+#include <vector>
 
 class GroundMotion
 {
@@ -66,9 +67,22 @@ class GroundMotion
     virtual double getDisp(double time);
     virtual const  Vector &getDispVelAccel(double time);
     
+    // velocities and displacements that were not given are integrated again
     void setIntegrator(TimeSeriesIntegrator *integrator);
     TimeSeries *integrate(TimeSeries *theSeries, double delta = 0.01); 
 
+    // the motion at 0, delta, 2*delta, ... up to the duration, including
+    // fact; computed on first use with one bulk call per series (velocity
+    // and displacement from the integrated series if they were not given)
+    // and kept, like the peaks, until invalidate()
+    const std::vector<double> &getAccelSamples(void);
+    const std::vector<double> &getVelSamples(void);
+    const std::vector<double> &getDispSamples(void);
+    double getSampleIncr(void) const {return delta;}
+
+    // drop the cached samples and peaks, to be called if a series changed
+    void invalidate(void);
+
     const TimeSeries *getAccelSeries(void) const {return theAccelSeries;}
 
   protected:
@@ -79,9 +93,20 @@ class GroundMotion
     TimeSeries *theDispSeries;	 // Ground displacement
     TimeSeriesIntegrator *theIntegrator;
     
+    const std::vector<double> &samples(TimeSeries *theSeries, std::vector<double> &cache);
+    void integrateMissing(void);
+
     Vector data;
     double delta;
     double fact;
+    // theVelSeries / theDispSeries come from integrate(), not the caller
+    bool integratedVel, integratedDisp;
+
+    // cached results, see invalidate()
+    enum {PeakAccel = 1, PeakVel = 2, PeakDisp = 4};
+    int cachedPeaks;
+    double peakAccel, peakVel, peakDisp;
+    std::vector<double> accelSamples, velSamples, dispSamples;
 };
 
 #endif
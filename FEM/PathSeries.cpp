@@ -193,6 +193,35 @@ PathSeries::getFactor(double pseudoTime)
   }
 }
 
+void
+PathSeries::getFactors(double tStart, double timeIncr,
+                       double *factors, int numFactors)
+{
+  if (thePath == 0) {
+    for (int i = 0; i < numFactors; i++)
+      factors[i] = 0.0;
+    return;
+  }
+
+  // getFactor() without the virtual call and the checks of each time
+  const double *path = &(*thePath)(0);
+  int size = thePath->Size();
+  double last = useLast ? cFactor*path[size-1] : 0.0;
+  for (int i = 0; i < numFactors; i++) {
+    double pseudoTime = tStart + i*timeIncr;
+    if (pseudoTime < startTime) {
+      factors[i] = 0.0;
+      continue;
+    }
+    double incr = (pseudoTime-startTime)/pathTimeIncr;
+    int incr1 = floor(incr);
+    if (incr1+1 >= size)
+      factors[i] = last;
+    else
+      factors[i] = cFactor*(path[incr1] + (path[incr1+1]-path[incr1])*(incr - incr1));
+  }
+}
+
 double
 PathSeries::getDuration()
 {
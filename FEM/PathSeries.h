@@ -66,6 +66,8 @@ class PathSeries : public TimeSeries
     
     // method to get factor
     double getFactor(double pseudoTime);
+    void getFactors(double startTime, double timeIncr,
+                    double *factors, int numFactors);
     double getDuration ();
     double getPeakFactor ();
     double getTimeIncr (double pseudoTime) {return pathTimeIncr;}
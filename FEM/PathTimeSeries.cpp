@@ -38,6 +38,7 @@
 #include <PathTimeSeries.h>
 #include <Vector.h>
 #include <math.h>
+#include <algorithm>
 #include <iostream>
 
 #include <fstream>
@@ -48,7 +49,7 @@ using std::ios;
 
 PathTimeSeries::PathTimeSeries()	
   :TimeSeries(0),
-   thePath(0), time(0), currentTimeLoc(0), cFactor(0.0),
+   thePath(0), time(0), timeStep(0.0), cFactor(0.0),
    dbTag1(0), dbTag2(0), lastSendCommitTag(-1)
 {
   // does nothing
@@ -60,7 +61,7 @@ PathTimeSeries::PathTimeSeries(int tag,
 			       double theFactor,
 			       bool last)
   :TimeSeries(tag, 0),
-   thePath(0), time(0), currentTimeLoc(0), cFactor(theFactor),
+   thePath(0), time(0), timeStep(0.0), cFactor(theFactor),
    dbTag1(0), dbTag2(0), lastSendCommitTag(-1),
    useLast(last)
 {
@@ -87,115 +88,54 @@ PathTimeSeries::PathTimeSeries(int tag,
       time = 0;
     }
   }
+
+  if (thePath != 0)
+    this->findTimeStep();
 }
 
 PathTimeSeries::PathTimeSeries(int tag,
-			       const char *filePathName, 
-			       const char *fileTimeName, 
+			       std::shared_ptr<const std::vector<double> > theLoadPath,
+			       std::shared_ptr<const std::vector<double> > theTimePath,
 			       double theFactor,
 			       bool last)
   :TimeSeries(tag, 0),
-   thePath(0), time(0), currentTimeLoc(0), cFactor(theFactor),
+   thePath(0), time(0), timeStep(0.0), cFactor(theFactor),
    dbTag1(0), dbTag2(0), lastSendCommitTag(-1),
    useLast(last)
 {
-  // determine the number of data points
-  int numDataPoints1 =0;
-  int numDataPoints2 =0;
-  double dataPoint;
-  ifstream theFile;
-  
-  // first open and go through file containing path
-  theFile.open(filePathName, ios::in);
-  if (theFile.bad() || !theFile.is_open()) {
-    std::cerr << "WARNING - PathTimeSeries::PathTimeSeries()";
-    std::cerr << " - could not open file " << filePathName << "\n";
-  } else {
-    while (theFile >> dataPoint)
-      numDataPoints1++;
-  }   
-  theFile.close();
-
-  // now open and go through file containing time
-  ifstream theFile1;
-  theFile1.open(fileTimeName, ios::in);
-  if (theFile1.bad() || !theFile1.is_open()) {
-    std::cerr << "WARNING - PathTimeSeries::PathTimeSeries()";
-    std::cerr << " - could not open file " << fileTimeName << "\n";
-  } else {
-    while (theFile1 >> dataPoint)
-      numDataPoints2++;
-  }   
-  theFile1.close();
-
-  // check number of data entries in both are the same
-  if (numDataPoints1 != numDataPoints2) {
-    std::cerr << "WARNING PathTimeSeries::PathTimeSeries() - files containing data ";
-    std::cerr << "points for path and time do not contain same number of points\n";
-  } else {
-
+  this->setSamples(theLoadPath, theTimePath);
+}
 
-    // create a vector and read in the data
-    if (numDataPoints1 != 0) {
-
-      // now create the two vector
-      thePath = new Vector(numDataPoints1);
-      time = new Vector(numDataPoints1);
-
-      // ensure did not run out of memory creating copies
-      if (thePath == 0 || thePath->Size() == 0 ||
-	  time == 0 || time->Size() == 0) {
-	  
-        std::cerr << "WARNING PathTimeSeries::PathTimeSeries() - out of memory\n ";
-	if (thePath != 0)
-	  delete thePath;
-	if (time != 0)
-	  delete time;
-	thePath = 0;
-	time = 0;
-      }
-      
-      // first open the path file and read in the data
-      ifstream theFile2;
-      theFile2.open(filePathName, ios::in);
-      if (theFile2.bad() || !theFile2.is_open()) {
+// all the numbers in a file, read in one pass
+static bool
+readValues(const char *fileName, std::vector<double> &values)
+{
+  ifstream theFile(fileName, ios::in);
+  if (theFile.bad() || !theFile.is_open()) {
     std::cerr << "WARNING - PathTimeSeries::PathTimeSeries()";
-    std::cerr << " - could not open file " << filePathName << "\n";
-	delete thePath;
-	delete time;
-	thePath = 0;
-	time =0;
-      } else { // read in the path data and then do the time
-	int count = 0;
-	while (theFile2 >> dataPoint) {
-	  (*thePath)(count) = dataPoint;
-	  count++;
-	}
-
-	// finally close the file
-	theFile2.close();
-
-	// now open the time file and read in the data
-	ifstream theFile3;
-	theFile3.open(fileTimeName, ios::in);
-	if (theFile3.bad() || !theFile3.is_open()) {
-      std::cerr << "WARNING - PathTimeSeries::PathTimeSeries()";
-      std::cerr << " - could not open file " << fileTimeName << "\n";
-	  delete thePath;
-	  delete time;
-	  thePath = 0;
-	  time =0;
-	} else { // read in the data
-	  int count = 0;
-	  while (theFile3 >> dataPoint) {
-	    (*time)(count) = dataPoint;
-	    count++;
-	  }
-	  theFile3.close();
-	} // read in the data 
-      }   // read in the path data and then do the time
-    }
+    std::cerr << " - could not open file " << fileName << "\n";
+    return false;
   }
+  double dataPoint;
+  while (theFile >> dataPoint)
+    values.push_back(dataPoint);
+  return true;
+}
+
+PathTimeSeries::PathTimeSeries(int tag,
+			       const char *filePathName, 
+			       const char *fileTimeName, 
+			       double theFactor,
+			       bool last)
+  :TimeSeries(tag, 0),
+   thePath(0), time(0), timeStep(0.0), cFactor(theFactor),
+   dbTag1(0), dbTag2(0), lastSendCommitTag(-1),
+   useLast(last)
+{
+  std::shared_ptr<std::vector<double> > path = std::make_shared<std::vector<double> >();
+  std::shared_ptr<std::vector<double> > times = std::make_shared<std::vector<double> >();
+  if (readValues(filePathName, *path) && readValues(fileTimeName, *times))
+    this->setSamples(path, times);
 }
 
 PathTimeSeries::PathTimeSeries(int tag,
@@ -203,81 +143,69 @@ PathTimeSeries::PathTimeSeries(int tag,
 			       double theFactor,
 			       bool last)
   :TimeSeries(tag, 0),
-   thePath(0), time(0), currentTimeLoc(0), cFactor(theFactor),
-   dbTag1(0), dbTag2(0), useLast(last)
+   thePath(0), time(0), timeStep(0.0), cFactor(theFactor),
+   dbTag1(0), dbTag2(0), lastSendCommitTag(-1),
+   useLast(last)
 {
-  // determine the number of data points
-  int numDataPoints = 0;
-  double dataPoint;
-  ifstream theFile;
-  
-  // first open and go through file counting entries
-  theFile.open(fileName, ios::in);
-  if (theFile.bad() || !theFile.is_open()) {
-    std::cerr << "WARNING - PathTimeSeries::PathTimeSeries()";
-    std::cerr << " - could not open file " << fileName << "\n";
-  }
-  else {
-    while (theFile >> dataPoint) {
-      numDataPoints++;
-      theFile >> dataPoint;	// Read in second value of pair
-    }
-  }
+  // time and value pairs
+  std::vector<double> values;
+  if (!readValues(fileName, values))
+    return;
 
-  if ((numDataPoints % 2) != 0) {
+  if ((values.size() % 2) != 0) {
     std::cerr << "WARNING - PathTimeSeries::PathTimeSeries()";
     std::cerr << " - num data entries in file NOT EVEN! " << fileName << "\n";
-    numDataPoints--;
   }
 
+  size_t numDataPoints = values.size() / 2;
+  std::shared_ptr<std::vector<double> > path = std::make_shared<std::vector<double> >(numDataPoints);
+  std::shared_ptr<std::vector<double> > times = std::make_shared<std::vector<double> >(numDataPoints);
+  for (size_t i = 0; i < numDataPoints; i++) {
+    (*times)[i] = values[2*i];
+    (*path)[i] = values[2*i+1];
+  }
+  this->setSamples(path, times);
+}
 
-  theFile.close();
-
-  // create a vector and read in the data
-  if (numDataPoints != 0) {
-    
-    // now create the two vector
-    thePath = new Vector(numDataPoints/2);
-    time = new Vector(numDataPoints/2);
-    
-    // ensure did not run out of memory creating copies
-    if (thePath == 0 || thePath->Size() == 0 || time == 0 || time->Size() == 0) {
-      
-      std::cerr << "WARNING PathTimeSeries::PathTimeSeries() - out of memory\n ";
-      if (thePath != 0)
-	delete thePath;
-      if (time != 0)
-	delete time;
-      thePath = 0;
-      time = 0;
-    }
-    
-    // first open the file and read in the data
-    ifstream theFile1;
-    theFile1.open(fileName, ios::in);
-    if (theFile1.bad() || !theFile1.is_open()) {
-      
-      std::cerr << "WARNING - PathTimeSeries::PathTimeSeries()";
-      std::cerr << " - could not open file " << fileName << "\n";
-      delete thePath;
-      delete time;
-      thePath = 0;
-      time =0;
-    }
-    else { // read in the time and then read the value
-      int count = 0;
-      while (theFile1 >> dataPoint) {
-	(*time)(count) = dataPoint;
-	theFile1 >> dataPoint;
-	(*thePath)(count) = dataPoint;
-
-	count++;
-      }
-      
-      // finally close the file
-      theFile1.close();
-    } 
+void
+PathTimeSeries::setSamples(std::shared_ptr<const std::vector<double> > theLoadPath,
+			   std::shared_ptr<const std::vector<double> > theTimePath)
+{
+  if (!theLoadPath || !theTimePath || theLoadPath->size() != theTimePath->size()) {
+    std::cerr << "WARNING PathTimeSeries::PathTimeSeries() - data ";
+    std::cerr << "points for path and time are not of the same size\n";
+    return;
   }
+  if (theLoadPath->empty())
+    return;
+
+  // the vectors only point to the samples, which are never modified
+  pathData = theLoadPath;
+  timeData = theTimePath;
+  int size = int(pathData->size());
+  thePath = new Vector(const_cast<double *>(pathData->data()), size);
+  time = new Vector(const_cast<double *>(timeData->data()), size);
+  this->findTimeStep();
+}
+
+// evenly spaced time points (to a relative 1e-6 of the step) are found
+// without a search
+void
+PathTimeSeries::findTimeStep(void)
+{
+  timeStep = 0.0;
+  int size = time->Size();
+  if (size < 2)
+    return;
+
+  double dt = (*time)(1) - (*time)(0);
+  if (dt <= 0.0)
+    return;
+  double tol = 1.0e-6 * dt;
+  for (int i = 2; i < size; i++)
+    if (fabs((*time)(i) - (*time)(i-1) - dt) > tol)
+      return;
+  timeStep = dt;
 }
 
 PathTimeSeries::~PathTimeSeries()
@@ -291,6 +219,8 @@ PathTimeSeries::~PathTimeSeries()
 TimeSeries *
 PathTimeSeries::getCopy(void) 
 {
+  if (pathData)
+    return new PathTimeSeries(this->getTag(), pathData, timeData, cFactor, useLast);
   return new PathTimeSeries(this->getTag(), *thePath, *time, cFactor, useLast);
 }
 
@@ -304,61 +234,109 @@ PathTimeSeries::getTimeIncr (double pseudoTime)
 double
 PathTimeSeries::getFactor(double pseudoTime)
 {
-  // check for a quick return
-  if (thePath == 0)
-    return 0.0;
+  return this->getFactorAt(pseudoTime);
+}
 
-  // determine indexes into the data array whose boundary holds the time
-  double time1 = (*time)(currentTimeLoc);
+// index i of the interval time(i) <= pseudoTime <= time(i+1), for
+// time(0) < pseudoTime < time(size-1)
+int
+PathTimeSeries::findInterval(double pseudoTime) const
+{
+  const double *t = &(*time)(0);
+  int sizem2 = time->Size() - 2;
+
+  if (timeStep > 0.0) {
+    int i = int((pseudoTime - t[0]) / timeStep);
+    if (i > sizem2)
+      i = sizem2;
+    if (i < 0)
+      i = 0;
+    // the time points are only even to the tolerance, and the division rounds
+    while (i > 0 && pseudoTime < t[i])
+      i--;
+    while (i < sizem2 && pseudoTime > t[i+1])
+      i++;
+    return i;
+  }
+
+  int i = int(std::upper_bound(t, t + sizem2 + 2, pseudoTime) - t) - 1;
+  if (i > sizem2)
+    i = sizem2;
+  if (i < 0)
+    i = 0;
+  return i;
+}
 
-  // check for another quick return
-  if (pseudoTime < time1 && currentTimeLoc == 0)
+double
+PathTimeSeries::getFactorAt(double pseudoTime) const
+{
+  // check for a quick return
+  if (thePath == 0)
     return 0.0;
-  if (pseudoTime == time1)
-    return cFactor * (*thePath)[currentTimeLoc];
 
   int size = time->Size();
   int sizem1 = size - 1;
-  int sizem2 = size - 2;
-  
-  // check we are not at the end
-  if (pseudoTime > time1 && currentTimeLoc == sizem1) {
+  double timeFirst = (*time)(0);
+  double timeLast = (*time)(sizem1);
+
+  // before the first (or NaN) and after the last point
+  if (!(pseudoTime >= timeFirst))
+    return 0.0;
+  if (pseudoTime > timeLast) {
     if (useLast == false)
       return 0.0;
     else
-      return cFactor*(*thePath)[sizem1];
+      return cFactor*(*thePath)(sizem1);
   }
+  if (pseudoTime == timeLast)
+    return cFactor*(*thePath)(sizem1);
+  if (pseudoTime == timeFirst)
+    return cFactor*(*thePath)(0);
+
+  int i = this->findInterval(pseudoTime);
+  double time1 = (*time)(i);
+  double time2 = (*time)(i+1);
+  if (pseudoTime == time1)
+    return cFactor*(*thePath)(i);
 
-  // otherwise go find the current interval
-  double time2 = (*time)(currentTimeLoc+1);
-  if (pseudoTime > time2) {
-    while ((pseudoTime > time2) && (currentTimeLoc < sizem2)) {
-      currentTimeLoc++;
-      time1 = time2;
-      time2 = (*time)(currentTimeLoc+1);
-    }
-    // if pseudo time greater than ending time return 0
-    if (pseudoTime > time2) {
-      if (useLast == false)
-        return 0.0;
-      else
-        return cFactor*(*thePath)[sizem1];
-    }
+  double value1 = (*thePath)(i);
+  double value2 = (*thePath)(i+1);
+  return cFactor*(value1 + (value2-value1)*(pseudoTime-time1)/(time2 - time1));
+}
 
-  } else if (pseudoTime < time1) {
-    while ((pseudoTime < time1) && (currentTimeLoc > 0)) {
-      currentTimeLoc--;
-      time2 = time1;	
-      time1 = (*time)(currentTimeLoc);
-    }
-    // if starting time less than initial starting time return 0
-    if (pseudoTime < time1)
-      return 0.0;
+void
+PathTimeSeries::getFactors(double startTime, double timeIncr,
+			   double *factors, int numFactors)
+{
+  if (thePath == 0 || timeIncr <= 0.0 || time->Size() < 2) {
+    for (int i = 0; i < numFactors; i++)
+      factors[i] = this->getFactorAt(startTime + i*timeIncr);
+    return;
   }
 
-  double value1 = (*thePath)[currentTimeLoc];
-  double value2 = (*thePath)[currentTimeLoc+1];
-  return cFactor*(value1 + (value2-value1)*(pseudoTime-time1)/(time2 - time1));
+  const double *t = &(*time)(0);
+  const double *path = &(*thePath)(0);
+  int sizem1 = time->Size() - 1;
+  int loc = -1;
+  for (int i = 0; i < numFactors; i++) {
+    double pseudoTime = startTime + i*timeIncr;
+    // ends and sample times as getFactorAt()
+    if (!(pseudoTime > t[0]) || !(pseudoTime < t[sizem1])) {
+      factors[i] = this->getFactorAt(pseudoTime);
+      continue;
+    }
+    if (loc < 0)
+      loc = this->findInterval(pseudoTime);
+    while (loc < sizem1-1 && pseudoTime >= t[loc+1])
+      loc++;
+    if (pseudoTime == t[loc]) {
+      factors[i] = cFactor*path[loc];
+      continue;
+    }
+    double time1 = t[loc];
+    double time2 = t[loc+1];
+    factors[i] = cFactor*(path[loc] + (path[loc+1]-path[loc])*(pseudoTime-time1)/(time2 - time1));
+  }
 }
 
 double
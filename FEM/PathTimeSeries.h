@@ -39,6 +39,8 @@
 // What: "@(#) PathTimeSeries.h, revA"
 
 #include <TimeSeries.h>
+#include <memory>
+#include <vector>
 
 class Vector;
 
@@ -52,6 +54,14 @@ class PathTimeSeries : public TimeSeries
 		 double cfactor = 1.0,
          bool useLast = false);
   
+  // shares the samples instead of copying them, e.g. one time vector
+  // for the acc, vel and disp series of a motion
+  PathTimeSeries(int tag,
+		 std::shared_ptr<const std::vector<double> > thePath,
+		 std::shared_ptr<const std::vector<double> > theTime,
+		 double cfactor = 1.0,
+         bool useLast = false);
+
   PathTimeSeries(int tag,
 		 const char *fileNamePath, 
 		 const char *fileNameTime, 
@@ -72,6 +82,13 @@ class PathTimeSeries : public TimeSeries
 
     // method to get factor
     double getFactor(double pseudoTime);
+    // the same without any state: the sample interval is computed from the
+    // time step if the time points are evenly spaced, found by bisection
+    // otherwise, so one series can be read from several threads
+    double getFactorAt(double pseudoTime) const;
+    // increasing times are found by one sweep through the time points
+    void getFactors(double startTime, double timeIncr,
+                    double *factors, int numFactors);
     double getDuration ();
     double getPeakFactor ();
     double getTimeIncr (double pseudoTime);
@@ -81,13 +98,21 @@ class PathTimeSeries : public TimeSeries
   protected:
     
   private:
+    void setSamples(std::shared_ptr<const std::vector<double> > thePath,
+		    std::shared_ptr<const std::vector<double> > theTime);
+    void findTimeStep(void);
+    int findInterval(double pseudoTime) const;
+
     Vector *thePath;      // vector containg the data points
     Vector *time;		  // vector containg the time values of data points
-    int currentTimeLoc;   // current location in time
+    double timeStep;      // constant time step, 0.0 if the time points are uneven
     double cFactor;       // additional factor on the returned load factor
     int dbTag1, dbTag2;   // additional database tags needed for vector objects
     int lastSendCommitTag;
     bool useLast;
+    // owners of the samples thePath and time point to
+    std::shared_ptr<const std::vector<double> > pathData;
+    std::shared_ptr<const std::vector<double> > timeData;
 };
 
 #endif
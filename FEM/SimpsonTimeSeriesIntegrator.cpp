@@ -0,0 +1,101 @@
+/* ****************************************************************** **
+**    OpenSees - Open System for Earthquake Engineering Simulation    **
+**          Pacific Earthquake Engineering Research Center            **
+**                                                                    **
+**                                                                    **
+** (C) Copyright 1999, The Regents of the University of California    **
+** All Rights Reserved.                                               **
+**                                                                    **
+** Commercial use of this program without express permission of the   **
+** University of California, Berkeley, is strictly prohibited.  See   **
+** file 'COPYRIGHT'  in main directory for information on usage and   **
+** redistribution,  and for a DISCLAIMER OF ALL WARRANTIES.           **
+**                                                                    **
+** Developed by:                                                      **
+**   Frank McKenna (fmckenna@ce.berkeley.edu)                         **
+**   Gregory L. Fenves (fenves@ce.berkeley.edu)                       **
+**   Filip C. Filippou (filippou@ce.berkeley.edu)                     **
+**                                                                    **
+** ****************************************************************** */
+                                                                        
+// File: ~/domain/pattern/SimpsonTimeSeriesIntegrator.cpp
+// 
+// Description: This file contains the class definition for 
+// a SimpsonTimeSeriesIntegrator, which integrates a
+// ground motion TimeSeries using Simpson's rule on each step.
+// The series is sampled at the ends and the middle of every step.
+//
+// What: "@(#) SimpsonTimeSeriesIntegrator.cpp, revA"
+
+#include <SimpsonTimeSeriesIntegrator.h>
+#include <classTags.h>
+#include <Vector.h>
+#include <PathSeries.h>
+#include <vector>
+#include <iostream>
+
+SimpsonTimeSeriesIntegrator::SimpsonTimeSeriesIntegrator() 
+  :TimeSeriesIntegrator(TIMESERIES_INTEGRATOR_TAG_Simpson)
+{
+
+}
+
+SimpsonTimeSeriesIntegrator::~SimpsonTimeSeriesIntegrator()
+{
+
+}
+
+TimeSeries*
+SimpsonTimeSeriesIntegrator::integrate(TimeSeries *theSeries, double delta)
+{	
+  // Check for zero time step, before dividing to get number of steps
+  if (delta <= 0.0) {
+    std::cerr << "SimpsonTimeSeriesIntegrator::integrate() Attempting to integrate time step" <<
+      delta << "<= 0\n";
+    return 0;
+   }
+
+  // check a TimeSeries object was passed
+  if (theSeries == 0) {
+    std::cerr << "SimpsonTimeSeriesIntegrator::integrate() - - no TimeSeries passed\n";
+    return 0;
+  }
+
+  // Add one to get ceiling out of type cast
+  int numSteps = (int)(theSeries->getDuration()/delta + 1.0);
+
+  if (numSteps < 1) {
+    std::cerr << "SimpsonTimeSeriesIntegrator::integrate() no steps to integrate, duration " <<
+      theSeries->getDuration() << "\n";
+    return 0;
+  }
+
+  // the samples at 0, delta/2, delta, ... at once
+  std::vector<double> samples(2*numSteps - 1);
+  theSeries->getFactors(0.0, delta*0.5, &samples[0], 2*numSteps - 1);
+
+  Vector theIntegratedValues(numSteps);
+  double *values = &theIntegratedValues(0);
+
+  // the area of each step, the integral starts from F(0) = 0 ...
+  double sixthDelta = delta/6.0;
+  const double *f = &samples[0];
+  values[0] = 0.0;
+  for (int i = 1; i < numSteps; i++)
+    values[i] = sixthDelta * (f[2*i-2] + 4.0*f[2*i-1] + f[2*i]);
+
+  // ... and their running sum
+  for (int i = 1; i < numSteps; i++)
+    values[i] += values[i-1];
+
+  // Set the method return value
+  PathSeries *returnSeries = new PathSeries (0, theIntegratedValues, delta, true);
+
+  if (returnSeries == 0) {
+    std::cerr << "SimpsonTimeSeriesIntegrator::integrate() Ran out of memory creating PathSeries\n";
+
+    return 0;
+   }
+
+  return returnSeries;
+}
@@ -0,0 +1,51 @@
+/* ****************************************************************** **
+**    OpenSees - Open System for Earthquake Engineering Simulation    **
+**          Pacific Earthquake Engineering Research Center            **
+**                                                                    **
+**                                                                    **
+** (C) Copyright 1999, The Regents of the University of California    **
+** All Rights Reserved.                                               **
+**                                                                    **
+** Commercial use of this program without express permission of the   **
+** University of California, Berkeley, is strictly prohibited.  See   **
+** file 'COPYRIGHT'  in main directory for information on usage and   **
+** redistribution,  and for a DISCLAIMER OF ALL WARRANTIES.           **
+**                                                                    **
+** Developed by:                                                      **
+**   Frank McKenna (fmckenna@ce.berkeley.edu)                         **
+**   Gregory L. Fenves (fenves@ce.berkeley.edu)                       **
+**   Filip C. Filippou (filippou@ce.berkeley.edu)                     **
+**                                                                    **
+** ****************************************************************** */
+                                                                        
+// File: src/domain/SimpsonTimeSeriesIntegrator.h
+// 
+// Description: This file contains the class definition for 
+// a SimpsonTimeSeriesIntegrator, which integrates a
+// ground motion TimeSeries using Simpson's rule on each step,
+// starting from zero at time 0. The midpoint samples pick up a
+// record that is finer than the integration step.
+//
+// What: "@(#) SimpsonTimeSeriesIntegrator.h, revA"
+
+#ifndef SimpsonTimeSeriesIntegrator_h
+#define SimpsonTimeSeriesIntegrator_h
+
+#include <TimeSeriesIntegrator.h>
+
+class SimpsonTimeSeriesIntegrator : public TimeSeriesIntegrator
+{
+   public:
+      SimpsonTimeSeriesIntegrator();
+
+      ~SimpsonTimeSeriesIntegrator();
+
+      TimeSeries* integrate(TimeSeries *theTimeSeries, double delta);
+
+
+   protected:
+
+   private:
+};
+
+#endif
@@ -77,6 +77,14 @@ TimeSeries::TimeSeries(int classTag)
 
 }
 
+void
+TimeSeries::getFactors(double startTime, double timeIncr,
+                       double *factors, int numFactors)
+{
+  for (int i = 0; i < numFactors; i++)
+    factors[i] = this->getFactor(startTime + i*timeIncr);
+}
+
 TimeSeries::~TimeSeries()
 {
 
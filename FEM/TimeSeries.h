@@ -58,6 +58,12 @@ class TimeSeries : public TaggedObject
 
     virtual double getTimeIncr (double pseudoTime) = 0;
 
+    // factors at startTime, startTime+timeIncr, ... (numFactors of them),
+    // the same as getFactor() at each time; series that can do better
+    // than one virtual call per time override it
+    virtual void getFactors(double startTime, double timeIncr,
+                            double *factors, int numFactors);
+
 
   protected:
 
@@ -75,53 +75,31 @@ TrapezoidalTimeSeriesIntegrator::integrate(TimeSeries *theSeries, double delta)
   // Add one to get ceiling out of type cast
   int numSteps = (int)(theSeries->getDuration()/delta + 1.0);
 
-  Vector *theIntegratedValues = new Vector (numSteps);
-
-  // Check that the Vector was allocated properly
-  if (theIntegratedValues == 0 || theIntegratedValues->Size() == 0) {
-    std::cerr << "TrapezoidalTimeSeriesIntegrator::integrate() Ran out of memory allocating Vector of size " <<
-      numSteps << "\n";
-
-    if (theIntegratedValues != 0)
-      delete theIntegratedValues;
-
+  if (numSteps < 1) {
+    std::cerr << "TrapezoidalTimeSeriesIntegrator::integrate() no steps to integrate, duration " <<
+      theSeries->getDuration() << "\n";
     return 0;
   }
 
-  int i;                // Counter for indexing
-  double dummyTime;     // Dummy variable for integrating
-  double previousValue; // Temporary storage to avoid accessing same value twice
-	                        // through identical method calls
-  double currentValue;
-      
-  // Set the first point
-  // Assuming initial condition is zero, i.e. F(0) = 0
-
-
-  (*theIntegratedValues)[0] = theSeries->getFactor(0.0) * delta * 0.5;
-
-  previousValue = (*theIntegratedValues)[0];
-  
-  dummyTime = delta;
-    
-  for (i = 1; i < numSteps; i++, dummyTime += delta) {
-    currentValue = theSeries->getFactor(dummyTime);
-    
-    // Apply the trapezoidal rule to update the integrated value
-    (*theIntegratedValues)[i] = (*theIntegratedValues)[i-1] +
-      delta*0.5 * (currentValue + previousValue);
-    
-    previousValue = currentValue;
-  }
+  Vector theIntegratedValues(numSteps);
+  double *values = &theIntegratedValues(0);
+
+  // all the samples at once, sampled at 0, delta, 2*delta, ...
+  theSeries->getFactors(0.0, delta, values, numSteps);
+
+  // the area of each trapezoid, in place from the back (assuming the
+  // series is zero before the first point, F(0) = f(0) * delta/2) ...
+  double halfDelta = delta*0.5;
+  for (int i = numSteps-1; i > 0; i--)
+    values[i] = halfDelta * (values[i] + values[i-1]);
+  values[0] *= halfDelta;
 
-  /*
-  // Set the last point
-  (*theIntegratedValues)[i] = (*theIntegratedValues)[i-1] +
-    delta*0.5 * (theSeries->getFactor(dummyTime));
-  */
+  // ... and their running sum
+  for (int i = 1; i < numSteps; i++)
+    values[i] += values[i-1];
 
   // Set the method return value
-  PathSeries *returnSeries = new PathSeries (0, *theIntegratedValues, delta, true);
+  PathSeries *returnSeries = new PathSeries (0, theIntegratedValues, delta, true);
 
   if (returnSeries == 0) {
     std::cerr << "TrapezoidalTimeSeriesIntegrator::integrate() Ran out of memory creating PathSeries\n";
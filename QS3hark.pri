@@ -17,6 +17,7 @@
         $$PWD/FEM/TimeSeries.cpp \
         $$PWD/FEM/TimeSeriesIntegrator.cpp \
         $$PWD/FEM/TrapezoidalTimeSeriesIntegrator.cpp \
+        $$PWD/FEM/SimpsonTimeSeriesIntegrator.cpp \
         $$PWD/FEM/Vector.cpp \
         $$PWD/FEM/GroundMotion.cpp \
         $$PWD/FEM/PathTimeSeries.cpp \
@@ -27,7 +28,20 @@
         $$PWD/SiteResponse/soillayer.cpp \
         $$PWD/SiteResponse/siteLayering.cpp \
         $$PWD/SiteResponse/outcropMotion.cpp \
+        $$PWD/SiteResponse/MotionFile.cpp \
+        $$PWD/SiteResponse/MotionPreprocessor.cpp \
+        $$PWD/SiteResponse/FrequencyDomainSolver.cpp \
+        $$PWD/SiteResponse/EquivalentLinear.cpp \
+        $$PWD/SiteResponse/ResponseSpectrum.cpp \
+        $$PWD/SiteResponse/StepSizeController.cpp \
+        $$PWD/SiteResponse/ProgressChannel.cpp \
         $$PWD/UI/PostProcessor.cpp \
+        $$PWD/UI/ProfileManager.cpp \
+        $$PWD/UI/RecorderFileReader.cpp \
+        $$PWD/UI/ProgressReader.cpp \
+        $$PWD/UI/PlotDataProvider.cpp \
+        $$PWD/UI/MinMaxPyramid.cpp \
+        $$PWD/UI/ResultTable.cpp \
         $$PWD/UI/SSSharkThread.cpp
 
 
@@ -44,6 +58,7 @@
         $$PWD/FEM/TimeSeries.h \
         $$PWD/FEM/TimeSeriesIntegrator.h \
         $$PWD/FEM/TrapezoidalTimeSeriesIntegrator.h \
+        $$PWD/FEM/SimpsonTimeSeriesIntegrator.h \
         $$PWD/FEM/Vector.h \
         $$PWD/FEM/GroundMotion.h \
         $$PWD/FEM/PathTimeSeries.h \
@@ -53,8 +68,23 @@
         $$PWD/SiteResponse/EffectiveFEModel.h \
         $$PWD/SiteResponse/soillayer.h \
         $$PWD/SiteResponse/outcropMotion.h \
+        $$PWD/SiteResponse/MotionFile.h \
+        $$PWD/SiteResponse/MotionPreprocessor.h \
+        $$PWD/SiteResponse/FrequencyDomainSolver.h \
+        $$PWD/SiteResponse/EquivalentLinear.h \
+        $$PWD/SiteResponse/ResponseSpectrum.h \
+        $$PWD/SiteResponse/StepSizeController.h \
+        $$PWD/SiteResponse/ProgressChannel.h \
+        $$PWD/SiteResponse/CancelToken.h \
         $$PWD/SiteResponse/siteLayering.h \
         $$PWD/UI/PostProcessor.h \
+        $$PWD/UI/ProfileManager.h \
+        $$PWD/UI/RecorderFileReader.h \
+        $$PWD/UI/ProgressReader.h \
+        $$PWD/UI/PlotDataProvider.h \
+        $$PWD/UI/MinMaxPyramid.h \
+        $$PWD/UI/ResultTable.h \
+        $$PWD/UI/ProgressQueue.h \
         $$PWD/UI/SSSharkThread.h
 
 
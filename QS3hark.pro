@@ -4,7 +4,7 @@
 #                                                                              #
 #------------------------------------------------------------------------------#
 
-QT       += core gui quick qml webenginewidgets uitools webengine webchannel
+QT       += core gui quick qml webenginewidgets uitools webengine webchannel concurrent
 
 CONFIG += c++11 NOINTERNALFEM
 
@@ -0,0 +1,40 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+
+#ifndef CANCELTOKEN_H
+#define CANCELTOKEN_H
+
+#include <atomic>
+
+// Stop request for a running analysis.
+//
+// cancel() may be called from any thread; the analysis polls isCanceled()
+// between time steps (and between the sub steps of a step) and returns at
+// the next check, so a cancel never waits for the rest of the motion.
+class CancelToken
+{
+public:
+    CancelToken() : m_canceled(false) {}
+
+    void cancel() { m_canceled.store(true, std::memory_order_relaxed); }
+    void reset() { m_canceled.store(false, std::memory_order_relaxed); }
+    bool isCanceled() const { return m_canceled.load(std::memory_order_relaxed); }
+
+private:
+    CancelToken(const CancelToken &);
+    CancelToken &operator=(const CancelToken &);
+
+    std::atomic<bool> m_canceled;
+};
+
+#endif // CANCELTOKEN_H
@@ -11,12 +11,17 @@
 **   Update: December 2018   Charles Wang                                **
 ** ********************************************************************* */
 
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 
 #include "EffectiveFEModel.h"
+#include "StepSizeController.h"
+#include "ProgressChannel.h"
+#include "MotionFile.h"
+#include "EquivalentLinear.h"
 
 #include "Vector.h"
 //#include "Matrix.h"
@@ -202,10 +207,375 @@ SiteResponseModel::~SiteResponseModel()
     */
 }
 
+// Pick the solution time step from the frequency content the model can carry:
+// the mesh (NODES_PER_WAVELENGTH elements per shear wavelength in every layer),
+// the motion (Nyquist frequency of the record) and MAX_FREQUENCY. Newmark average
+// acceleration needs about NEWMARK_STEPS_PER_PERIOD steps per period for a small
+// period error. The step returned divides motionDT so input samples are hit exactly.
+double SiteResponseModel::getAnalysisDT(double meshFrequency, double motionDT)
+{
+    double maxFrequency = std::min(meshFrequency, MAX_FREQUENCY);
+    if (motionDT > 0.0)
+        maxFrequency = std::min(maxFrequency, 0.5 / motionDT);
+    else
+        return 0.001;
+    double maxDT = 1.0 / (NEWMARK_STEPS_PER_PERIOD * maxFrequency);
+    int subSteps = std::max(1, static_cast<int>(std::ceil(motionDT / maxDT - 1.0e-6)));
+    return motionDT / subSteps;
+}
+
+// Content hash of everything in SRT the gravity stage depends on. Settings that
+// only affect the motion, the dynamic analysis or the output are left out, so a
+// gravity checkpoint is shared by all motions run on the same profile.
+static std::string gravityProfileHash(const json &SRT, const std::string &modelType)
+{
+    json profile;
+    profile["modelType"] = modelType;
+    profile["soilProfile"] = SRT.value("soilProfile", json());
+    profile["materials"] = SRT.value("materials", json());
+    json basicSettings = SRT.value("basicSettings", json::object());
+    const char *motionKeys[] = {"OpenSeesPath", "groundMotion", "analysisDT", "dtMin", "dtMax",
+                                "recorderFormat", "reuseGravity", "outputProfile", "historyDepths"};
+    for (auto key : motionKeys)
+        basicSettings.erase(key);
+    profile["basicSettings"] = basicSettings;
+
+    // 64 bit FNV-1a
+    std::string text = profile.dump();
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        hash ^= static_cast<unsigned char>(text[i]);
+        hash *= 1099511628211ULL;
+    }
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return ss.str();
+}
+
+// Restore the committed state after gravity from checkpointDir/<hash> if it is
+// there, otherwise open the block that runs sections 1-3 (closed by writeGravitySave).
+// The restored domain must match the node and element counts and the time the
+// done file recorded when it was saved, else gravity is run again.
+static void writeGravityRestore(std::ofstream &s, const std::string &hash, const std::string &checkpointDir)
+{
+    if (checkpointDir.empty())
+        return;
+    s << "# ------------------------------------------ \n";
+    s << "# 0. Gravity checkpoint                      \n";
+    s << "# ------------------------------------------ \n \n";
+    s << "set profileHash " << hash << "\n";
+    // a script sourcing this one may set checkpointDir first (SiteResponseBatch)
+    s << "if {![info exists checkpointDir]} {" << "\n";
+    s << "	set checkpointDir {" << checkpointDir << "}" << "\n";
+    s << "}" << "\n";
+    s << "set checkpoint [file join $checkpointDir $profileHash]" << "\n";
+    s << "set restored 0" << "\n";
+    s << "if {[file exists [file join $checkpoint done]]} {" << "\n";
+    s << "	set doneFile [open [file join $checkpoint done] r]" << "\n";
+    s << "	set saved [gets $doneFile]" << "\n";
+    s << "	close $doneFile" << "\n";
+    s << "	if {[catch {database File [file join $checkpoint state]; restore 1} msg]} {" << "\n";
+    s << "		puts \"Couldn't restore the gravity checkpoint: $msg\"" << "\n";
+    s << "	} elseif {[llength $saved] != 4 || [lindex $saved 0] ne $profileHash" << "\n";
+    s << "			|| [llength [getNodeTags]] == 0 || [llength [getNodeTags]] != [lindex $saved 1]" << "\n";
+    s << "			|| [llength [getEleTags]] != [lindex $saved 2] || abs([getTime] - [lindex $saved 3]) > 1.0e-6} {" << "\n";
+    s << "		puts \"The gravity checkpoint $checkpoint does not hold the gravity stage\"" << "\n";
+    s << "	} else {" << "\n";
+    s << "		set restored 1" << "\n";
+    s << "		puts \"Restored gravity stage from $checkpoint\"" << "\n";
+    s << "	}" << "\n";
+    s << "	if {!$restored} {" << "\n";
+    s << "		wipe" << "\n";
+    s << "	}" << "\n";
+    s << "}" << "\n";
+    s << "if {!$restored} {" << "\n" << "\n";
+}
+
+// Save the committed state after gravity. The done file is written last, so a
+// half written checkpoint is never restored; it holds the hash, the node and
+// element counts and the time of the saved state. A script sourced with
+// gravityOnly set stops here. The restored run skipped section 1, so the model
+// builder of the column (builder) is set again outside the block.
+static void writeGravitySave(std::ofstream &s, const std::string &checkpointDir, const std::string &builder)
+{
+    if (checkpointDir.empty())
+        return;
+    s << "file mkdir $checkpoint" << "\n";
+    s << "database File [file join $checkpoint state]" << "\n";
+    s << "save 1" << "\n";
+    s << "set doneFile [open [file join $checkpoint done] w]" << "\n";
+    s << "puts $doneFile \"$profileHash [llength [getNodeTags]] [llength [getEleTags]] [getTime]\"" << "\n";
+    s << "close $doneFile" << "\n";
+    s << "puts \"Saved gravity stage to $checkpoint\"" << "\n";
+    s << "}" << "\n";
+    s << "if {[info exists gravityOnly]} {" << "\n";
+    s << "	wipe" << "\n";
+    s << "	exit" << "\n";
+    s << "}" << "\n";
+    s << builder << "\n" << "\n";
+}
+
+// Envelope-only output: the min, max and absmax of every response are kept in
+// the *.env files (three rows, no time column) instead of full histories.
+// Stress and pore pressure are also recorded once at the first step for the
+// initial state ru is measured from. The max displacement relative to the base
+// needs simultaneous values, so displacement keeps a coarse history.
+static void writeEnvelopeRecorders(std::ofstream &s, int numNodes, int numElems, const std::string &recFile, const std::string &recExt)
+{
+    s << "set envDispDT 0.01" << "\n";
+    s << "eval \"recorder EnvelopeNode -file out_tcl/acceleration.env -nodeRange 1 " << numNodes << " -dof 1 2  accel\"" << "\n";
+    s << "eval \"recorder EnvelopeNode -file out_tcl/porePressure.env -nodeRange 1 " << numNodes << " -dof 3 vel\"" << "\n";
+    s << "recorder EnvelopeElement -file out_tcl/stress.env -eleRange 1 " << numElems << "  stress 3" << "\n";
+    s << "recorder EnvelopeElement -file out_tcl/strain.env -eleRange 1 " << numElems << "  strain" << "\n";
+    s << "eval \"recorder Node -file out_tcl/porePressureInitial.out -time -dT 1.0e10 -nodeRange 1 " << numNodes << " -dof 3 vel\"" << "\n";
+    s << "recorder Element -file out_tcl/stressInitial.out -time -dT 1.0e10 -eleRange 1 " << numElems << "  stress 3" << "\n";
+    s << "eval \"recorder Node " << recFile << " out_tcl/displacement" << recExt << " -time -dT $envDispDT -nodeRange 1 " << numNodes << " -dof 1 2  disp\"" << "\n";
+}
+
+// Full histories at the depths listed in basicSettings "historyDepths" (m below
+// the surface), at the nearest node level and the element right below it.
+// out_tcl/historyDepths.dat lists: index depth node element.
+static void writeHistoryDepthRecorders(std::ofstream &s, const json &depths, const std::vector<double> &levelY,
+                                       int numElems, const std::string &outputDir)
+{
+    if (!depths.is_array() || levelY.empty())
+        return;
+    std::ofstream hs(outputDir + "/historyDepths.dat", std::ofstream::out);
+    double top = levelY.back();
+    int k = 0;
+    for (auto &d : depths)
+    {
+        if (!d.is_number())
+            continue;
+        double y = top - d.get<double>();
+        int level = 0;
+        for (int i = 1; i < int(levelY.size()); i++)
+            if (std::fabs(levelY[i] - y) < std::fabs(levelY[level] - y))
+                level = i;
+        int node = 2 * level + 1;
+        int ele = std::min(std::max(level, 1), numElems);
+        std::string name = "out_tcl/depth" + std::to_string(++k);
+        s << "recorder Node -file " << name << ".disp -time -dT $recDT -node " << node << " -dof 1 2 3  disp" << "\n";
+        s << "recorder Node -file " << name << ".acc -time -dT $recDT -node " << node << " -dof 1 2 3  accel" << "\n";
+        s << "recorder Node -file " << name << ".vel -time -dT $recDT -node " << node << " -dof 1 2 3 vel" << "\n";
+        s << "recorder Element -file " << name << ".stress -time -dT $recDT -ele " << ele << "  stress 3" << "\n";
+        s << "recorder Element -file " << name << ".strain -time -dT $recDT -ele " << ele << "  strain" << "\n";
+        hs << k << " " << top - levelY[level] << " " << node << " " << ele << "\n";
+    }
+    hs.close();
+}
+
+// The all elastic column solved in the frequency domain (FrequencyDomainSolver)
+// instead of with the time stepping of model.tcl, see
+// FrequencyDomainSolver::writeColumnRecorders for the results. Elements are
+// bottom up as built, levelY the y of each pair of nodes.
+bool SiteResponseModel::solveElasticColumn2D(const std::vector<FrequencyDomainSolver::Layer> &elements,
+                                             const std::vector<double> &poisson, const std::vector<double> &levelY,
+                                             double groundWaterTable, double rockVs, double rockDen,
+                                             double a0, double a1, bool binaryRecorders)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // what the tcl applies: Rock-x.vel at motionDT
+    std::vector<double> rockVel;
+    double motionDT = theMotionX->getDt();
+    if (!MotionFile::read((theAnalysisDir + "/Rock-x.vel").c_str(), rockVel) || rockVel.size() < 2 || motionDT <= 0.0)
+        return false;
+
+    size_t numElems = elements.size();
+    if (numElems < 1 || levelY.size() != numElems + 1 || poisson.size() < numElems)
+        return false;
+
+    ProgressChannel progress;
+    progress.open(theTclOutputDir + "/" + PROGRESS_FILE_NAME);
+    progress.stage("frequency domain");
+
+    std::vector<FrequencyDomainSolver::Layer> layers(elements.rbegin(), elements.rend());
+    FrequencyDomainSolver solver(layers, rockVs, rockDen);
+    solver.setRayleighDamping(a0, a1);
+    std::vector<std::vector<double>> vel;
+    solver.solve(rockVel, motionDT, vel);
+
+    // bottom up like the nodes
+    std::reverse(vel.begin(), vel.end());
+    bool ok = FrequencyDomainSolver::writeColumnRecorders(theTclOutputDir, elements, poisson, levelY,
+                                                          groundWaterTable, vel, motionDT, binaryRecorders);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (ok)
+        std::cout << "Elastic profile: solved in the frequency domain (" << rockVel.size() << " steps, "
+                  << numElems << " elements) in " << seconds << " s" << std::endl;
+    progress.finished(ok);
+    return ok;
+}
+
+// Equivalent linear analysis (EquivalentLinearAnalysis) of the layers of the
+// profile on their modulus reduction and damping curves: a layer's
+// "eqlCurves" {strain (%), modulusReduction, damping (%)} or the Darendeli
+// curves of its "PI" and "OCR" at the mean effective stress in its middle.
+// The results are written as by solveElasticColumn2D, with the strain
+// compatible G, and out_tcl/eqlSummary.json sums them up.
+bool SiteResponseModel::solveEquivalentLinear2D(const json &soilLayers, const json &basicSettings, double minESize,
+                                                const std::vector<double> &levelY, double groundWaterTable,
+                                                double rockVs, double rockDen, bool binaryRecorders)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<double> rockVel;
+    double motionDT = theMotionX->getDt();
+    if (!MotionFile::read((theAnalysisDir + "/Rock-x.vel").c_str(), rockVel) || rockVel.size() < 2 || motionDT <= 0.0)
+        return equivalentLinearFallback("failed", "no input motion in Rock-x.vel");
+
+    // the stresses of the curves and of stress.out
+    double K0 = 0.5;
+    std::vector<DynamicCurves> curves;
+    try
+    {
+        SRM_layering = SiteLayering();
+        SRM_layering.readFromJson(soilLayers, minESize);
+
+        json layers = soilLayers;
+        std::sort(layers.begin(), layers.end(),
+                  [](const json &a, const json &b) { return a["id"] < b["id"]; });
+        double g = 9.81;
+        double rhoWater = 1.0;
+        double depth = 0.0;
+        double sigmaAbove = 0.0;
+        for (auto l : layers)
+        {
+            std::string lname = l["name"];
+            if (!lname.compare("Rock"))
+                continue;
+            double thickness = l["thickness"];
+            double density = l["density"];
+            double middle = depth + 0.5 * thickness;
+            double sigmaV = sigmaAbove + 0.5 * density * g * thickness
+                    - rhoWater * g * std::max(0.0, middle - groundWaterTable);
+            depth += thickness;
+            sigmaAbove += density * g * thickness;
+
+            json c = l.value("eqlCurves", json());
+            if (c.is_object())
+            {
+                DynamicCurves layerCurves;
+                layerCurves.strain = c["strain"].get<std::vector<double>>();
+                layerCurves.modulusReduction = c["modulusReduction"].get<std::vector<double>>();
+                for (double d : c["damping"].get<std::vector<double>>())
+                    layerCurves.damping.push_back(d / 100.0);
+                curves.push_back(layerCurves);
+            }
+            else
+                curves.push_back(DynamicCurves::darendeli(l.value("PI", 0.0), l.value("OCR", 1.0),
+                                                          sigmaV * (1.0 + 2.0 * K0) / 3.0));
+        }
+    }
+    catch (std::exception& e){return equivalentLinearFallback("failed", std::string("bad layer data: ") + e.what());}
+
+    EquivalentLinearAnalysis eql(SRM_layering, curves, rockVs, rockDen);
+    eql.setStrainRatio(basicSettings.value("eqlStrainRatio", 0.65));
+    eql.setMaxIterations(basicSettings.value("eqlMaxIterations", 30));
+    eql.setTolerance(basicSettings.value("eqlTolerance", 0.02));
+    size_t numElems = eql.getSublayers().size();
+    if (numElems < 1 || levelY.size() != numElems + 1)
+        return equivalentLinearFallback("failed", "the sublayers do not match the mesh");
+
+    ProgressChannel progress;
+    progress.open(theTclOutputDir + "/" + PROGRESS_FILE_NAME);
+    progress.stage("equivalent linear");
+    if (!eql.run(rockVel, motionDT))
+    {
+        progress.finished(false);
+        return equivalentLinearFallback("failed", "the frequency domain solution failed");
+    }
+    m_equivalentLinearStatus = eql.converged() ? "converged" : "not converged";
+
+    // bottom up like the nodes
+    std::vector<FrequencyDomainSolver::Layer> elements(eql.getSublayers().rbegin(), eql.getSublayers().rend());
+    std::vector<std::vector<double>> vel(eql.getVelocities().rbegin(), eql.getVelocities().rend());
+    std::vector<double> poisson(numElems, K0 / (1.0 + K0));
+    bool ok = FrequencyDomainSolver::writeColumnRecorders(theTclOutputDir, elements, poisson, levelY,
+                                                          groundWaterTable, vel, motionDT, binaryRecorders);
+
+    // the most strained sublayer of each layer
+    const std::vector<double> &maxStrain = eql.getMaxStrains();
+    const std::vector<int> &layerOf = eql.getSublayerLayers();
+    std::vector<int> worst(SRM_layering.getNumLayers(), -1);
+    for (size_t e = 0; e < numElems; e++)
+        if (worst[layerOf[e]] < 0 || maxStrain[e] > maxStrain[worst[layerOf[e]]])
+            worst[layerOf[e]] = int(e);
+    json layerSummary = json::array();
+    for (int i = 0; i < SRM_layering.getNumLayers(); i++)
+    {
+        int e = worst[i];
+        if (e < 0)
+            continue;
+        json l;
+        l["name"] = SRM_layering.getLayer(i).getName();
+        l["maxStrain"] = maxStrain[e];
+        l["GGmax"] = eql.getSublayers()[e].G / eql.getMaxShearModuli()[e];
+        l["damping"] = eql.getSublayers()[e].damping;
+        layerSummary.push_back(l);
+    }
+    const std::vector<double> &surface = eql.getVelocities().front();
+    double pga = 0.0;
+    for (size_t i = 1; i < surface.size(); i++)
+        pga = std::max(pga, std::fabs(surface[i] - surface[i-1]) / motionDT);
+    json summary;
+    summary["status"] = m_equivalentLinearStatus;
+    summary["iterations"] = eql.getNumIterations();
+    summary["converged"] = eql.converged();
+    summary["pga"] = pga / 9.81;
+    summary["maxStrain"] = *std::max_element(maxStrain.begin(), maxStrain.end());
+    summary["layers"] = layerSummary;
+    std::ofstream o(theTclOutputDir + "/eqlSummary.json");
+    o << std::setw(4) << summary << std::endl;
+    ok = ok && o.good();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Equivalent linear: " << eql.getNumIterations() << " iterations"
+              << (eql.converged() ? "" : " (not converged)") << ", surface PGA " << pga / 9.81
+              << " g, largest strain " << summary["maxStrain"].get<double>() << " % in " << seconds << " s" << std::endl;
+    if (!eql.converged())
+    {
+        std::ostringstream warning;
+        warning << "equivalent linear not converged in " << eql.getNumIterations() << " iterations";
+        progress.warning(warning.str());
+        std::cerr << "Warning: the " << warning.str() << ", the results are of the last iteration" << std::endl;
+    }
+    progress.finished(ok);
+    if (!ok)
+        return equivalentLinearFallback("failed", "could not write the results to " + theTclOutputDir);
+    return ok;
+}
+
+bool SiteResponseModel::equivalentLinearFallback(const std::string &status, const std::string &reason)
+{
+    m_equivalentLinearStatus = status;
+    json summary;
+    summary["status"] = status;
+    summary["converged"] = false;
+    summary["reason"] = reason;
+    summary["fallback"] = "effectiveStress";
+    std::ofstream o(theTclOutputDir + "/eqlSummary.json");
+    o << std::setw(4) << summary << std::endl;
+    std::cerr << "Equivalent linear analysis " << status << " (" << reason
+              << "), the effective stress model is built instead" << std::endl;
+    return false;
+}
+
+void SiteResponseModel::loadStepBounds(const json &basicSettings)
+{
+    m_dtMin = m_userDtMin >= 0.0 ? m_userDtMin : basicSettings.value("dtMin", 0.0);
+    m_dtMax = m_userDtMax >= 0.0 ? m_userDtMax : basicSettings.value("dtMax", 0.0);
+}
+
 int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
 {
     m_doAnalysis = doAnalysis;
     m_runningStochastic =false;
+    m_solvedInFrequencyDomain = false;
+    m_equivalentLinearStatus.clear();
 
     Vector zeroVec(3);
     zeroVec.Zero();
@@ -236,6 +606,8 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
     std::ofstream es (theTclOutputDir+"/elementInfo.dat", std::ofstream::out);
     s << "# #########################################################" << "\n\n";
     s << "wipe \n\n";
+    ProgressChannel::writeTclOpen(s);
+    s << "progressEvent stage name {\"gravity\"}" << "\n" << "\n";
 
 
     // basic settings
@@ -248,9 +620,11 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
     json basicSettings;
     double dampingCoeff,dashpotCoeff,groundWaterTable,rockDen,rockVs;
     std::string groundMotion;
+    bool binaryRecorders = false;
     try
     {
         basicSettings = SRT["basicSettings"];
+        binaryRecorders = basicSettings.value("recorderFormat", std::string("text")) == "binary";
         dampingCoeff = basicSettings["dampingCoeff"];
         dashpotCoeff = basicSettings["dashpotCoeff"];
         groundMotion = basicSettings["groundMotion"].get<std::string>();;
@@ -267,17 +641,29 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
     catch (std::exception& e){std::cerr << "Standard exception: " << e.what() << std::endl;return false;}
     catch(std::string str){std::cerr << str << std::endl;return false;}
 
+    // gravity checkpoint shared by the motions run on this profile
+    std::string checkpointDir = theGravityCheckpointDir;
+    if (checkpointDir.empty() && basicSettings.value("reuseGravity", false))
+        checkpointDir = "gravity";
+
 
     std::vector<int> layerNumElems;
     std::vector<int> layerNumNodes;
     std::vector<double> layerElemSize;
+    double meshFrequency = MAX_FREQUENCY; // highest frequency every layer can carry
     std::vector<int> dryNodes;
+    // elements bottom up, for the frequency domain solution of an all elastic column
+    bool allElastic = true;
+    std::vector<FrequencyDomainSolver::Layer> elasticElements;
+
 
+    writeGravityRestore(s, gravityProfileHash(SRT, theModelType), checkpointDir);
 
     s << "# ------------------------------------------ \n";
     s << "# 1. Build nodes and elements                \n";
     s << "# ------------------------------------------ \n \n";
     double yCoord = 0;
+    std::vector<double> levelY(1, yCoord);  // y of each pair of nodes, base first
     std::map<int, int> matNumDict;
     std::vector<int> soilMatTags;
     std::vector<double> vPermVec;
@@ -355,10 +741,12 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
             int numEleThisLayer = static_cast<int> (std::round(thickness / eSizeV));
             numEleThisLayer = std::max(1,numEleThisLayer);
             double t = thickness / numEleThisLayer;
+            meshFrequency = std::min(meshFrequency, vs / (NODES_PER_WAVELENGTH * t));
             s << "# " << lname << ": thickness = "<< thickness << ", "<< numEleThisLayer<< " elements." << "\n";
             for (int i=1; i<=numEleThisLayer;i++)
             {
                 yCoord += t ;
+                levelY.push_back(yCoord);
 
                 s << "node " << numNodes + 1 << " 0.0 " << yCoord << "\n";
                 s << "puts $nodesInfo \""<< numNodes + 1 << " 0.0 " << yCoord << "\"" << "\n";
@@ -368,6 +756,8 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
                 ns << numNodes + 2 << " " << sElemX << " " << yCoord << "\n";
 
                 double alpha = 1.0e-8;
+                if (matType.compare("Elastic"))
+                    allElastic = false;
                 // Define one material for each element
                 if(!matType.compare("Elastic"))
                 {
@@ -378,6 +768,8 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
                     s << "nDMaterial ElasticIsotropic " << numElems + 1 << " "<< E <<" " << " "<<poisson<<" "<<density<<"\n";
                     rho_d = Gs / (1 + evoid);
                     rho_s = rho_d *(1.0+evoid/Gs);
+                    FrequencyDomainSolver::Layer element = {t, density, E / (2.0 * (1.0 + poisson)), 0.0};
+                    elasticElements.push_back(element);
 
                 } else if(!matType.compare("PM4Sand")) {
                     double thisDr = mat["Dr"];
@@ -761,6 +1153,7 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
 
     s << "analyze     10 1.0" << "\n";
     s << "puts \"Finished with plastic gravity analysis...\"" << "\n" << "\n";
+    writeGravitySave(s, checkpointDir, "model BasicBuilder -ndm 2 -ndf 3");
 
 
 
@@ -847,12 +1240,25 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
     //std::vector<double> dt;
 
 
-    double dT = 0.001; // This is the time step in solution
     double motionDT = theMotionX->getDt();//  0.005; // This is the time step in the motion record. TODO: use a funciton to get it
     int nStepsMotion = theMotionX->getNumSteps();//1998;//theMotionX->getNumSteps() ; //1998; // number of motions in the record. TODO: use a funciton to get it
-    int nSteps = int((nStepsMotion-1) * motionDT / dT);
-    int remStep = nSteps;
+    double dT = basicSettings.value("analysisDT", 0.0); // This is the time step in solution, <= 0 : automatic
+    int nSteps;
+    if (dT > 0.0)
+    {
+        nSteps = int((nStepsMotion-1) * motionDT / dT);
+        std::cout << "Analysis dT = " << dT << " (user defined)" << std::endl;
+        s << "# analysis dT is user defined" << "\n";
+    } else {
+        dT = getAnalysisDT(meshFrequency, motionDT);
+        int subSteps = static_cast<int>(std::round(motionDT / dT));
+        nSteps = (nStepsMotion-1) * subSteps;
+        std::cout << "Analysis dT = " << dT << " (" << subSteps << " steps per motion step, mesh resolves "
+                  << meshFrequency << " Hz)" << std::endl;
+        s << "# analysis dT from mesh frequency " << meshFrequency << " Hz and motion dt " << motionDT << "\n";
+    }
     s << "set dT " << dT << "\n";
+    s << "puts \"Analysis dT = $dT, " << nSteps << " steps\"" << "\n";
     s << "set motionDT " << motionDT << "\n";
     //s << "set mSeries \"Path -dt $motionDT -filePath /Users/simcenter/Codes/SimCenter/SiteResponseTool/test/RSN766_G02_000_VEL.txt -factor $cFactor\""<<"\n";
     s << "set mSeries \"Path -dt $motionDT -filePath Rock-x.vel -factor $cFactor\""<<"\n";
@@ -935,7 +1341,9 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
     s << "# ------------------------------------------------------------\n\n";
 
 
-    double recDT = 0.001;
+    // one row per analysis step: the step size controller lands on every
+    // multiple of dT, so the rows are uniform for the spectra and pyramids
+    double recDT = dT;
 
     s << "set recDT " << recDT << "\n";
     s << "file mkdir out_tcl" << "\n";
@@ -947,76 +1355,39 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
     s<< "eval \"recorder Node -file out_tcl/base.acc -time -dT $recDT -node 1 -dof 1 2 3  accel\""<<"\n";// 1 2
     s<< "eval \"recorder Node -file out_tcl/base.vel -time -dT $recDT -node 1 -dof 1 2 3 vel\""<<"\n";// 3
 
-    s<< "eval \"recorder Node -file out_tcl/displacement.out -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 2  disp\""<<"\n";
-    s<< "eval \"recorder Node -file out_tcl/velocity.out -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 2  vel\""<<"\n";
-    s<< "eval \"recorder Node -file out_tcl/acceleration.out -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 2  accel\""<<"\n";
-
-    s<< "eval \"recorder Node -file out_tcl/porePressure.out -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 3 vel\""<<"\n";
-
-    s<< "recorder Element -file out_tcl/stress.out -time -dT $recDT  -eleRange 1 "<<numElems <<"  stress 3"<<"\n";
-    s<< "recorder Element -file out_tcl/strain.out -time -dT $recDT  -eleRange 1 "<<numElems <<"  strain"<<"\n";
-    s<< "\n" << "\n";
+    // binary recorders are raw doubles: much smaller and no parsing in the post-processor.
+    // stress and pore pressure stay in text so their widths need not be known up front.
+    std::string recFile = binaryRecorders ? "-binary" : "-file";
+    std::string recExt = binaryRecorders ? ".bin" : ".out";
+    // "full" (default): histories everywhere, "envelope": envelopes plus a few histories
+    if (basicSettings.value("outputProfile", std::string("full")) == "envelope")
+    {
+        writeEnvelopeRecorders(s, numNodes, numElems, recFile, recExt);
+        writeHistoryDepthRecorders(s, basicSettings.value("historyDepths", json::array()), levelY, numElems, theTclOutputDir);
+        s<< "\n" << "\n";
+    } else {
+        s<< "eval \"recorder Node "<<recFile<<" out_tcl/displacement"<<recExt<<" -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 2  disp\""<<"\n";
+        s<< "eval \"recorder Node "<<recFile<<" out_tcl/velocity"<<recExt<<" -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 2  vel\""<<"\n";
+        s<< "eval \"recorder Node "<<recFile<<" out_tcl/acceleration"<<recExt<<" -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 2  accel\""<<"\n";
+
+        s<< "eval \"recorder Node -file out_tcl/porePressure.out -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 3 vel\""<<"\n";
+
+        s<< "recorder Element -file out_tcl/stress.out -time -dT $recDT  -eleRange 1 "<<numElems <<"  stress 3"<<"\n";
+        s<< "recorder Element "<<recFile<<" out_tcl/strain"<<recExt<<" -time -dT $recDT  -eleRange 1 "<<numElems <<"  strain"<<"\n";
+        s<< "\n" << "\n";
+    }
 
     s << "# ------------------------------------------------------------\n";
     s << "# 5.4 Perform dynamic analysis                                \n";
     s << "# ------------------------------------------------------------\n\n";
 
+    s << "progressEvent stage name {\"dynamic\"}" << "\n";
     s << "set nSteps " << nSteps << "\n";
-    s << "set remStep " << remStep << "\n";
-    s << "set success 0" << "\n" << "\n";
-
-    s << "proc subStepAnalyze {dT subStep} {" << "\n";
-    s << "	if {$subStep > 10} {" << "\n";
-    s << "		return -10" << "\n";
-    s << "	}" << "\n";
-    s << "	for {set i 1} {$i < 3} {incr i} {" << "\n";
-    s << "		puts \"Try dT = $dT\"" << "\n";
-    s << "		set success [analyze 1 $dT]" << "\n";
-    s << "		if {$success != 0} {" << "\n";
-    s << "			set success [subStepAnalyze [expr $dT/2.0] [expr $subStep+1]]" << "\n";
-    s << "			if {$success == -10} {" << "\n";
-    s << "				puts \"Did not converge.\"" << "\n";
-    s << "				return $success" << "\n";
-    s << "			}" << "\n";
-    s << "		} else {" << "\n";
-    s << "			if {$i==1} {" << "\n";
-    s << "				puts \"Substep $subStep : Left side converged with dT = $dT\"" << "\n";
-    s << "			} else {" << "\n";
-    s << "				puts \"Substep $subStep : Right side converged with dT = $dT\"" << "\n";
-    s << "			}" << "\n";
-    s << "		}" << "\n";
-    s << "	}" << "\n";
-    s << "	return $success" << "\n";
-    s << "}" << "\n" << "\n" << "\n";
-
-
-    s << "puts \"Start analysis\"" << "\n";
-    s << "set startT [clock seconds]" << "\n";
-    //s << "if {1} {" << "\n";
-    s << "set finalTime [expr $remStep * $dT]" << "\n";
-    s << "set success 0" << "\n";
-    s << "set currentTime 0." << "\n";
-    s << "set timeMarker 0." << "\n";
-    s << "while {$success == 0 && $currentTime < $finalTime} {" << "\n";
-    s << "	set subStep 0" << "\n";
-    s << "	set success [analyze 1  $dT]" << "\n";
-    s << "	if {$success != 0} {" << "\n";
-    s << "	set curTime  [getTime]" << "\n";
-    s << "	puts \"Analysis failed at $curTime . Try substepping.\"" << "\n";
-    s << "	set success  [subStepAnalyze [expr $dT/2.0] [incr subStep]]" << "\n";
-    s << "	set curStep  [expr int($curTime/$dT + 1)]" << "\n";
-    s << "	set remStep  [expr int($nSteps-$curStep)]" << "\n";
-    s << "	puts \"Current step: $curStep , Remaining steps: $remStep\"" << "\n";
-    s << "    } else {" << "\n";
-    s << "          set progress [expr $currentTime/$finalTime * 100.]" << "\n";
-    s << "          if { $progress > $timeMarker} {" << "\n";
-    s << "              set timeMarker [expr $timeMarker+2]" << "\n";
-    s << "              puts \"$progress%\"" << "\n";
-    s << "              }" << "\n";
-    s << "              set currentTime [getTime]" << "\n";
-    s << "	}" << "\n";
-    s << "}" << "\n" << "\n";
-    //s << "}" << "\n" << "\n";
+    // adaptive time stepping between dtMin and dtMax (default: dT/1024 and dT)
+    loadStepBounds(basicSettings);
+    StepSizeController stepControl(dT, m_dtMin, m_dtMax, 35);
+    stepControl.setOutputInterval(recDT);
+    stepControl.writeTcl(s);
 
     s << "set endT [clock seconds]" << "\n" << "\n";
     s << "puts \"loading analysis execution time: [expr $endT-$startT] seconds.\"" << "\n" << "\n";
@@ -1026,6 +1397,7 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
     //s << "print -file out_tcl/Domain.out" << "\n" << "\n";
 
     s << "wipe" << "\n";
+    ProgressChannel::writeTclFinished(s);
     s << "puts \"Site response analysis is finished.\""<< "\n";
     s << "exit" << "\n" << "\n";
 
@@ -1033,6 +1405,21 @@ int SiteResponseModel::buildEffectiveStressModel2D(bool doAnalysis)
     ns.close();
     es.close();
 
+    // an all elastic column needs no time stepping, model.tcl is still written
+    // so the time domain analysis can be run as well. Screening runs use
+    // strain compatible linear properties instead of the materials.
+    std::string analysisMode = theAnalysisMode;
+    if (analysisMode.empty())
+        analysisMode = basicSettings.value("analysisMode", std::string("effectiveStress"));
+    if (!analysisMode.compare("equivalentLinear") && m_runningStochastic)
+        equivalentLinearFallback("unsupported", "random field profiles");
+    else if (!analysisMode.compare("equivalentLinear"))
+        m_solvedInFrequencyDomain = solveEquivalentLinear2D(soilLayers, basicSettings, minESizeV, levelY,
+                                                            groundWaterTable, rockVs, rockDen, binaryRecorders);
+    else if (allElastic && !m_runningStochastic && basicSettings.value("elasticFastPath", true))
+        m_solvedInFrequencyDomain = solveElasticColumn2D(elasticElements, plasticPoissonVec, levelY,
+                                                         groundWaterTable, rockVs, rockDen, a0, a1, binaryRecorders);
+
     return 100;
 }
 
@@ -2561,8 +2948,23 @@ int SiteResponseModel::trueRun()
     int nSteps = m_nSteps;
     int remStep = m_remStep;
 
+    ProgressChannel progress;
+    bool analysisOk = true;
+
+    // the internal builders do not read basicSettings
+    json basicSettings;
+    std::ifstream config(theConfigFile);
+    try {
+        json SRT;
+        config >> SRT;
+        basicSettings = SRT.value("basicSettings", json());
+    } catch (std::exception &) {}
+    loadStepBounds(basicSettings);
+
     if(doAnalysis)
     {
+        progress.open(theTclOutputDir + "/" + PROGRESS_FILE_NAME);
+        progress.stage("dynamic");
 
         bool useSubstep = true;
         int stepLag = 2;
@@ -2577,7 +2979,7 @@ int SiteResponseModel::trueRun()
             for (int analysisCount = 0; analysisCount < remStep; ++analysisCount)
             {
                 std::cout << "step: " << analysisCount << " / " << remStep-1 << "\n";
-                if (!forward) break;
+                if (isCanceled()) break;
                 //int converged = theAnalysis->analyze(1, 0.01, 0.005, 0.02, 1);
                 //double stepDT = dt[analysisCount];
                 //int converged = theTransientAnalysis->analyze(1, stepDT, stepDT / 2.0, stepDT * 2.0, 1); // *
@@ -2601,8 +3003,8 @@ int SiteResponseModel::trueRun()
                         opsout << progressBar.str().c_str();
                         opsout.flush();
 
-                        if (callback && forward)
-                            forward = m_callbackFunction(100.0 * analysisCount / remStep);
+                        if (callback && !isCanceled() && !m_callbackFunction(100.0 * analysisCount / remStep))
+                            m_cancel->cancel();
                     }
                 }
                 else
@@ -2611,7 +3013,9 @@ int SiteResponseModel::trueRun()
                     std::cerr << "Site response analysis did not converge. Trying substepping..." << "\n";
 
                     int subStep = 0;
-                    success = subStepAnalyze(dT/2., subStep+1, theTransientAnalysis);
+                    success = subStepAnalyze(dT, subStep+1, theTransientAnalysis);
+                    if (success == SUBSTEP_CANCELED)
+                        break;
                     if(!fabs(success)<1)
                     {
                         std::cout << "Substepping didn't work... exit" << "\n";
@@ -2621,7 +3025,7 @@ int SiteResponseModel::trueRun()
                 }
             }
             std::cerr << "Site response analysis done..." << "\n";
-            if (callback && forward) m_callbackFunction(100.0);
+            if (callback && !isCanceled()) m_callbackFunction(100.0);
             progressBar << "\r[";
             for (int ii = 0; ii < 20; ii++)
                 progressBar << "-";
@@ -2640,21 +3044,32 @@ int SiteResponseModel::trueRun()
             int remStept = 0;
             double timeMaker = 0.;
 
-            while(fabs(success)<1 && currentTime < finalTime && forward)
+            StepSizeController stepControl(dT, m_dtMin, m_dtMax, theTest->getMaxNumTests());
+            progress.start(remStep, dT, finalTime);
+
+            while(fabs(success)<1 && currentTime < finalTime - 1.0e-9 * dT && !isCanceled())
             {
 
-                int subStep = 0;
-                success = theTransientAnalysis->analyze(1, dT);
+                double stepDT = stepControl.nextDt(currentTime, finalTime);
+                success = theTransientAnalysis->analyze(1, stepDT);
                 std::cout << "current time is: " << currentTime << " \n";
                 if(fabs(success)>0)
                 {   // analysisi failed at currenttime
-                    std::cout << "analysisi failed at time: " << currentTime << ". Try substepping ... \n";
-                    success = subStepAnalyze(dT/2., subStep+1, theTransientAnalysis);
+                    progress.reject(currentTime, stepDT, ProgressChannel::subStepDepth(dT, stepDT), theTest->getNumTests());
+                    if (stepControl.reject(theTest->getNumTests()))
+                    {
+                        std::cout << "analysisi failed at time: " << currentTime << ". Try dT = " << stepControl.getDt() << " \n";
+                        success = 0;
+                    } else
+                        std::cout << "Did not converge at time: " << currentTime << " with dT = " << stepDT << " \n";
                 } else {
+                    stepControl.accept(stepDT, theTest->getNumTests());
                     currentProgress = int(currentTime/finalTime *100.);
                     if (currentProgress > timeMaker)
                     {
                         timeMaker += 1;
+                        progress.step(currentTime, stepControl.getNumAccepted(), stepDT, ProgressChannel::subStepDepth(dT, stepDT),
+                                      theTest->getNumTests(), 100. * currentTime / finalTime);
                         //std::cout << currentProgress << "\n";
                         remStept = 100-currentProgress;
                         if (currentProgress % stepLag == 0 && currentProgress > stepLag)
@@ -2670,8 +3085,8 @@ int SiteResponseModel::trueRun()
                             opsout << progressBar.str().c_str();
                             opsout.flush();
 
-                            if (callback && forward)
-                                forward = m_callbackFunction(double(currentTime/finalTime *100.));
+                            if (callback && !isCanceled() && !m_callbackFunction(double(currentTime/finalTime *100.)))
+                                m_cancel->cancel();
                         }
                     }
 
@@ -2681,7 +3096,10 @@ int SiteResponseModel::trueRun()
 
 
             std::cerr << "Site response analysis done..." << "\n";
-            if (callback && forward) m_callbackFunction(100.0);
+            std::cerr << stepControl.summary(remStep) << "\n";
+            analysisOk = success == 0 && !isCanceled();
+            progress.analysis(stepControl.getNumAccepted(), stepControl.getNumRejected(), stepControl.getNumIterations(), analysisOk);
+            if (callback && !isCanceled()) m_callbackFunction(100.0);
             progressBar << "\r[";
             for (int ii = 0; ii < 100/stepLag; ii++)
                 progressBar << "-";
@@ -2698,6 +3116,8 @@ int SiteResponseModel::trueRun()
     }
 
     theDomain->removeRecorders();
+    // recorders are closed, results can be read
+    progress.finished(analysisOk);
 
     /*
     // write domain
@@ -2712,37 +3132,39 @@ int SiteResponseModel::trueRun()
 
 }
 
+// advance the analysis by dT, starting with dT/2^subStep and adapting
+// the step size with the number of Newton iterations. Returns
+// SUBSTEP_CANCELED as soon as the run is canceled.
 int SiteResponseModel::subStepAnalyze(double dT, int subStep, DirectIntegrationAnalysis* theTransientAnalysis)
 {
-    int maxsubstep = 10;
-    if (subStep > maxsubstep)
-    {
-        std::cout << "subStep greater than max substeps " << maxsubstep << "existing substepping. \n";
-        return -maxsubstep;
-    }
-    int success = 0;
-    for (int i=1; i < 3; i++)
+    double startTime = theDomain->getCurrentTime();
+    double endTime = startTime + dT;
+    StepSizeController stepControl(dT, m_dtMin, m_dtMax, theTest->getMaxNumTests());
+    stepControl.setDt(dT / std::pow(2.0, subStep));
+
+    double currentTime = startTime;
+    while (currentTime < endTime - 1.0e-9 * dT)
     {
-        std::cerr << "Try dT = " << dT << "\n";
-        success = theTransientAnalysis->analyze(1, dT);// 0 means success
-        //success = subStepAnalyze(dT/2, subStep +1,);
-        if(fabs(success) > 0.0 )
+        if (isCanceled())
+            return SUBSTEP_CANCELED;
+        double stepDT = stepControl.nextDt(currentTime, endTime);
+        std::cerr << "Try dT = " << stepDT << "\n";
+        int success = theTransientAnalysis->analyze(1, stepDT);// 0 means success
+        if (success != 0)
         {
-            success = subStepAnalyze(dT/2.0, subStep+1,theTransientAnalysis);
-            if(success == -maxsubstep)
+            if (!stepControl.reject(theTest->getNumTests()))
             {
-                std::cout << "reached max substeps " << maxsubstep << "existing substepping. \n";
-                return success;
+                std::cout << "reached min dT " << stepControl.getDtMin() << " exiting substepping. \n";
+                return -10;
             }
         } else {
-            if (i==1)
-                std::cerr << "Substep " << subStep << " : Left side converged with dT = " << dT;
-            else
-                std::cerr << "Substep " << subStep << " : Right side converged with dT = " << dT;
+            stepControl.accept(stepDT, theTest->getNumTests());
+            currentTime = theDomain->getCurrentTime();
         }
     }
+    std::cerr << stepControl.summary(1) << "\n";
 
-    return success;
+    return 0;
 
 }
 #endif
@@ -2751,6 +3173,8 @@ int SiteResponseModel::subStepAnalyze(double dT, int subStep, DirectIntegrationA
 int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
 {
     m_doAnalysis = doAnalysis;
+    m_solvedInFrequencyDomain = false;
+    m_equivalentLinearStatus.clear();
 
     Vector zeroVec(3);
     zeroVec.Zero();
@@ -2789,6 +3213,8 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
     std::ofstream esmat3D (theTclOutputDir+"/elementMatInfo3D.dat", std::ofstream::out);
     //ofstream s ("/Users/simcenter/Codes/SimCenter/build-SiteResponseTool-Desktop_Qt_5_11_1_clang_64bit-Debug/SiteResponseTool.app/Contents/MacOS/model.tcl", std::ofstream::out);
     s << "# #########################################################" << "\n\n";
+    ProgressChannel::writeTclOpen(s);
+    s << "progressEvent stage name {\"gravity\"}" << "\n" << "\n";
     s << "wipe \n\n";
 
     s << "set g " << g << "\n";
@@ -2806,10 +3232,12 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
     json basicSettings;
     double dampingCoeff,dashpotCoeff,groundWaterTable,rockDen,rockVs;
     std::string groundMotion;
+    bool binaryRecorders = false;
 
     try
     {
         basicSettings = SRT["basicSettings"];
+        binaryRecorders = basicSettings.value("recorderFormat", std::string("text")) == "binary";
         dampingCoeff = basicSettings["dampingCoeff"];
         dashpotCoeff = basicSettings["dashpotCoeff"];
         groundMotion = basicSettings["groundMotion"].get<std::string>();
@@ -2828,6 +3256,11 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
     catch (std::exception& e){std::cerr << "Standard exception: " << e.what() << std::endl;return false;}
     catch(std::string str){std::cerr << str << std::endl;return false;}
 
+    // gravity checkpoint shared by the motions run on this profile
+    std::string checkpointDir = theGravityCheckpointDir;
+    if (checkpointDir.empty() && basicSettings.value("reuseGravity", false))
+        checkpointDir = "gravity";
+
     std::map<int, int> matNumDict;
     std::vector<int> soilMatTags;
     std::vector<double> vPermVec;
@@ -2843,7 +3276,10 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
     s << "set slopex2 " << slopex2 << "\n";
 
 
-    s << "\n# ------------------------------------------ \n";
+    s << "\n";
+    writeGravityRestore(s, gravityProfileHash(SRT, theModelType), checkpointDir);
+
+    s << "# ------------------------------------------ \n";
     s << "# 1. Build nodes and elements                \n";
     s << "# ------------------------------------------ \n \n";
     double yCoord = 0;
@@ -3265,6 +3701,7 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
 
     s << "analyze     40 5e2" << "\n";
     s << "puts \"Finished with plastic gravity analysis...\"" << "\n" << "\n";
+    writeGravitySave(s, checkpointDir, "model BasicBuilder -ndm 3 -ndf 4");
 
 
     s << "# 3.3 Update element permeability for post gravity analysis"<< "\n" << "\n";
@@ -3367,7 +3804,6 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
     double motionDT = theMotionX->getDt();//  0.005; // This is the time step in the motion record. TODO: use a funciton to get it
     int nStepsMotion = theMotionX->getNumSteps();//1998;//theMotionX->getNumSteps() ; //1998; // number of motions in the record. TODO: use a funciton to get it
     int nSteps = int((nStepsMotion-1) * motionDT / dT +1);
-    int remStep = nSteps;
     s << "set dT " << dT << "\n";
     s << "set motionDT " << motionDT << "\n";
     //s << "set mSeries \"Path -dt $motionDT -filePath /Users/simcenter/Codes/SimCenter/SiteResponseTool/test/RSN766_G02_000_VEL.txt -factor $cFactor\""<<"\n";
@@ -3445,7 +3881,7 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
     s << "# ------------------------------------------------------------\n\n";
 
     s << "file mkdir out_tcl" << "\n";
-    double recDT = motionDT;
+    double recDT = dT; // uniform rows, see the 2D builder
     s << "set recDT " << recDT << "\n";
     s<< "eval \"recorder Node -file out_tcl/surface.disp -time -dT $recDT -node "<<numNodes<<" -dof 1 2 3  disp\""<<"\n";// 1 2
     s<< "eval \"recorder Node -file out_tcl/surface.acc -time -dT $recDT -node "<<numNodes<<" -dof 1 2 3  accel\""<<"\n";// 1 2
@@ -3455,12 +3891,14 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
     s<< "eval \"recorder Node -file out_tcl/base.acc -time -dT $recDT -node 1 -dof 1 2 3  accel\""<<"\n";// 1 2
     s<< "eval \"recorder Node -file out_tcl/base.vel -time -dT $recDT -node 1 -dof 1 2 3 vel\""<<"\n";// 3
 
-    s<< "eval \"recorder Node -file out_tcl/displacement.out -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 3  disp\""<<"\n";
-    s<< "eval \"recorder Node -file out_tcl/velocity.out -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 3  vel\""<<"\n";
-    s<< "eval \"recorder Node -file out_tcl/acceleration.out -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 3  accel\""<<"\n";
+    std::string recFile = binaryRecorders ? "-binary" : "-file";
+    std::string recExt = binaryRecorders ? ".bin" : ".out";
+    s<< "eval \"recorder Node "<<recFile<<" out_tcl/displacement"<<recExt<<" -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 3  disp\""<<"\n";
+    s<< "eval \"recorder Node "<<recFile<<" out_tcl/velocity"<<recExt<<" -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 3  vel\""<<"\n";
+    s<< "eval \"recorder Node "<<recFile<<" out_tcl/acceleration"<<recExt<<" -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 1 3  accel\""<<"\n";
     s<< "eval \"recorder Node -file out_tcl/porePressure.out -time -dT $recDT -nodeRange 1 "<<numNodes<<" -dof 4 vel\""<<"\n";
     s<< "recorder Element -file out_tcl/stress.out -time -dT $recDT  -eleRange 1 "<< numElems <<"  stress 6 \n";
-    s<< "recorder Element -file out_tcl/strain.out -time -dT $recDT  -eleRange 1 "<< numElems <<"  strain"<<"\n";
+    s<< "recorder Element "<<recFile<<" out_tcl/strain"<<recExt<<" -time -dT $recDT  -eleRange 1 "<< numElems <<"  strain"<<"\n";
     s<< "\n";
 
 
@@ -3469,62 +3907,13 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
     s << "# 5.4 Perform dynamic analysis                                \n";
     s << "# ------------------------------------------------------------\n\n";
 
+    s << "progressEvent stage name {\"dynamic\"}" << "\n";
     s << "set nSteps " << nSteps << "\n";
-    s << "set remStep " << remStep << "\n";
-    s << "set success 0" << "\n" << "\n";
-
-    s << "proc subStepAnalyze {dT subStep} {" << "\n";
-    s << "	if {$subStep > 10} {" << "\n";
-    s << "		return -10" << "\n";
-    s << "	}" << "\n";
-    s << "	for {set i 0} {$i < 3} {incr i} {" << "\n";
-    s << "		puts \"Try dT = $dT\"" << "\n";
-    s << "		set success [analyze 1 $dT]" << "\n";
-    s << "		if {$success != 0} {" << "\n";
-    s << "			set success [subStepAnalyze [expr $dT/2.0] [expr $subStep+1]]" << "\n";
-    s << "			if {$success == -10} {" << "\n";
-    s << "				puts \"Did not converge.\"" << "\n";
-    s << "				return $success" << "\n";
-    s << "			}" << "\n";
-    s << "		} else {" << "\n";
-    s << "			if {$i==1} {" << "\n";
-    s << "				puts \"Substep $subStep : Left side converged with dT = $dT\"" << "\n";
-    s << "			} else {" << "\n";
-    s << "				puts \"Substep $subStep : Right side converged with dT = $dT\"" << "\n";
-    s << "			}" << "\n";
-    s << "		}" << "\n";
-    s << "	}" << "\n";
-    s << "	return $success" << "\n";
-    s << "}" << "\n" << "\n" << "\n";
-
-
-
-    s << "puts \"Start analysis\"" << "\n";
-    s << "set remStep $nSteps" << "\n";
-    s << "set startT [clock seconds]" << "\n";
-    s << "set finalTime [expr $remStep * $dT]" << "\n";
-    s << "set success 0" << "\n";
-    s << "set currentTime 0." << "\n";
-    s << "set timeMarker 0." << "\n";
-    s << "while {$success == 0 && $currentTime < $finalTime} {" << "\n";
-    s << "	set subStep 0" << "\n";
-    s << "	set success [analyze 1  $dT]" << "\n";
-    s << "	if {$success != 0} {" << "\n";
-    s << "	set curTime  [getTime]" << "\n";
-    s << "	puts \"Analysis failed at $curTime . Try substepping.\"" << "\n";
-    s << "	set success  [subStepAnalyze [expr $dT/2.0] [incr subStep]]" << "\n";
-    s << "	set curStep  [expr int($curTime/$dT + 1)]" << "\n";
-    s << "	set remStep  [expr int($nSteps-$curStep)]" << "\n";
-    s << "	puts \"Current step: $curStep , Remaining steps: $remStep\"" << "\n";
-    s << "    } else {" << "\n";
-    s << "          set progress [expr $currentTime/$finalTime * 100.]" << "\n";
-    s << "          if { $progress > $timeMarker} {" << "\n";
-    s << "              set timeMarker [expr $timeMarker+2]" << "\n";
-    s << "              puts \"$progress%\"" << "\n";
-    s << "              }" << "\n";
-    s << "              set currentTime [getTime]" << "\n";
-    s << "	}" << "\n";
-    s << "}" << "\n" << "\n";
+    // adaptive time stepping between dtMin and dtMax (default: dT/1024 and dT)
+    loadStepBounds(basicSettings);
+    StepSizeController stepControl(dT, m_dtMin, m_dtMax, 55);
+    stepControl.setOutputInterval(recDT);
+    stepControl.writeTcl(s);
     s << "remove recorders" << "\n";
     s << "set endT    [clock seconds]" <<"\n";
     s << "puts \"Finished with dynamic analysis...\"" <<"\n";
@@ -3533,6 +3922,7 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
 
     s << "" <<"\n";
     s << "wipe" <<"\n";
+    ProgressChannel::writeTclFinished(s);
     s << "puts \"Site response analysis is finished.\"\n"<< "\n";
 
     s.close();
@@ -3540,6 +3930,13 @@ int SiteResponseModel::buildEffectiveStressModel3D(bool doAnalysis)
     es.close();
     esmat3D.close();
 
+    // only the 2D column has an equivalent linear solution
+    std::string analysisMode = theAnalysisMode;
+    if (analysisMode.empty())
+        analysisMode = basicSettings.value("analysisMode", std::string("effectiveStress"));
+    if (!analysisMode.compare("equivalentLinear"))
+        equivalentLinearFallback("unsupported", "3D profiles");
+
     return 100;
 }
 
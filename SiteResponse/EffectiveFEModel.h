@@ -22,6 +22,8 @@
 #include "siteLayering.h"
 #include "soillayer.h"
 #include "outcropMotion.h"
+#include "CancelToken.h"
+#include "FrequencyDomainSolver.h"
 
 #ifdef _INTERNAL_FEM
 #include "Domain.h"
@@ -60,6 +62,9 @@
 
 #define MAX_FREQUENCY 50.0
 #define NODES_PER_WAVELENGTH 10
+#define NEWMARK_STEPS_PER_PERIOD 10
+// subStepAnalyze() result when the run was canceled
+#define SUBSTEP_CANCELED -20
 
 class SiteResponseModel {
 
@@ -85,6 +90,23 @@ public:
     void setConfigFile(std::string configFile) { theConfigFile = configFile; }
     void  setTclOutputDir(std::string outDir) { theTclOutputDir = outDir; }
     void  setAnalysisDir(std::string anaDir) { theAnalysisDir = anaDir; }
+    // directory of the gravity checkpoints (empty: basicSettings "reuseGravity" decides)
+    void  setGravityCheckpointDir(std::string dir) { theGravityCheckpointDir = dir; }
+    double getAnalysisDT(double meshFrequency, double motionDT);
+    // bounds of the adaptive time step (StepSizeController), a negative
+    // value leaves basicSettings "dtMin" / "dtMax" in charge
+    void  setStepBounds(double dtMin, double dtMax) { m_userDtMin = dtMin; m_userDtMax = dtMax; }
+    // the last build found an all elastic 2D column and wrote its results
+    // (basicSettings "elasticFastPath", default true), model.tcl need not be run
+    bool solvedInFrequencyDomain() const {return m_solvedInFrequencyDomain;}
+    // "effectiveStress" or "equivalentLinear" (2D: solved in the frequency
+    // domain while building); empty: basicSettings "analysisMode" decides
+    void  setAnalysisMode(std::string mode) { theAnalysisMode = mode; }
+    // empty unless the last build was asked for an equivalent linear analysis,
+    // then "converged", "not converged", "failed" or "unsupported" (3D and
+    // random field profiles). After the last two the build falls back to the
+    // effective stress model, out_tcl/eqlSummary.json records why
+    const std::string &equivalentLinearStatus() const {return m_equivalentLinearStatus;}
 #ifdef _INTERNAL_FEM
     int subStepAnalyze(double dT, int subStep, DirectIntegrationAnalysis* theTransientAnalysis);
     int trueRun();
@@ -96,11 +118,27 @@ public:
 
     bool callback = false;
     void setCallback(bool cal) {callback = cal;}
-    void setForward(bool f) {forward = f;}
+    void setForward(bool f) {if (f) m_cancel->reset(); else m_cancel->cancel();}
+    // token polled between steps (the model's own one if null); it is
+    // owned by the caller and must outlive the run
+    void setCancelToken(CancelToken *token) {m_cancel = token ? token : &m_ownCancel;}
+    bool isCanceled() const {return m_cancel->isCanceled();}
     bool m_runningStochastic = false;
 
 
 private:
+    bool solveElasticColumn2D(const std::vector<FrequencyDomainSolver::Layer> &elements,
+                              const std::vector<double> &poisson, const std::vector<double> &levelY,
+                              double groundWaterTable, double rockVs, double rockDen,
+                              double a0, double a1, bool binaryRecorders);
+    // m_dtMin / m_dtMax from the user or basicSettings (0: the default)
+    void loadStepBounds(const nlohmann::json &basicSettings);
+    bool solveEquivalentLinear2D(const nlohmann::json &soilLayers, const nlohmann::json &basicSettings, double minESize,
+                                 const std::vector<double> &levelY, double groundWaterTable,
+                                 double rockVs, double rockDen, bool binaryRecorders);
+    // sets the status, writes out_tcl/eqlSummary.json with the fallback and
+    // reports it on stderr; returns false
+    bool equivalentLinearFallback(const std::string &status, const std::string &reason);
 
     SiteLayering    SRM_layering;
     OutcropMotion*  theMotionX;
@@ -110,8 +148,17 @@ private:
     std::string 	theConfigFile;
     std::string     theTclOutputDir;
     std::string     theAnalysisDir;
-    bool forward = true;
+    std::string     theGravityCheckpointDir;
+    std::string     theAnalysisMode;
+    CancelToken m_ownCancel;
+    CancelToken *m_cancel = &m_ownCancel;
     bool m_doAnalysis = false;
+    bool m_solvedInFrequencyDomain = false;
+    std::string m_equivalentLinearStatus;
+    double m_userDtMin = -1.0;
+    double m_userDtMax = -1.0;
+    double m_dtMin = 0.0;
+    double m_dtMax = 0.0;
     std::vector<double> dt;
 
 #ifdef _INTERNAL_FEM
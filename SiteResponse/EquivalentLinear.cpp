@@ -0,0 +1,157 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+#include "EquivalentLinear.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double PI = 3.141592653589793;
+const double P_ATM = 101.325;
+
+double interpolateLog(const std::vector<double> &x, const std::vector<double> &y, double at)
+{
+    if (x.empty() || y.size() < x.size())
+        return 0.0;
+    if (at <= x.front())
+        return y.front();
+    if (at >= x.back())
+        return y[x.size() - 1];
+    size_t i = std::upper_bound(x.begin(), x.end(), at) - x.begin();
+    double w = std::log(at / x[i-1]) / std::log(x[i] / x[i-1]);
+    return y[i-1] + w * (y[i] - y[i-1]);
+}
+
+}
+
+double DynamicCurves::modulusReductionAt(double strainPercent) const
+{
+    return interpolateLog(strain, modulusReduction, strainPercent);
+}
+
+double DynamicCurves::dampingAt(double strainPercent) const
+{
+    return interpolateLog(strain, damping, strainPercent);
+}
+
+DynamicCurves DynamicCurves::darendeli(double plasticity, double OCR, double sigmaM)
+{
+    double stress = std::max(sigmaM, 1.0) / P_ATM;
+    double refStrain = (0.0352 + 0.0010 * plasticity * std::pow(OCR, 0.3246)) * std::pow(stress, 0.3483);
+    double a = 0.919;
+    double minDamping = (0.8005 + 0.0129 * plasticity * std::pow(OCR, -0.1069)) * std::pow(stress, -0.2889);
+    double b = 0.6329 - 0.0057 * std::log(10.0);
+    double c1 = -1.1143 * a * a + 1.8618 * a + 0.2523;
+    double c2 = 0.0805 * a * a - 0.0710 * a - 0.0095;
+    double c3 = -0.0005 * a * a + 0.0002 * a + 0.0003;
+
+    // 1e-5 % to 10 %, ten points a decade
+    DynamicCurves curves;
+    for (int i = 0; i <= 60; i++)
+    {
+        double gamma = std::pow(10.0, -5.0 + i / 10.0);
+        double GGmax = 1.0 / (1.0 + std::pow(gamma / refStrain, a));
+        double masing1 = 100.0 / PI * (4.0 * (gamma - refStrain * std::log((gamma + refStrain) / refStrain))
+                                       / (gamma * gamma / (gamma + refStrain)) - 2.0);
+        double masing = c1 * masing1 + c2 * masing1 * masing1 + c3 * masing1 * masing1 * masing1;
+        curves.strain.push_back(gamma);
+        curves.modulusReduction.push_back(GGmax);
+        curves.damping.push_back((b * std::pow(GGmax, 0.1) * std::max(0.0, masing) + minDamping) / 100.0);
+    }
+    return curves;
+}
+
+EquivalentLinearAnalysis::EquivalentLinearAnalysis(SiteLayering &layering, const std::vector<DynamicCurves> &curves,
+                                                   double rockVs, double rockDen) :
+    m_curves(curves),
+    m_rockVs(rockVs),
+    m_rockDen(rockDen)
+{
+    for (int i = 0; i < layering.getNumLayers(); i++)
+    {
+        SoilLayer layer = layering.getLayer(i);
+        int numEle = std::max(1, layer.getNumEle());
+        double Gmax = layer.getMatShearModulus();
+        for (int e = 0; e < numEle; e++)
+        {
+            FrequencyDomainSolver::Layer sublayer = {layer.getThickness() / numEle, layer.getRho(), Gmax, 0.0};
+            m_sublayers.push_back(sublayer);
+            m_layerOf.push_back(i);
+            m_Gmax.push_back(Gmax);
+        }
+    }
+    m_curves.resize(layering.getNumLayers());
+}
+
+bool EquivalentLinearAnalysis::run(const std::vector<double> &rockVel, double dt)
+{
+    m_numIterations = 0;
+    m_converged = false;
+    m_vel.clear();
+    size_t n = m_sublayers.size();
+    m_maxStrain.assign(n, 0.0);
+    if (n < 1 || rockVel.size() < 2 || dt <= 0.0)
+        return false;
+
+    // small strain properties
+    for (size_t e = 0; e < n; e++)
+    {
+        const DynamicCurves &c = m_curves[m_layerOf[e]];
+        m_sublayers[e].G = m_Gmax[e];
+        m_sublayers[e].damping = c.damping.empty() ? 0.0 : c.damping.front();
+    }
+
+    size_t numSteps = rockVel.size();
+    std::vector<double> disp(n + 1);
+    while (m_numIterations < m_maxIterations && !m_converged)
+    {
+        FrequencyDomainSolver solver(m_sublayers, m_rockVs, m_rockDen);
+        solver.solve(rockVel, dt, m_vel);
+        m_numIterations++;
+
+        // largest strain from the displacements of the tops of the sublayers
+        std::fill(disp.begin(), disp.end(), 0.0);
+        std::fill(m_maxStrain.begin(), m_maxStrain.end(), 0.0);
+        for (size_t i = 1; i < numSteps; i++)
+        {
+            for (size_t j = 0; j <= n; j++)
+                disp[j] += 0.5 * dt * (m_vel[j][i-1] + m_vel[j][i]);
+            for (size_t e = 0; e < n; e++)
+                m_maxStrain[e] = std::max(m_maxStrain[e], std::fabs(disp[e] - disp[e+1]) / m_sublayers[e].thickness * 100.0);
+        }
+
+        std::vector<FrequencyDomainSolver::Layer> next(m_sublayers);
+        double change = 0.0;
+        for (size_t e = 0; e < n; e++)
+        {
+            const DynamicCurves &c = m_curves[m_layerOf[e]];
+            if (c.strain.empty())
+                continue;
+            double effectiveStrain = m_strainRatio * m_maxStrain[e];
+            next[e].G = m_Gmax[e] * c.modulusReductionAt(effectiveStrain);
+            next[e].damping = c.dampingAt(effectiveStrain);
+            change = std::max(change, std::fabs(next[e].G - m_sublayers[e].G) / m_sublayers[e].G);
+            if (next[e].damping > 0.0)
+                change = std::max(change, std::fabs(next[e].damping - m_sublayers[e].damping) / next[e].damping);
+        }
+        m_converged = change <= m_tolerance;
+
+        // the sublayers are left with the properties of the last solve so they
+        // go with the velocities and strains
+        if (!m_converged && m_numIterations < m_maxIterations)
+            m_sublayers.swap(next);
+    }
+
+    return true;
+}
@@ -0,0 +1,88 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+
+#ifndef EQUIVALENTLINEAR_H
+#define EQUIVALENTLINEAR_H
+
+#include <vector>
+
+#include "siteLayering.h"
+#include "FrequencyDomainSolver.h"
+
+// Modulus reduction and damping against the shear strain, in %
+struct DynamicCurves
+{
+    std::vector<double> strain;            // %, increasing
+    std::vector<double> modulusReduction;  // G / Gmax
+    std::vector<double> damping;           // ratio
+
+    // interpolated in log strain, constant beyond the ends of the table
+    double modulusReductionAt(double strainPercent) const;
+    double dampingAt(double strainPercent) const;
+
+    // Darendeli (2001) curves for plasticity index PI (%), overconsolidation
+    // ratio OCR and mean effective stress sigmaM (kPa), at 1 Hz and 10 cycles
+    static DynamicCurves darendeli(double PI, double OCR, double sigmaM);
+};
+
+// Equivalent linear (SHAKE style) site response: the layers are split into
+// their numEle sublayers and solved with FrequencyDomainSolver using G and
+// damping from the curves of their layer at strainRatio times the largest
+// strain of the last iteration, starting from Gmax = rho vs^2 and the
+// damping at small strain, until neither changes by more than the tolerance.
+class EquivalentLinearAnalysis
+{
+public:
+    // curves: one per layer of layering (top down); the halfspace is elastic
+    EquivalentLinearAnalysis(SiteLayering &layering, const std::vector<DynamicCurves> &curves,
+                             double rockVs, double rockDen);
+
+    void setStrainRatio(double ratio) { m_strainRatio = ratio; }
+    void setMaxIterations(int n) { m_maxIterations = n; }
+    void setTolerance(double tol) { m_tolerance = tol; }
+
+    // outcropping rock velocity sampled at dt; false if the input is empty
+    bool run(const std::vector<double> &rockVel, double dt);
+
+    int getNumIterations() const { return m_numIterations; }
+    bool converged() const { return m_converged; }
+    // strain compatible sublayers, top down
+    const std::vector<FrequencyDomainSolver::Layer> &getSublayers() const { return m_sublayers; }
+    // layer of each sublayer
+    const std::vector<int> &getSublayerLayers() const { return m_layerOf; }
+    // Gmax of each sublayer
+    const std::vector<double> &getMaxShearModuli() const { return m_Gmax; }
+    // velocity at the top of each sublayer and of the halfspace, surface first
+    const std::vector<std::vector<double>> &getVelocities() const { return m_vel; }
+    // largest shear strain (%) of each sublayer in the last iteration
+    const std::vector<double> &getMaxStrains() const { return m_maxStrain; }
+
+private:
+    std::vector<FrequencyDomainSolver::Layer> m_sublayers;
+    std::vector<int> m_layerOf;
+    std::vector<double> m_Gmax;
+    std::vector<DynamicCurves> m_curves;
+    double m_rockVs;
+    double m_rockDen;
+
+    double m_strainRatio = 0.65;
+    int m_maxIterations = 30;
+    double m_tolerance = 0.02;
+
+    int m_numIterations = 0;
+    bool m_converged = false;
+    std::vector<std::vector<double>> m_vel;
+    std::vector<double> m_maxStrain;
+};
+
+#endif // EQUIVALENTLINEAR_H
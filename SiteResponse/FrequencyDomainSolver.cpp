@@ -0,0 +1,307 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+#include "FrequencyDomainSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+typedef std::complex<double> Complex;
+
+namespace {
+
+const double PI = 3.141592653589793;
+// complex values held at once by solve(), the levels are done in chunks
+const size_t MAX_SPECTRUM_VALUES = size_t(1) << 22;
+
+}
+
+FrequencyDomainSolver::FrequencyDomainSolver(const std::vector<Layer> &layers, double rockVs, double rockDen) :
+    m_layers(layers),
+    m_rockVs(rockVs),
+    m_rockDen(rockDen)
+{
+
+}
+
+void FrequencyDomainSolver::transfer(double f, std::vector<Complex> &H) const
+{
+    size_t n = m_layers.size();
+    H.assign(n + 1, Complex(1.0, 0.0));
+    if (f <= 0.0)
+        return;
+
+    double w = 2.0 * PI * f;
+    const Complex I(0.0, 1.0);
+
+    // complex shear wave velocity and impedance of each layer
+    std::vector<Complex> k(n), impedance(n + 1);
+    for (size_t m = 0; m < n; m++)
+    {
+        const Layer &l = m_layers[m];
+        double xi = l.damping + m_a0 / (2.0 * w) + m_a1 * w / 2.0;
+        Complex vs = std::sqrt(l.G * Complex(1.0, 2.0 * xi) / l.density);
+        k[m] = w / vs;
+        impedance[m] = l.density * vs;
+    }
+    impedance[n] = m_rockDen * m_rockVs;
+
+    // up and downgoing amplitudes from the free surface (A = B = 1) down.
+    // They grow with depth in damped layers, so they are kept normalized
+    // and the scale is carried as a logarithm
+    std::vector<Complex> A(n + 1), B(n + 1);
+    std::vector<double> logScale(n + 1, 0.0);
+    A[0] = B[0] = 1.0;
+    for (size_t m = 0; m < n; m++)
+    {
+        Complex alpha = impedance[m] / impedance[m+1];
+        Complex e = std::exp(I * k[m] * m_layers[m].thickness);
+        Complex nextA = 0.5 * (A[m] * (1.0 + alpha) * e + B[m] * (1.0 - alpha) / e);
+        Complex nextB = 0.5 * (A[m] * (1.0 - alpha) * e + B[m] * (1.0 + alpha) / e);
+        double scale = std::max(std::abs(nextA), std::abs(nextB));
+        if (!(scale > 0.0) || !std::isfinite(scale))
+            scale = 1.0;
+        A[m+1] = nextA / scale;
+        B[m+1] = nextB / scale;
+        logScale[m+1] = logScale[m] + std::log(scale);
+    }
+
+    // u = A + B at the top of each layer, the outcrop is 2 A of the halfspace
+    for (size_t m = 0; m <= n; m++)
+        H[m] = (A[m] + B[m]) / (2.0 * A[n]) * std::exp(logScale[m] - logScale[n]);
+}
+
+void FrequencyDomainSolver::solve(const std::vector<double> &rockVel, double dt, std::vector<std::vector<double>> &vel) const
+{
+    size_t numSteps = rockVel.size();
+    size_t numLevels = m_layers.size() + 1;
+    vel.assign(numLevels, std::vector<double>(numSteps, 0.0));
+    if (numSteps < 2 || dt <= 0.0)
+        return;
+
+    size_t nfft = 1;
+    while (nfft < 2 * numSteps)
+        nfft <<= 1;
+    size_t numFrequencies = nfft / 2 + 1;
+
+    std::vector<Complex> input(nfft, Complex(0.0, 0.0));
+    for (size_t i = 0; i < numSteps; i++)
+        input[i] = rockVel[i];
+    fft(input, false);
+
+    size_t chunk = std::max(size_t(1), MAX_SPECTRUM_VALUES / nfft);
+    std::vector<Complex> H;
+    for (size_t first = 0; first < numLevels; first += chunk)
+    {
+        size_t last = std::min(numLevels, first + chunk);
+        std::vector<std::vector<Complex>> spectra(last - first, std::vector<Complex>(nfft));
+        for (size_t k = 0; k < numFrequencies; k++)
+        {
+            transfer(k / (nfft * dt), H);
+            for (size_t j = first; j < last; j++)
+            {
+                Complex value = H[j] * input[k];
+                std::vector<Complex> &spectrum = spectra[j - first];
+                if (k == 0 || k == nfft / 2)
+                    spectrum[k] = value.real();
+                else
+                {
+                    spectrum[k] = value;
+                    spectrum[nfft - k] = std::conj(value);
+                }
+            }
+        }
+
+        for (size_t j = first; j < last; j++)
+        {
+            std::vector<Complex> &spectrum = spectra[j - first];
+            fft(spectrum, true);
+            for (size_t i = 0; i < numSteps; i++)
+                vel[j][i] = spectrum[i].real() / double(nfft);
+        }
+    }
+}
+
+// one recorder row, text or raw doubles as "-binary" writes them
+static void writeRecorderRow(std::ofstream &f, const std::vector<double> &row, bool binary)
+{
+    if (binary)
+    {
+        f.write(reinterpret_cast<const char*>(row.data()), std::streamsize(row.size() * sizeof(double)));
+        return;
+    }
+    for (size_t i = 0; i < row.size(); i++)
+        f << (i ? " " : "") << row[i];
+    f << "\n";
+}
+
+bool FrequencyDomainSolver::writeColumnRecorders(const std::string &dir, const std::vector<Layer> &elements,
+                                                 const std::vector<double> &poisson, const std::vector<double> &levelY,
+                                                 double groundWaterTable, const std::vector<std::vector<double>> &vel,
+                                                 double dt, bool binary)
+{
+    size_t numElems = elements.size();
+    size_t numLevels = numElems + 1;
+    if (numElems < 1 || levelY.size() != numLevels || poisson.size() < numElems || vel.size() != numLevels || dt <= 0.0)
+        return false;
+    size_t numSteps = vel[0].size();
+    if (numSteps < 2)
+        return false;
+    std::string prefix = dir + "/";
+
+    // initial state
+    double g = 9.81;
+    double rhoWater = 1.0;
+    double totalHeight = levelY.back();
+    std::vector<double> pwp(numLevels, 0.0);
+    for (size_t j = 0; j < numLevels; j++)
+        pwp[j] = rhoWater * g * std::max(0.0, totalHeight - levelY[j] - groundWaterTable);
+    std::vector<double> sigmaY(numElems), sigmaX(numElems);
+    double sigmaAbove = 0.0;
+    for (size_t e = numElems; e-- > 0; )
+    {
+        const Layer &l = elements[e];
+        double depth = totalHeight - 0.5 * (levelY[e] + levelY[e+1]);
+        double effective = sigmaAbove + 0.5 * l.density * g * l.thickness
+                - rhoWater * g * std::max(0.0, depth - groundWaterTable);
+        sigmaY[e] = -effective;
+        sigmaX[e] = -effective * poisson[e] / (1.0 - poisson[e]);
+        sigmaAbove += l.density * g * l.thickness;
+    }
+
+    std::string recExt = binary ? ".bin" : ".out";
+    std::ios::openmode recMode = binary ? std::ios::out | std::ios::binary : std::ios::out;
+    std::ofstream dispFile((prefix + "displacement" + recExt).c_str(), recMode);
+    std::ofstream velFile((prefix + "velocity" + recExt).c_str(), recMode);
+    std::ofstream accFile((prefix + "acceleration" + recExt).c_str(), recMode);
+    std::ofstream strainFile((prefix + "strain" + recExt).c_str(), recMode);
+    std::ofstream stressFile((prefix + "stress.out").c_str());
+    std::ofstream pwpFile((prefix + "porePressure.out").c_str());
+    const char *positions[] = {"base", "surface"};
+    const char *motions[] = {"disp", "vel", "acc"};
+    std::ofstream pointFiles[2][3];
+    for (int p = 0; p < 2; p++)
+        for (int m = 0; m < 3; m++)
+            pointFiles[p][m].open((prefix + positions[p] + "." + motions[m]).c_str());
+    if (!dispFile || !velFile || !accFile || !strainFile || !stressFile || !pwpFile)
+        return false;
+
+    std::vector<double> disp(numLevels, 0.0), acc(numLevels);
+    std::vector<double> row, pointRow(4);
+    for (size_t i = 0; i < numSteps; i++)
+    {
+        double time = i * dt;
+        for (size_t j = 0; j < numLevels; j++)
+        {
+            const std::vector<double> &v = vel[j];
+            if (i > 0)
+                disp[j] += 0.5 * dt * (v[i-1] + v[i]);
+            if (i == 0)
+                acc[j] = (v[1] - v[0]) / dt;
+            else if (i + 1 == numSteps)
+                acc[j] = (v[i] - v[i-1]) / dt;
+            else
+                acc[j] = (v[i+1] - v[i-1]) / (2.0 * dt);
+        }
+
+        // two nodes per level, dof 1 2
+        const std::vector<double> *histories[] = {&disp, 0, &acc};
+        std::ofstream *files[] = {&dispFile, &velFile, &accFile};
+        for (int m = 0; m < 3; m++)
+        {
+            row.assign(1, time);
+            for (size_t j = 0; j < numLevels; j++)
+            {
+                double value = m == 1 ? vel[j][i] : (*histories[m])[j];
+                for (int node = 0; node < 2; node++)
+                {
+                    row.push_back(value);
+                    row.push_back(0.0);
+                }
+            }
+            writeRecorderRow(*files[m], row, binary);
+
+            // base and surface: dof 1 2 3, the pore pressure is the velocity of dof 3
+            for (int p = 0; p < 2; p++)
+            {
+                size_t j = p == 0 ? 0 : numLevels - 1;
+                pointRow[0] = time;
+                pointRow[1] = row[1 + 4 * j];
+                pointRow[2] = 0.0;
+                pointRow[3] = m == 1 ? pwp[j] : 0.0;
+                writeRecorderRow(pointFiles[p][m], pointRow, false);
+            }
+        }
+
+        row.assign(1, time);
+        for (size_t j = 0; j < numLevels; j++)
+        {
+            row.push_back(pwp[j]);
+            row.push_back(pwp[j]);
+        }
+        writeRecorderRow(pwpFile, row, false);
+
+        std::vector<double> stressRow(1, time);
+        row.assign(1, time);
+        for (size_t e = 0; e < numElems; e++)
+        {
+            double gamma = (disp[e+1] - disp[e]) / elements[e].thickness;
+            row.push_back(0.0);
+            row.push_back(0.0);
+            row.push_back(gamma);
+            stressRow.push_back(sigmaX[e]);
+            stressRow.push_back(sigmaY[e]);
+            stressRow.push_back(elements[e].G * gamma);
+        }
+        writeRecorderRow(strainFile, row, binary);
+        writeRecorderRow(stressFile, stressRow, false);
+    }
+
+    return true;
+}
+
+void FrequencyDomainSolver::fft(std::vector<Complex> &x, bool inverse)
+{
+    size_t n = x.size();
+    if (n < 2)
+        return;
+
+    // bit reversal permutation
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(x[i], x[j]);
+    }
+
+    for (size_t length = 2; length <= n; length <<= 1)
+    {
+        double angle = (inverse ? 2.0 : -2.0) * PI / double(length);
+        Complex wLength(std::cos(angle), std::sin(angle));
+        for (size_t i = 0; i < n; i += length)
+        {
+            Complex w(1.0, 0.0);
+            for (size_t j = 0; j < length / 2; j++)
+            {
+                Complex u = x[i + j];
+                Complex v = x[i + j + length / 2] * w;
+                x[i + j] = u + v;
+                x[i + j + length / 2] = u - v;
+                w *= wLength;
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+
+#ifndef FREQUENCYDOMAINSOLVER_H
+#define FREQUENCYDOMAINSOLVER_H
+
+#include <complex>
+#include <string>
+#include <vector>
+
+// Linear 1D site response from vertically propagating SH waves: the layers
+// (top down) on an elastic halfspace (rockVs, rockDen) are solved one
+// frequency at a time with the transfer functions of the layer stack
+// (Kramer 1996, 7.2.1.5), the motion is transformed with an FFT.
+//
+// Damping is viscoelastic, G* = G (1 + 2 i xi), with
+//   xi = damping of the layer + a0 / (2 w) + a1 w / 2
+// so the Rayleigh damping of the time domain model can be matched.
+// The halfspace is undamped: the input is the outcropping rock motion, twice
+// the upgoing wave, as with the compliant base of the FE column.
+class FrequencyDomainSolver
+{
+public:
+    struct Layer
+    {
+        double thickness;
+        double density;
+        double G;          // shear modulus
+        double damping;    // ratio, frequency independent
+    };
+
+    FrequencyDomainSolver(const std::vector<Layer> &layers, double rockVs, double rockDen);
+
+    void setRayleighDamping(double a0, double a1) { m_a0 = a0; m_a1 = a1; }
+
+    // absolute velocity at the top of each layer and at the top of the
+    // halfspace (layers.size() + 1 histories, surface first) for the
+    // outcropping rock velocity rockVel sampled at dt. The record is padded
+    // with zeros so the response can die out before it wraps around.
+    void solve(const std::vector<double> &rockVel, double dt, std::vector<std::vector<double>> &vel) const;
+
+    // motion at the top of each layer and of the halfspace over the outcrop
+    // motion at frequency f (Hz)
+    void transfer(double f, std::vector<std::complex<double>> &H) const;
+
+    // Writes the histories vel (bottom up, one per pair of nodes at levelY)
+    // of the column of elements (bottom up) as the recorders of the full
+    // output profile and the base and surface recorders of model.tcl would,
+    // one row per step, so the post processor reads them as usual. Stresses
+    // are the initial effective stresses (K0 from the Poisson's ratio) plus
+    // G gamma, pore pressures hydrostatic below the water table.
+    static bool writeColumnRecorders(const std::string &dir, const std::vector<Layer> &elements,
+                                     const std::vector<double> &poisson, const std::vector<double> &levelY,
+                                     double groundWaterTable, const std::vector<std::vector<double>> &vel,
+                                     double dt, bool binary);
+
+    // in place radix 2 FFT, the size must be a power of 2; the inverse is not
+    // scaled
+    static void fft(std::vector<std::complex<double>> &x, bool inverse);
+
+private:
+    std::vector<Layer> m_layers;
+    double m_rockVs;
+    double m_rockDen;
+    double m_a0 = 0.0;
+    double m_a1 = 0.0;
+};
+
+#endif // FREQUENCYDOMAINSOLVER_H
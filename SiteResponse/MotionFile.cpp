@@ -0,0 +1,293 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+
+#include "MotionFile.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <locale>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// read-only mapping of a whole file
+class MappedFile
+{
+public:
+    explicit MappedFile(const char *fileName);
+    ~MappedFile();
+
+    bool isOpen() const { return m_open; }
+    const char *begin() const { return m_data; }
+    const char *end() const { return m_data + m_size; }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    const char *m_data;
+    size_t m_size;
+    bool m_open;
+#ifdef _WIN32
+    HANDLE m_file;
+    HANDLE m_mapping;
+#endif
+};
+
+#ifdef _WIN32
+MappedFile::MappedFile(const char *fileName) :
+    m_data(NULL), m_size(0), m_open(false), m_file(INVALID_HANDLE_VALUE), m_mapping(NULL)
+{
+    m_file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                         FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size))
+        return;
+    m_open = true;
+    if (size.QuadPart == 0)
+        return;
+    m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapping != NULL)
+        m_data = static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data != NULL)
+        m_size = size_t(size.QuadPart);
+    else
+        m_open = false;
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != NULL)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != NULL)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+}
+#else
+MappedFile::MappedFile(const char *fileName) :
+    m_data(NULL), m_size(0), m_open(false)
+{
+    int fd = ::open(fileName, O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) == 0)
+    {
+        m_open = true;
+        if (st.st_size > 0)
+        {
+            void *data = mmap(NULL, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, size_t(st.st_size), MADV_SEQUENTIAL);
+                m_data = static_cast<const char *>(data);
+                m_size = size_t(st.st_size);
+            } else
+                m_open = false;
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != NULL)
+        munmap(const_cast<char *>(m_data), m_size);
+}
+#endif
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// powers of ten that are exact doubles
+const double exactPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+} // namespace
+
+bool MotionFile::parseNumber(const char *&p, const char *end, double &value)
+{
+    const char *s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+'))
+        negative = *s++ == '-';
+
+    // up to 19 significant digits fit in the mantissa
+    uint64_t mantissa = 0;
+    int numDigits = 0;
+    int exponent = 0;
+    bool exact = true;
+    bool anyDigit = false;
+    for (; s < end && isDigit(*s); s++)
+    {
+        anyDigit = true;
+        if (mantissa == 0 && *s == '0')
+            continue;
+        if (numDigits < 19)
+            mantissa = mantissa * 10 + uint64_t(*s - '0');
+        else
+        {
+            exponent++;
+            exact = false;
+        }
+        numDigits++;
+    }
+    if (s < end && *s == '.')
+    {
+        for (s++; s < end && isDigit(*s); s++)
+        {
+            anyDigit = true;
+            if (mantissa == 0 && *s == '0')
+            {
+                exponent--;
+                continue;
+            }
+            if (numDigits < 19)
+            {
+                mantissa = mantissa * 10 + uint64_t(*s - '0');
+                exponent--;
+            } else
+                exact = false;
+            numDigits++;
+        }
+    }
+    if (!anyDigit)
+        return false;
+
+    if (s < end && (*s == 'e' || *s == 'E'))
+    {
+        const char *e = s + 1;
+        bool negativeExp = false;
+        if (e < end && (*e == '-' || *e == '+'))
+            negativeExp = *e++ == '-';
+        if (e < end && isDigit(*e))
+        {
+            int exp10 = 0;
+            for (; e < end && isDigit(*e); e++)
+                if (exp10 < 100000)
+                    exp10 = exp10 * 10 + (*e - '0');
+            exponent += negativeExp ? -exp10 : exp10;
+            s = e;
+        }
+    }
+    // "1.5x" or "1,2" is not a number
+    if (s < end && !isSpace(*s))
+        return false;
+
+    if (mantissa == 0)
+        value = 0.0;
+    else if (exact && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+    {
+        // both operands are exact, so is the correctly rounded result
+        value = double(mantissa);
+        value = exponent < 0 ? value / exactPow10[-exponent] : value * exactPow10[exponent];
+    } else {
+        // strtod would follow the locale the GUI sets (a decimal comma); the
+        // token is a number, out of range it is stored as 0 or +-max
+        std::istringstream token(std::string(p, s));
+        token.imbue(std::locale::classic());
+        token >> value;
+        negative = false;
+    }
+    if (negative)
+        value = -value;
+
+    p = s;
+    return true;
+}
+
+bool MotionFile::read(const char *fileName, std::vector<double> &values)
+{
+    values.clear();
+    MappedFile file(fileName);
+    if (!file.isOpen())
+        return false;
+
+    const char *p = file.begin();
+    const char *end = file.end();
+    // about one number per 12 characters in the files written by the tool
+    values.reserve(size_t(end - p) / 12 + 1);
+
+    bool lineStart = true;
+    while (p < end)
+    {
+        if (isSpace(*p))
+        {
+            if (*p == '\n')
+                lineStart = true;
+            p++;
+            continue;
+        }
+        if (lineStart && (*p == '%' || *p == '#'))
+        {
+            while (p < end && *p != '\n')
+                p++;
+            continue;
+        }
+        lineStart = false;
+
+        double value;
+        if (!parseNumber(p, end, value))
+        {
+            std::cerr << "WARNING - MotionFile::read() - stopped at a value that is not a number after "
+                      << values.size() << " values in " << fileName << "\n";
+            break;
+        }
+        values.push_back(value);
+    }
+    return true;
+}
+
+bool MotionFile::uniformStep(const std::vector<double> &time, double &dt, double relTol)
+{
+    dt = 0.0;
+    if (time.size() < 2)
+        return false;
+
+    dt = time[1] - time[0];
+    if (dt <= 0.0)
+        return false;
+    double tol = relTol * dt;
+    for (size_t i = 2; i < time.size(); i++)
+        if (std::fabs(time[i] - time[i-1] - dt) > tol)
+            return false;
+    return true;
+}
@@ -0,0 +1,42 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+
+#ifndef MOTIONFILE_H
+#define MOTIONFILE_H
+
+#include <cstddef>
+#include <vector>
+
+// Reader of the motion files (Rock-x.time, .acc, .vel, .disp, ...).
+//
+// The file is memory mapped and parsed in one pass, without a stream or a
+// string per line: numbers are whitespace separated, lines starting with
+// '%' or '#' are skipped and reading stops at the first token that is not
+// a number. Plain decimals (all the motion files written by the tool) are
+// converted exactly from their digits; anything longer goes through strtod.
+class MotionFile
+{
+public:
+    // false if the file can not be opened; values holds what was read
+    static bool read(const char *fileName, std::vector<double> &values);
+
+    // parse the number starting at p (no leading whitespace), p is moved
+    // past it; false (p unchanged) if there is no number at p
+    static bool parseNumber(const char *&p, const char *end, double &value);
+
+    // true if every increment of time is within relTol of the first one,
+    // which is returned in dt
+    static bool uniformStep(const std::vector<double> &time, double &dt, double relTol = 1.0e-6);
+};
+
+#endif // MOTIONFILE_H
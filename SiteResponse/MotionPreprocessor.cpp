@@ -0,0 +1,746 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+#include "MotionPreprocessor.h"
+#include "MotionFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+namespace {
+
+const double PI = 3.141592653589793;
+const double GRAVITY = 9.81;
+// lobes of the Lanczos (windowed sinc) resampling kernel
+const int LANCZOS_LOBES = 8;
+// the anti-alias low-pass of resample() is at this fraction of the new Nyquist frequency
+const double ANTI_ALIAS_FRACTION = 0.8;
+
+bool fileExists(const std::string &fileName)
+{
+    std::ifstream file(fileName.c_str());
+    return file.good();
+}
+
+void makeDir(const std::string &dirName)
+{
+#ifdef WIN32
+    _mkdir(dirName.c_str());
+#else
+    mkdir(dirName.c_str(), 0755);
+#endif
+}
+
+// FNV-1a of the settings and the bytes of the files
+std::string hashInputs(const std::string &key, const std::vector<std::string> &fileNames)
+{
+    uint64_t h = 14695981039346656037ULL;
+    const uint64_t prime = 1099511628211ULL;
+    for (size_t i = 0; i < key.size(); i++)
+        h = (h ^ uint8_t(key[i])) * prime;
+
+    std::vector<char> buffer(1 << 16);
+    for (size_t f = 0; f < fileNames.size(); f++)
+    {
+        std::ifstream file(fileNames[f].c_str(), std::ios::binary);
+        while (file)
+        {
+            file.read(&buffer[0], std::streamsize(buffer.size()));
+            std::streamsize n = file.gcount();
+            for (std::streamsize i = 0; i < n; i++)
+                h = (h ^ uint8_t(buffer[size_t(i)])) * prime;
+        }
+        // separates the files
+        h = (h ^ 0xff) * prime;
+    }
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) h);
+    return std::string(hex);
+}
+
+bool writeColumn(const std::string &fileName, const std::vector<double> &values, int precision)
+{
+    std::ofstream file(fileName.c_str(), std::ofstream::out | std::ofstream::trunc);
+    if (!file.is_open())
+        return false;
+    file << std::setprecision(precision);
+    for (size_t i = 0; i < values.size(); i++)
+        file << values[i] << "\n";
+    return file.good();
+}
+
+bool copyFile(const std::string &from, const std::string &to)
+{
+    std::ifstream src(from.c_str(), std::ios::binary);
+    std::ofstream dst(to.c_str(), std::ios::binary);
+    if (!src.is_open() || !dst.is_open())
+        return false;
+    dst << src.rdbuf();
+    return dst.good();
+}
+
+void printReport(const std::string &motionName, const std::string &fileName)
+{
+    std::ifstream file(fileName.c_str());
+    std::string report;
+    if (std::getline(file, report) && !report.empty())
+        std::cout << "Motion " << motionName << " trimmed to " << report << std::endl;
+}
+
+// one second order section, b2 = a2 = 0 for a first order one
+struct Section
+{
+    double b0, b1, b2, a1, a2;
+};
+
+// sections of a digital Butterworth filter (bilinear transform with the cut
+// off prewarped)
+std::vector<Section> butterworthSections(double cutOff, double dt, int order, bool highPass)
+{
+    std::vector<Section> sections;
+    double W = std::tan(PI * cutOff * dt);
+    double W2 = W * W;
+    for (int k = 0; k < order / 2; k++)
+    {
+        double a = 2.0 * std::sin(PI * (2 * k + 1) / (2.0 * order));
+        double D = 1.0 + a * W + W2;
+        Section s;
+        if (highPass)
+        {
+            s.b0 = 1.0 / D;
+            s.b1 = -2.0 / D;
+            s.b2 = 1.0 / D;
+        } else {
+            s.b0 = W2 / D;
+            s.b1 = 2.0 * W2 / D;
+            s.b2 = W2 / D;
+        }
+        s.a1 = 2.0 * (W2 - 1.0) / D;
+        s.a2 = (1.0 - a * W + W2) / D;
+        sections.push_back(s);
+    }
+    if (order % 2 == 1)
+    {
+        Section s;
+        s.b0 = highPass ? 1.0 / (1.0 + W) : W / (1.0 + W);
+        s.b1 = highPass ? -s.b0 : s.b0;
+        s.b2 = 0.0;
+        s.a1 = (W - 1.0) / (W + 1.0);
+        s.a2 = 0.0;
+        sections.push_back(s);
+    }
+    return sections;
+}
+
+// transposed direct form II, in place
+void runSections(const std::vector<Section> &sections, double *x, size_t n)
+{
+    for (size_t k = 0; k < sections.size(); k++)
+    {
+        const Section &s = sections[k];
+        double z1 = 0.0, z2 = 0.0;
+        for (size_t i = 0; i < n; i++)
+        {
+            double in = x[i];
+            double out = s.b0 * in + z1;
+            z1 = s.b1 * in - s.a1 * out + z2;
+            z2 = s.b2 * in - s.a2 * out;
+            x[i] = out;
+        }
+    }
+}
+
+double lanczos(double x)
+{
+    x = std::fabs(x);
+    if (x < 1.0e-12)
+        return 1.0;
+    if (x >= LANCZOS_LOBES)
+        return 0.0;
+    double px = PI * x;
+    return LANCZOS_LOBES * std::sin(px) * std::sin(px / LANCZOS_LOBES) / (px * px);
+}
+
+// the record on a uniform grid with the mean step (linear interpolation)
+void makeUniform(std::vector<double> &time, std::vector<double> &values, double &dt)
+{
+    size_t n = time.size();
+    dt = (time[n-1] - time[0]) / double(n - 1);
+    std::vector<double> uniform(n);
+    size_t j = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double t = time[0] + i * dt;
+        while (j + 2 < n && time[j+1] < t)
+            j++;
+        double span = time[j+1] - time[j];
+        double w = span > 0.0 ? (t - time[j]) / span : 0.0;
+        w = std::min(1.0, std::max(0.0, w));
+        uniform[i] = values[j] + w * (values[j+1] - values[j]);
+    }
+    values.swap(uniform);
+    for (size_t i = 0; i < n; i++)
+        time[i] = time[0] + i * dt;
+}
+
+} // namespace
+
+MotionPreprocessor::MotionPreprocessor() :
+    m_lowCut(0.0),
+    m_highCut(0.0),
+    m_filterOrder(4),
+    m_baselineOrder(-1),
+    m_resampleDT(0.0),
+    m_trim(false),
+    m_trimFrom(0.05),
+    m_trimTo(0.95),
+    m_trimLead(1.0),
+    m_trimTaper(1.0),
+    m_trimTail(5.0)
+{
+
+}
+
+MotionPreprocessor::MotionPreprocessor(const json &settings) :
+    MotionPreprocessor()
+{
+    if (!settings.is_object())
+        return;
+    m_lowCut = settings.value("lowCut", 0.0);
+    m_highCut = settings.value("highCut", 0.0);
+    m_filterOrder = std::max(1, settings.value("filterOrder", 4));
+    m_baselineOrder = settings.value("baselineOrder", -1);
+    json::const_iterator resampleDT = settings.find("resampleDT");
+    if (resampleDT != settings.end())
+    {
+        if (resampleDT->is_string() && resampleDT->get<std::string>() == "auto")
+            m_resampleDT = -1.0;
+        else if (resampleDT->is_number())
+            m_resampleDT = std::max(0.0, resampleDT->get<double>());
+    }
+    json::const_iterator trim = settings.find("trim");
+    if (trim != settings.end())
+    {
+        if (trim->is_boolean())
+            m_trim = trim->get<bool>();
+        else if (trim->is_object())
+        {
+            m_trim = true;
+            m_trimFrom = std::min(1.0, std::max(0.0, trim->value("from", m_trimFrom)));
+            m_trimTo = std::min(1.0, std::max(m_trimFrom, trim->value("to", m_trimTo)));
+            m_trimLead = std::max(0.0, trim->value("lead", m_trimLead));
+            m_trimTail = std::max(0.0, trim->value("tail", m_trimTail));
+            m_trimTaper = std::min(m_trimTail, std::max(0.0, trim->value("taper", m_trimTaper)));
+        }
+    }
+}
+
+bool MotionPreprocessor::isEnabled() const
+{
+    return m_lowCut > 0.0 || m_highCut > 0.0 || m_baselineOrder >= 1 || m_resampleDT != 0.0 || m_trim;
+}
+
+std::string MotionPreprocessor::key() const
+{
+    char text[320];
+    std::snprintf(text, sizeof(text), "motionProcessing 1 %.17g %.17g %d %d %.17g",
+                  m_lowCut, m_highCut, m_filterOrder, m_baselineOrder, m_resampleDT);
+    if (m_trim)
+    {
+        size_t length = std::strlen(text);
+        std::snprintf(text + length, sizeof(text) - length, " trim %.17g %.17g %.17g %.17g %.17g",
+                      m_trimFrom, m_trimTo, m_trimLead, m_trimTaper, m_trimTail);
+    }
+    return std::string(text);
+}
+
+void MotionPreprocessor::butterworth(std::vector<double> &x, double dt, double lowCut, double highCut, int order)
+{
+    size_t n = x.size();
+    if (n < 3 || dt <= 0.0 || order < 1)
+        return;
+
+    std::vector<Section> sections;
+    if (lowCut > 0.0 && lowCut * dt < 0.5)
+        sections = butterworthSections(lowCut, dt, order, true);
+    if (highCut > 0.0 && highCut * dt < 0.5)
+    {
+        std::vector<Section> lowPass = butterworthSections(highCut, dt, order, false);
+        sections.insert(sections.end(), lowPass.begin(), lowPass.end());
+    } else if (highCut > 0.0)
+        std::cerr << "MotionPreprocessor: highCut " << highCut << " Hz is above the Nyquist frequency, not applied\n";
+    if (sections.empty())
+        return;
+
+    // odd reflection at both ends against the start up transients, about a
+    // period of the low cut long
+    size_t pad = 6 * size_t(order);
+    if (lowCut > 0.0)
+        pad = std::max(pad, size_t(1.0 / (lowCut * dt)));
+    pad = std::min(pad, n - 1);
+
+    std::vector<double> y(n + 2 * pad);
+    for (size_t j = 0; j < pad; j++)
+    {
+        y[pad - 1 - j] = 2.0 * x[0] - x[j + 1];
+        y[pad + n + j] = 2.0 * x[n-1] - x[n - 2 - j];
+    }
+    std::copy(x.begin(), x.end(), y.begin() + pad);
+
+    // forwards, then backwards: zero phase
+    runSections(sections, &y[0], y.size());
+    std::reverse(y.begin(), y.end());
+    runSections(sections, &y[0], y.size());
+    std::reverse(y.begin(), y.end());
+
+    std::copy(y.begin() + pad, y.begin() + pad + n, x.begin());
+}
+
+void MotionPreprocessor::removeBaseline(std::vector<double> &vel, double dt, int order)
+{
+    size_t n = vel.size();
+    order = std::min(std::max(order, 2), 10);
+    if (n < size_t(order) + 2 || dt <= 0.0)
+        return;
+
+    // displacement, and the least squares polynomial in tau = t/T without the
+    // constant and linear terms (c2 tau^2 + ... + c_order tau^order), so the
+    // correction leaves the displacement and the velocity at t = 0 alone
+    double T = dt * (n - 1);
+    std::vector<double> disp(n, 0.0);
+    for (size_t i = 1; i < n; i++)
+        disp[i] = disp[i-1] + 0.5 * dt * (vel[i-1] + vel[i]);
+
+    int m = order - 1;
+    std::vector<double> powerSums(2 * m - 1, 0.0);
+    std::vector<double> A(m * m), b(m, 0.0);
+    for (size_t i = 0; i < n; i++)
+    {
+        double tau = double(i) / double(n - 1);
+        // p = tau^(k+2): b[k] sums tau^(k+2) d, powerSums[k] sums tau^(k+4)
+        double p = tau * tau;
+        for (int k = 0; k < 2 * m + 1; k++)
+        {
+            if (k < m)
+                b[k] += p * disp[i];
+            if (k >= 2)
+                powerSums[k-2] += p;
+            p *= tau;
+        }
+    }
+    for (int r = 0; r < m; r++)
+        for (int c = 0; c < m; c++)
+            A[r * m + c] = powerSums[r + c];
+
+    // Gaussian elimination with partial pivoting
+    for (int c = 0; c < m; c++)
+    {
+        int pivot = c;
+        for (int r = c + 1; r < m; r++)
+            if (std::fabs(A[r * m + c]) > std::fabs(A[pivot * m + c]))
+                pivot = r;
+        if (std::fabs(A[pivot * m + c]) < 1.0e-300)
+            return;
+        if (pivot != c)
+        {
+            for (int k = 0; k < m; k++)
+                std::swap(A[c * m + k], A[pivot * m + k]);
+            std::swap(b[c], b[pivot]);
+        }
+        for (int r = c + 1; r < m; r++)
+        {
+            double f = A[r * m + c] / A[c * m + c];
+            for (int k = c; k < m; k++)
+                A[r * m + k] -= f * A[c * m + k];
+            b[r] -= f * b[c];
+        }
+    }
+    std::vector<double> coef(m);
+    for (int r = m - 1; r >= 0; r--)
+    {
+        double s = b[r];
+        for (int k = r + 1; k < m; k++)
+            s -= A[r * m + k] * coef[k];
+        coef[r] = s / A[r * m + r];
+    }
+
+    // minus the derivative of the polynomial, d/dt = d/dtau / T
+    for (size_t i = 0; i < n; i++)
+    {
+        double tau = double(i) / double(n - 1);
+        double derivative = 0.0;
+        for (int k = m - 1; k >= 0; k--)
+            derivative = derivative * tau + (k + 2) * coef[k];
+        vel[i] -= derivative * tau / T;
+    }
+}
+
+std::vector<double> MotionPreprocessor::resample(const std::vector<double> &x, double dt, double newDT)
+{
+    size_t n = x.size();
+    if (n < 2 || dt <= 0.0 || newDT <= 0.0 || newDT == dt)
+        return x;
+
+    size_t m = size_t(std::floor((n - 1) * dt / newDT + 1.0e-9)) + 1;
+    std::vector<double> y(m);
+    // the kernel is stretched when the record is made coarser
+    double stretch = std::max(1.0, newDT / dt);
+    double halfWidth = LANCZOS_LOBES * stretch;
+    for (size_t i = 0; i < m; i++)
+    {
+        double center = i * newDT / dt;
+        long first = std::max(0L, long(std::ceil(center - halfWidth)));
+        long last = std::min(long(n) - 1, long(std::floor(center + halfWidth)));
+        double sum = 0.0, weights = 0.0;
+        for (long j = first; j <= last; j++)
+        {
+            double w = lanczos((center - j) / stretch);
+            sum += w * x[size_t(j)];
+            weights += w;
+        }
+        y[i] = weights != 0.0 ? sum / weights : 0.0;
+    }
+    return y;
+}
+
+void MotionPreprocessor::ariasWindow(const std::vector<std::vector<double>> &components, double dt,
+                                     double from, double to, int &first, int &last)
+{
+    int n = components.empty() ? 0 : int(components[0].size());
+    first = 0;
+    last = n - 1;
+    if (n < 3 || dt <= 0.0)
+        return;
+
+    // cumulative integral of the squared acceleration (central differences)
+    // summed over the components, the constant of the Arias intensity cancels
+    std::vector<double> intensity(n, 0.0);
+    for (size_t c = 0; c < components.size(); c++)
+    {
+        const std::vector<double> &vel = components[c];
+        if (int(vel.size()) != n)
+            continue;
+        double sum = 0.0;
+        double previous = (vel[1] - vel[0]) / dt;
+        for (int i = 1; i < n; i++)
+        {
+            double acc = i + 1 < n ? (vel[i+1] - vel[i-1]) / (2.0 * dt) : (vel[i] - vel[i-1]) / dt;
+            sum += 0.5 * dt * (previous * previous + acc * acc);
+            intensity[i] += sum;
+            previous = acc;
+        }
+    }
+    double total = intensity[n-1];
+    if (total <= 0.0)
+        return;
+
+    first = int(std::lower_bound(intensity.begin(), intensity.end(), from * total) - intensity.begin());
+    last = int(std::lower_bound(intensity.begin(), intensity.end(), to * total) - intensity.begin());
+    first = std::min(first, n - 1);
+    last = std::max(first, std::min(last, n - 1));
+}
+
+std::vector<std::vector<double>> MotionPreprocessor::process(const std::vector<std::vector<double>> &components,
+                                                             double dt, double &newDT, std::string *report) const
+{
+    std::vector<std::vector<double>> v(components);
+    for (size_t c = 0; c < v.size(); c++)
+        butterworth(v[c], dt, m_lowCut, m_highCut, m_filterOrder);
+
+    newDT = dt;
+    if (m_resampleDT > 0.0)
+        newDT = m_resampleDT;
+    else if (m_resampleDT < 0.0 && m_highCut > 0.0)
+        newDT = std::max(dt, 0.5 / (1.25 * m_highCut));
+
+    if (newDT != dt)
+    {
+        // anti-alias if the content above the new Nyquist frequency is still there
+        double maxFrequency = ANTI_ALIAS_FRACTION * 0.5 / newDT;
+        for (size_t c = 0; c < v.size(); c++)
+        {
+            if (newDT > dt && (m_highCut <= 0.0 || m_highCut > maxFrequency))
+                butterworth(v[c], dt, 0.0, maxFrequency, std::max(m_filterOrder, 4));
+            v[c] = resample(v[c], dt, newDT);
+        }
+    }
+
+    if (m_trim && !v.empty() && v[0].size() > 2)
+    {
+        // one window for the event, so the components stay in step
+        int start, end;
+        ariasWindow(v, newDT, m_trimFrom, m_trimTo, start, end);
+        int n = int(v[0].size());
+        int first = std::max(0, start - int(std::round(m_trimLead / newDT)));
+        int taper = int(std::round(m_trimTaper / newDT));
+        int last = end + int(std::round(m_trimTail / newDT));
+
+        // ramp up over the lead, ramp down over the taper, then quiet
+        for (size_t c = 0; c < v.size(); c++)
+        {
+            std::vector<double> trimmed(size_t(last - first + 1), 0.0);
+            for (int i = first; i <= last && i < int(v[c].size()); i++)
+            {
+                double w = 1.0;
+                if (i < start)
+                    w = 0.5 * (1.0 - std::cos(PI * (i - first) / double(start - first)));
+                else if (i > end)
+                    w = i - end < taper ? 0.5 * (1.0 + std::cos(PI * (i - end) / double(taper))) : 0.0;
+                trimmed[size_t(i - first)] = w * v[c][size_t(i)];
+            }
+            v[c].swap(trimmed);
+        }
+
+        if (report)
+        {
+            char text[320];
+            std::snprintf(text, sizeof(text),
+                          "D%g-D%g %.3f-%.3f s, kept %.3f-%.3f s (tail %.3f s): %d of %d motion steps (%.0f%% fewer dynamic steps)",
+                          100.0 * m_trimFrom, 100.0 * m_trimTo, start * newDT, end * newDT,
+                          first * newDT, last * newDT, m_trimTail, last - first + 1, n,
+                          100.0 * (1.0 - double(last - first) / double(n - 1)));
+            *report += text;
+        }
+    }
+
+    for (size_t c = 0; c < v.size(); c++)
+        removeBaseline(v[c], newDT, m_baselineOrder);
+    return v;
+}
+
+bool MotionPreprocessor::prepare(const std::vector<std::string> &motionNames, const std::string &cacheDir) const
+{
+    struct Component
+    {
+        std::string name, timeFile, velFile, accFile, original;
+        bool processed, originalVel, originalAcc;
+    };
+    std::vector<Component> components;
+
+    for (size_t c = 0; c < motionNames.size(); c++)
+    {
+        Component m;
+        m.name = motionNames[c];
+        m.timeFile = m.name + ".time";
+        m.velFile = m.name + ".vel";
+        m.accFile = m.name + ".acc";
+        m.original = cacheDir + "/" + m.name.substr(m.name.find_last_of("/\\") + 1) + ".raw";
+
+        // nothing was ever processed here
+        if (!isEnabled() && !fileExists(m.original + ".time"))
+            continue;
+
+        bool hasVel = fileExists(m.velFile);
+        bool hasAcc = fileExists(m.accFile);
+        if (!fileExists(m.timeFile) || (!hasVel && !hasAcc))
+        {
+            std::cerr << "MotionPreprocessor: no velocity or acceleration for " << m.name << ", not processed\n";
+            return false;
+        }
+
+        // the files are the output of an earlier prepare() if their hash is
+        // marked, anything else is a new record, which is kept as the original
+        std::vector<std::string> current;
+        current.push_back(m.timeFile);
+        current.push_back(hasVel ? m.velFile : m.accFile);
+        m.processed = fileExists(cacheDir + "/" + hashInputs("", current) + ".done")
+                && fileExists(m.original + ".time");
+        if (!m.processed)
+        {
+            makeDir(cacheDir);
+            std::remove((m.original + ".vel").c_str());
+            std::remove((m.original + ".acc").c_str());
+            bool ok = copyFile(m.timeFile, m.original + ".time");
+            if (ok && hasVel)
+                ok = copyFile(m.velFile, m.original + ".vel");
+            if (ok && hasAcc)
+                ok = copyFile(m.accFile, m.original + ".acc");
+            if (!ok)
+            {
+                std::cerr << "MotionPreprocessor: could not keep the original " << m.name << " in " << cacheDir << ", not processed\n";
+                return false;
+            }
+        }
+
+        m.originalVel = fileExists(m.original + ".vel");
+        m.originalAcc = fileExists(m.original + ".acc");
+        components.push_back(m);
+    }
+
+    // processing switched off: the original records go back
+    if (!isEnabled())
+    {
+        for (size_t c = 0; c < components.size(); c++)
+        {
+            const Component &m = components[c];
+            if (!m.processed)
+                continue;
+            bool ok = copyFile(m.original + ".time", m.timeFile);
+            if (ok && m.originalVel)
+                ok = copyFile(m.original + ".vel", m.velFile);
+            else if (ok)
+                std::remove(m.velFile.c_str());
+            if (ok && m.originalAcc)
+                ok = copyFile(m.original + ".acc", m.accFile);
+            else if (ok)
+                std::remove(m.accFile.c_str());
+            if (!ok)
+            {
+                std::cerr << "MotionPreprocessor: could not restore the original " << m.name << "\n";
+                return false;
+            }
+            std::cout << "Motion " << m.name << " restored to the original record" << std::endl;
+        }
+        return true;
+    }
+    if (components.empty())
+        return true;
+
+    std::vector<std::string> inputs;
+    for (size_t c = 0; c < components.size(); c++)
+    {
+        inputs.push_back(components[c].original + ".time");
+        inputs.push_back(components[c].original + (components[c].originalVel ? ".vel" : ".acc"));
+    }
+    std::string cached = cacheDir + "/" + hashInputs(key(), inputs);
+
+    bool done = fileExists(cached + ".log");
+    for (size_t c = 0; c < components.size(); c++)
+    {
+        std::string output = cached + "." + std::to_string(c);
+        done = done && fileExists(output + ".time") && fileExists(output + ".vel")
+                && (!components[c].originalAcc || fileExists(output + ".acc"));
+    }
+    if (!done)
+    {
+        // the velocities on the grid of the first component
+        std::vector<std::vector<double>> values(components.size());
+        std::vector<double> time;
+        double dt = 0.0;
+        for (size_t c = 0; c < components.size(); c++)
+        {
+            std::vector<double> t;
+            MotionFile::read(inputs[2*c].c_str(), t);
+            MotionFile::read(inputs[2*c+1].c_str(), values[c]);
+            if (t.size() < 3 || t.size() != values[c].size())
+            {
+                std::cerr << "MotionPreprocessor: " << inputs[2*c+1] << " and " << inputs[2*c] << " do not match, not processed\n";
+                return false;
+            }
+
+            double step;
+            if (!MotionFile::uniformStep(t, step))
+                makeUniform(t, values[c], step);
+
+            // velocity from the acceleration in g
+            if (!components[c].originalVel)
+            {
+                std::vector<double> vel(values[c].size(), 0.0);
+                for (size_t i = 1; i < vel.size(); i++)
+                    vel[i] = vel[i-1] + 0.5 * step * GRAVITY * (values[c][i-1] + values[c][i]);
+                values[c].swap(vel);
+            }
+
+            if (c == 0)
+            {
+                time.swap(t);
+                dt = step;
+                continue;
+            }
+            if (std::fabs(step - dt) > 1.0e-9 * dt)
+                values[c] = resample(values[c], step, dt);
+            // a shorter record holds its last velocity
+            values[c].resize(values[0].size(), values[c].back());
+        }
+
+        double newDT;
+        std::string report;
+        std::vector<std::vector<double>> vel = process(values, dt, newDT, &report);
+        std::vector<double> newTime(vel[0].size());
+        for (size_t i = 0; i < newTime.size(); i++)
+            newTime[i] = time[0] + i * newDT;
+
+        bool ok = true;
+        for (size_t c = 0; ok && c < components.size(); c++)
+        {
+            std::string output = cached + "." + std::to_string(c);
+            ok = writeColumn(output + ".time", newTime, 12) && writeColumn(output + ".vel", vel[c], 16);
+            if (ok && components[c].originalAcc)
+            {
+                // central differences, in g
+                const std::vector<double> &v = vel[c];
+                size_t n = v.size();
+                std::vector<double> acc(n);
+                for (size_t i = 1; i + 1 < n; i++)
+                    acc[i] = (v[i+1] - v[i-1]) / (2.0 * newDT * GRAVITY);
+                acc[0] = (v[1] - v[0]) / (newDT * GRAVITY);
+                acc[n-1] = (v[n-1] - v[n-2]) / (newDT * GRAVITY);
+                ok = writeColumn(output + ".acc", acc, 16);
+            }
+        }
+        if (ok)
+        {
+            std::ofstream log((cached + ".log").c_str());
+            log << report;
+            ok = log.good();
+        }
+        if (!ok)
+        {
+            std::cerr << "MotionPreprocessor: could not write to " << cacheDir << ", " << components[0].name << " not processed\n";
+            return false;
+        }
+    }
+
+    for (size_t c = 0; c < components.size(); c++)
+    {
+        const Component &m = components[c];
+        std::string output = cached + "." + std::to_string(c);
+        bool ok = copyFile(output + ".time", m.timeFile) && copyFile(output + ".vel", m.velFile);
+        if (ok && m.originalAcc)
+            ok = copyFile(output + ".acc", m.accFile);
+        else if (ok)
+            std::remove(m.accFile.c_str());
+        if (!ok)
+        {
+            std::cerr << "MotionPreprocessor: could not write the processed " << m.name << "\n";
+            return false;
+        }
+
+        printReport(m.name, cached + ".log");
+
+        // mark the processed files so they are told from a new record
+        std::vector<std::string> current;
+        current.push_back(m.timeFile);
+        current.push_back(m.velFile);
+        copyFile(cached + ".log", cacheDir + "/" + hashInputs("", current) + ".done");
+    }
+    return true;
+}
+
+bool MotionPreprocessor::prepare(const std::string &motionName, const std::string &cacheDir) const
+{
+    return prepare(std::vector<std::string>(1, motionName), cacheDir);
+}
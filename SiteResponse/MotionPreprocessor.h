@@ -0,0 +1,105 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+
+#ifndef MOTIONPREPROCESSOR_H
+#define MOTIONPREPROCESSOR_H
+
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+// name of the directory (in the analysis directory) keeping processed motions
+#define MOTION_CACHE_DIR "motionCache"
+
+// Processing of the input motion before the analysis, set by basicSettings
+// "motionProcessing" (a missing key switches its step off):
+//   {"lowCut": 0.1, "highCut": 25.0, "filterOrder": 4, "baselineOrder": 3, "resampleDT": "auto",
+//    "trim": {"from": 0.05, "to": 0.95, "lead": 1.0, "taper": 1.0, "tail": 5.0}}
+// ("trim": true takes these defaults)
+//
+// The velocity (integrated from Rock-x.acc, in g, if there is no .vel) is
+//   1. band-pass filtered with a zero-phase Butterworth filter: a high-pass at
+//      lowCut and a low-pass at highCut of filterOrder each, run forwards and
+//      backwards (so the gain is squared and there is no phase shift),
+//   2. resampled to resampleDT with a windowed sinc, after an anti-alias
+//      low-pass if highCut is not already below the new Nyquist frequency.
+//      "auto" picks the step whose Nyquist frequency is 1.25 highCut (never
+//      finer than the record),
+//   3. trimmed to its significant duration: the window between from and to
+//      (D5-D95 by default) of the Arias intensity (summed over the components
+//      of the event, which are all cut to the same window), with lead seconds before it
+//      ramped up from zero and tail seconds after it, of which the first taper
+//      seconds ramp down to zero and the rest is quiet (zeros past the end of
+//      the record) so pore pressures can redistribute. The trimmed record
+//      starts at 0, and the analysis has fewer steps in proportion,
+//   4. corrected by the derivative of the polynomial c2 t^2 + ... of degree
+//      baselineOrder (at least 2) fitted to its displacement, which removes the
+//      displacement drift without moving the velocity at t = 0.
+//
+// prepare() keeps the motion files it finds as the original record in
+// MOTION_CACHE_DIR (<name>.raw.*) and always processes from that copy, writing
+// the result over the motion files (.time, .vel and .acc if the record had
+// one) so the internal solver and the generated tcl both read the processed
+// motion, and prints what trimming saved. Results are kept in MOTION_CACHE_DIR
+// keyed by a hash of the settings and the original, and processed files are
+// marked by their hash so they are told from a new record. With processing
+// switched off prepare() puts the original record back.
+class MotionPreprocessor
+{
+public:
+    MotionPreprocessor();
+    explicit MotionPreprocessor(const json &settings);
+
+    bool isEnabled() const;
+
+    // motionNames without extension (.../Rock-x, .../Rock-y), the components
+    // of one event, processed together on the time step of the first; false
+    // if the motions could not be processed (or restored), the files are left
+    // as they are then
+    bool prepare(const std::vector<std::string> &motionNames, const std::string &cacheDir) const;
+    bool prepare(const std::string &motionName, const std::string &cacheDir) const;
+
+    // the steps on uniformly sampled velocities of the same length, returns
+    // the processed velocities at newDT; a line on the trimming is appended
+    // to report
+    std::vector<std::vector<double>> process(const std::vector<std::vector<double>> &components,
+                                             double dt, double &newDT, std::string *report = nullptr) const;
+
+    // zero-phase Butterworth, a cut <= 0 is left out
+    static void butterworth(std::vector<double> &x, double dt, double lowCut, double highCut, int order);
+    static void removeBaseline(std::vector<double> &vel, double dt, int order);
+    static std::vector<double> resample(const std::vector<double> &x, double dt, double newDT);
+    // samples where the Arias intensity of the velocities' derivatives,
+    // summed over the components, reaches the fractions from and to of its total
+    static void ariasWindow(const std::vector<std::vector<double>> &components, double dt,
+                            double from, double to, int &first, int &last);
+
+private:
+    // settings as text, part of the cache key
+    std::string key() const;
+
+    double m_lowCut;
+    double m_highCut;
+    int m_filterOrder;
+    int m_baselineOrder;
+    double m_resampleDT;   // < 0: auto
+    bool m_trim;
+    double m_trimFrom;
+    double m_trimTo;
+    double m_trimLead;
+    double m_trimTaper;
+    double m_trimTail;
+};
+
+#endif // MOTIONPREPROCESSOR_H
@@ -0,0 +1,128 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+#include "ProgressChannel.h"
+
+#include <cmath>
+#include <algorithm>
+
+ProgressChannel::ProgressChannel()
+    : m_start(std::chrono::steady_clock::now())
+{
+
+}
+
+ProgressChannel::~ProgressChannel()
+{
+    close();
+}
+
+bool ProgressChannel::open(const std::string &fileName)
+{
+    close();
+    m_file.open(fileName.c_str(), std::ofstream::out | std::ofstream::trunc);
+    m_start = std::chrono::steady_clock::now();
+    return m_file.is_open();
+}
+
+void ProgressChannel::close()
+{
+    if (m_file.is_open())
+        m_file.close();
+}
+
+double ProgressChannel::wallTime() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+int ProgressChannel::subStepDepth(double dT, double dt)
+{
+    if (dT <= 0.0 || dt <= 0.0)
+        return 0;
+    return std::max(0, int(std::round(std::log2(dT / dt))));
+}
+
+// every event is flushed, the reader may be waiting for it
+void ProgressChannel::stage(const std::string &name)
+{
+    if (!isOpen()) return;
+    m_file << "{\"event\":\"stage\",\"wall\":" << wallTime() << ",\"name\":\"" << name << "\"}" << std::endl;
+}
+
+void ProgressChannel::start(int nSteps, double dT, double finalTime)
+{
+    if (!isOpen()) return;
+    m_file << "{\"event\":\"start\",\"wall\":" << wallTime() << ",\"nSteps\":" << nSteps
+           << ",\"dT\":" << dT << ",\"finalTime\":" << finalTime << "}" << std::endl;
+}
+
+void ProgressChannel::step(double time, int step, double dt, int subStep, int numIter, double progress)
+{
+    if (!isOpen()) return;
+    double wall = wallTime();
+    m_file << "{\"event\":\"step\",\"wall\":" << wall << ",\"time\":" << time << ",\"step\":" << step
+           << ",\"dt\":" << dt << ",\"subStep\":" << subStep << ",\"iter\":" << numIter
+           << ",\"progress\":" << progress << ",\"rate\":" << time / std::max(wall, 1.0e-3) << "}" << std::endl;
+}
+
+void ProgressChannel::reject(double time, double dt, int subStep, int numIter)
+{
+    if (!isOpen()) return;
+    m_file << "{\"event\":\"reject\",\"wall\":" << wallTime() << ",\"time\":" << time << ",\"dt\":" << dt
+           << ",\"subStep\":" << subStep << ",\"iter\":" << numIter << "}" << std::endl;
+}
+
+void ProgressChannel::analysis(int accepted, int rejected, long numIter, bool ok)
+{
+    if (!isOpen()) return;
+    m_file << "{\"event\":\"analysis\",\"wall\":" << wallTime() << ",\"accepted\":" << accepted
+           << ",\"rejected\":" << rejected << ",\"iterations\":" << numIter << ",\"ok\":" << (ok ? 1 : 0) << "}" << std::endl;
+}
+
+void ProgressChannel::warning(const std::string &message)
+{
+    if (!isOpen()) return;
+    m_file << "{\"event\":\"warning\",\"wall\":" << wallTime() << ",\"message\":\"" << message << "\"}" << std::endl;
+}
+
+void ProgressChannel::finished(bool ok)
+{
+    if (!isOpen()) return;
+    m_file << "{\"event\":\"finished\",\"wall\":" << wallTime() << ",\"ok\":" << (ok ? 1 : 0) << "}" << std::endl;
+}
+
+void ProgressChannel::writeTclOpen(std::ostream &s)
+{
+    s << "file mkdir out_tcl" << "\n";
+    s << "set progressChannel [open out_tcl/" << PROGRESS_FILE_NAME << " w]" << "\n";
+    s << "fconfigure $progressChannel -buffering line" << "\n";
+    s << "set progressStart [clock milliseconds]" << "\n";
+    s << "proc progressEvent {event args} {" << "\n";
+    s << "	global progressChannel progressStart" << "\n";
+    s << "	set wall [expr ([clock milliseconds]-$progressStart)/1000.0]" << "\n";
+    s << "	set line \"{\\\"event\\\":\\\"$event\\\",\\\"wall\\\":$wall\"" << "\n";
+    s << "	foreach {key value} $args {" << "\n";
+    s << "		append line \",\\\"$key\\\":$value\"" << "\n";
+    s << "		if {$key == \"time\"} {" << "\n";
+    s << "			append line \",\\\"rate\\\":[expr $value/max($wall,1.0e-3)]\"" << "\n";
+    s << "		}" << "\n";
+    s << "	}" << "\n";
+    s << "	puts $progressChannel \"$line}\"" << "\n";
+    s << "}" << "\n" << "\n";
+}
+
+void ProgressChannel::writeTclFinished(std::ostream &s)
+{
+    s << "progressEvent finished ok [expr $success == 0]" << "\n";
+    s << "close $progressChannel" << "\n";
+}
@@ -0,0 +1,73 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+
+#ifndef PROGRESSCHANNEL_H
+#define PROGRESSCHANNEL_H
+
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+// written to the recorder directory (out_tcl)
+#define PROGRESS_FILE_NAME "progress.jsonl"
+
+// Status of a running analysis as line-delimited JSON, one event per line:
+//   {"event":"stage","wall":0.1,"name":"gravity"}
+//   {"event":"start","wall":2.3,"nSteps":4000,"dT":0.0025,"finalTime":10}
+//   {"event":"step","wall":5.1,"time":0.4,"step":160,"dt":0.0025,"subStep":0,"iter":3,"progress":4,"rate":0.08}
+//   {"event":"reject","wall":6.0,"time":0.52,"dt":0.00125,"subStep":1,"iter":35}
+//   {"event":"analysis","wall":90.2,"accepted":4120,"rejected":6,"iterations":13200,"ok":1}
+//   {"event":"warning","wall":90.3,"message":"equivalent linear not converged in 30 iterations"}
+//   {"event":"finished","wall":90.4,"ok":1}
+// "wall" is the wall clock time in seconds since the channel was opened, "rate"
+// the simulated time per wall clock second. "finished" is the last event,
+// written after the recorders are closed.
+//
+// The generated tcl writes the same events through the proc from writeTclOpen().
+class ProgressChannel
+{
+public:
+    ProgressChannel();
+    ~ProgressChannel();
+
+    bool open(const std::string &fileName);
+    void close();
+    bool isOpen() const { return m_file.is_open(); }
+
+    void stage(const std::string &name);
+    void start(int nSteps, double dT, double finalTime);
+    void step(double time, int step, double dt, int subStep, int numIter, double progress);
+    void reject(double time, double dt, int subStep, int numIter);
+    void analysis(int accepted, int rejected, long numIter, bool ok);
+    // message is written as given, without quotes or backslashes
+    void warning(const std::string &message);
+    void finished(bool ok);
+
+    // substep depth of dt relative to the nominal dT (0 at dT, 1 at dT/2, ...)
+    static int subStepDepth(double dT, double dt);
+
+    // tcl: opens out_tcl/progress.jsonl and defines
+    // proc progressEvent {event key value ...}; values are written as given.
+    static void writeTclOpen(std::ostream &s);
+    // tcl: the finished event, ok if $success is 0, and close the channel
+    static void writeTclFinished(std::ostream &s);
+
+private:
+    double wallTime() const;
+
+    std::ofstream m_file;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#endif // PROGRESSCHANNEL_H
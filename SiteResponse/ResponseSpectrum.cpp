@@ -0,0 +1,176 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+#include "ResponseSpectrum.h"
+
+#include <cmath>
+#include <thread>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+ResponseSpectrum::ResponseSpectrum()
+    : m_periods(defaultPeriods()), m_damping(1, 0.05)
+{
+
+}
+
+ResponseSpectrum::ResponseSpectrum(const std::vector<double> &periods, const std::vector<double> &dampingRatios)
+    : m_periods(periods), m_damping(dampingRatios)
+{
+
+}
+
+std::vector<double> ResponseSpectrum::defaultPeriods()
+{
+    std::vector<double> periods(100);
+    for (int n = 0; n < 100; n++)
+        periods[n] = 0.04 + n * 0.02;
+    return periods;
+}
+
+void ResponseSpectrum::setupCoefficients(double dt, Coefficients &c) const
+{
+    int numOsc = getNumOscillators();
+    c.a11.assign(numOsc, 0.0); c.a12.assign(numOsc, 0.0);
+    c.a21.assign(numOsc, 0.0); c.a22.assign(numOsc, 0.0);
+    c.b11.assign(numOsc, 0.0); c.b12.assign(numOsc, 0.0);
+    c.b21.assign(numOsc, 0.0); c.b22.assign(numOsc, 0.0);
+    c.w2.assign(numOsc, 0.0);
+    c.rigid.assign(numOsc, 0);
+
+    int numPeriods = int(m_periods.size());
+    for (int d = 0; d < int(m_damping.size()); d++)
+    {
+        double xi = std::min(std::max(m_damping[d], 0.0), 0.999);
+        for (int p = 0; p < numPeriods; p++)
+        {
+            int k = d * numPeriods + p;
+            double T = m_periods[p];
+            if (T <= 0.0)
+            {
+                // infinitely stiff oscillator: Sa = pga
+                c.rigid[k] = 1;
+                continue;
+            }
+            double w = 2.0 * M_PI / T;
+            double w2 = w * w;
+            double wd = w * std::sqrt(1.0 - xi * xi);
+            double E = std::exp(-xi * w * dt);
+            double S = std::sin(wd * dt);
+            double C = std::cos(wd * dt);
+
+            // free vibration over one step
+            double a11 = E * (C + xi * w / wd * S);
+            double a12 = E * S / wd;
+            double a21 = -w2 * a12;
+            double a22 = E * (C - xi * w / wd * S);
+
+            // forced part for u'' + 2 xi w u' + w^2 u = -ag, ag linear within the step
+            double f0 = -1.0 / w2 - 2.0 * xi / (w2 * w * dt);
+            double f1 = 2.0 * xi / (w2 * w * dt);
+            double g1 = 1.0 / (w2 * dt);
+
+            c.a11[k] = a11; c.a12[k] = a12;
+            c.a21[k] = a21; c.a22[k] = a22;
+            c.b11[k] = (1.0 - a11) * f0 + (dt - a12) * g1;
+            c.b12[k] = (1.0 - a11) * f1 - (dt - a12) * g1;
+            c.b21[k] = -a21 * f0 + (1.0 - a22) * g1;
+            c.b22[k] = -a21 * f1 - (1.0 - a22) * g1;
+            c.w2[k] = w2;
+        }
+    }
+}
+
+// one step of every oscillator. The oscillators are independent, so with the
+// state arrays marked __restrict this loop is vectorized by the compiler.
+static void advanceOscillators(int numOsc, double ag0, double ag1,
+                               double * __restrict u, double * __restrict v, double * __restrict uMax,
+                               const double *a11, const double *a12, const double *a21, const double *a22,
+                               const double *b11, const double *b12, const double *b21, const double *b22)
+{
+    for (int k = 0; k < numOsc; k++)
+    {
+        double un = a11[k] * u[k] + a12[k] * v[k] + b11[k] * ag0 + b12[k] * ag1;
+        double vn = a21[k] * u[k] + a22[k] * v[k] + b21[k] * ag0 + b22[k] * ag1;
+        double au = std::fabs(un);
+        u[k] = un;
+        v[k] = vn;
+        uMax[k] = au > uMax[k] ? au : uMax[k];
+    }
+}
+
+void ResponseSpectrum::run(const Coefficients &c, const double *acc, int numSteps, int stride, double *sa) const
+{
+    int numOsc = getNumOscillators();
+    std::vector<double> u(numOsc, 0.0);
+    std::vector<double> v(numOsc, 0.0);
+    std::vector<double> uMax(numOsc, 0.0);
+
+    double pga = numSteps > 0 ? std::fabs(acc[0]) : 0.0;
+    for (int i = 0; i + 1 < numSteps; i++)
+    {
+        double ag0 = acc[size_t(i) * stride];
+        double ag1 = acc[size_t(i + 1) * stride];
+        pga = std::max(pga, std::fabs(ag1));
+        advanceOscillators(numOsc, ag0, ag1, u.data(), v.data(), uMax.data(),
+                           c.a11.data(), c.a12.data(), c.a21.data(), c.a22.data(),
+                           c.b11.data(), c.b12.data(), c.b21.data(), c.b22.data());
+    }
+
+    for (int k = 0; k < numOsc; k++)
+        sa[k] = c.rigid[k] ? pga : c.w2[k] * uMax[k];
+}
+
+void ResponseSpectrum::compute(const double *acc, int numSteps, int stride, double dt, double *sa) const
+{
+    Coefficients c;
+    setupCoefficients(dt, c);
+    run(c, acc, numSteps, stride, sa);
+}
+
+void ResponseSpectrum::computeAll(const std::vector<const double *> &records, int numSteps, double dt,
+                                  std::vector<std::vector<double> > &sa, int numThreads) const
+{
+    int numRecords = int(records.size());
+    int numOsc = getNumOscillators();
+    sa.assign(numRecords, std::vector<double>(numOsc, 0.0));
+    if (numRecords < 1 || numOsc < 1)
+        return;
+
+    Coefficients c;
+    setupCoefficients(dt, c);
+
+    if (numThreads < 1)
+        numThreads = int(std::thread::hardware_concurrency());
+    numThreads = std::max(1, std::min(numThreads, numRecords));
+
+    if (numThreads == 1)
+    {
+        for (int r = 0; r < numRecords; r++)
+            run(c, records[r], numSteps, 1, sa[r].data());
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++)
+    {
+        workers.push_back(std::thread([&, t]() {
+            for (int r = t; r < numRecords; r += numThreads)
+                run(c, records[r], numSteps, 1, sa[r].data());
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
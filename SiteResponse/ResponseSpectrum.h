@@ -0,0 +1,65 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+
+#ifndef RESPONSESPECTRUM_H
+#define RESPONSESPECTRUM_H
+
+#include <vector>
+
+// Pseudo-acceleration response spectra of linear SDOF oscillators.
+//
+// Uses the exact recurrence for a piecewise-linear excitation
+// (Nigam & Jennings, 1969): no history is stored, every oscillator of the
+// period x damping grid is advanced together, one time step at a time.
+// Sa = w^2 * max|u|, in the units of the input acceleration.
+class ResponseSpectrum
+{
+public:
+    ResponseSpectrum();
+    ResponseSpectrum(const std::vector<double> &periods, const std::vector<double> &dampingRatios);
+
+    void setPeriods(const std::vector<double> &periods) { m_periods = periods; }
+    void setDampingRatios(const std::vector<double> &dampingRatios) { m_damping = dampingRatios; }
+    const std::vector<double> &getPeriods() const { return m_periods; }
+    const std::vector<double> &getDampingRatios() const { return m_damping; }
+    int getNumOscillators() const { return int(m_periods.size() * m_damping.size()); }
+
+    // T = 0.04 + 0.02 n, n = 0..99
+    static std::vector<double> defaultPeriods();
+
+    // spectrum of one record. acc[i*stride], i = 0..numSteps-1.
+    // sa must hold getNumOscillators() values, laid out sa[d * numPeriods + p].
+    void compute(const double *acc, int numSteps, int stride, double dt, double *sa) const;
+
+    // spectra of several records of the same length and dt, spread over numThreads
+    // threads (0: use all cores). sa[r] is laid out as in compute().
+    void computeAll(const std::vector<const double *> &records, int numSteps, double dt,
+                    std::vector<std::vector<double> > &sa, int numThreads = 0) const;
+
+private:
+    struct Coefficients
+    {
+        std::vector<double> a11, a12, a21, a22;
+        std::vector<double> b11, b12, b21, b22;
+        std::vector<double> w2;
+        std::vector<char> rigid;
+    };
+
+    void setupCoefficients(double dt, Coefficients &c) const;
+    void run(const Coefficients &c, const double *acc, int numSteps, int stride, double *sa) const;
+
+    std::vector<double> m_periods;
+    std::vector<double> m_damping;
+};
+
+#endif // RESPONSESPECTRUM_H
@@ -0,0 +1,146 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+#include "StepSizeController.h"
+
+#include <cmath>
+#include <sstream>
+#include <algorithm>
+
+StepSizeController::StepSizeController(double dtNominal, double dtMin, double dtMax, int maxIter)
+    : m_dtNominal(dtNominal), m_maxIter(maxIter)
+{
+    m_dtMax = dtMax > 0.0 ? dtMax : dtNominal;
+    m_dtMin = dtMin > 0.0 ? std::min(dtMin, m_dtMax) : m_dtMax / 1024.; // what 10 halvings used to reach
+    m_dt = std::min(dtNominal, m_dtMax);
+    m_easyIter = 3;
+    m_hardIter = std::max(m_easyIter + 1, maxIter / 3);
+}
+
+double StepSizeController::nextDt(double currentTime, double finalTime) const
+{
+    double target = finalTime;
+    if (m_outputDT > 0.0)
+        target = std::min(target, (std::floor(currentTime / m_outputDT + 1.0e-6) + 1.0) * m_outputDT);
+    double remaining = target - currentTime;
+    double dt = std::min(m_dt, remaining);
+    // a remainder under half a step (the rounding of the summed step times,
+    // or what is left to an output point) is taken with this one
+    if (remaining - dt < 0.5 * dt && remaining <= m_dtMax * (1.0 + 1.0e-6))
+        dt = remaining;
+    return dt;
+}
+
+void StepSizeController::setDt(double dt)
+{
+    m_dt = std::max(std::min(dt, m_dtMax), m_dtMin);
+}
+
+void StepSizeController::accept(double dtTaken, int numIter)
+{
+    m_numAccepted++;
+    m_numIter += numIter;
+    if (m_dt < m_dtNominal * (1.0 - 1.0e-9))
+        m_reducedTime += dtTaken;
+
+    if (numIter <= m_easyIter)
+        m_dt = std::min(m_dt * m_growFactor, m_dtMax);
+    else if (numIter >= m_hardIter)
+        m_dt = std::max(m_dt * m_shrinkFactor, m_dtMin);
+}
+
+bool StepSizeController::reject(int numIter)
+{
+    m_numRejected++;
+    m_numIter += numIter;
+    if (m_dt <= m_dtMin)
+        return false;
+    m_dt = std::max(m_dt / 2.0, m_dtMin);
+    return true;
+}
+
+std::string StepSizeController::summary(int nominalSteps) const
+{
+    std::stringstream ss;
+    ss << "Adaptive time stepping: " << m_numAccepted << " steps (" << nominalSteps << " at dT = " << m_dtNominal << "), "
+       << m_numRejected << " rejected, " << m_numIter << " Newton iterations (one factorization each), "
+       << m_reducedTime << " s at steps below dT.";
+    return ss.str();
+}
+
+void StepSizeController::writeTcl(std::ostream &s) const
+{
+    s << "set dtMin " << m_dtMin << "\n";
+    s << "set dtMax " << m_dtMax << "\n";
+    s << "set testMaxIter " << m_maxIter << "\n";
+    s << "set growFactor " << m_growFactor << "\n";
+    s << "set shrinkFactor " << m_shrinkFactor << "\n";
+    s << "set easyIter " << m_easyIter << "\n";
+    s << "set hardIter " << m_hardIter << "\n";
+    s << "set outputDT " << m_outputDT << "\n" << "\n";
+
+    s << "puts \"Start analysis\"" << "\n";
+    s << "set startT [clock seconds]" << "\n";
+    s << "set finalTime [expr $nSteps * $dT]" << "\n";
+    s << "set success 0" << "\n";
+    s << "set currentTime 0." << "\n";
+    s << "set timeMarker 0." << "\n";
+    s << "set curDT [expr min($dT, $dtMax)]" << "\n";
+    s << "set numAccepted 0" << "\n";
+    s << "set numRejected 0" << "\n";
+    s << "set numIter 0" << "\n";
+    s << "set reducedTime 0." << "\n";
+    s << "progressEvent start nSteps $nSteps dT $dT finalTime $finalTime" << "\n";
+    s << "while {$currentTime < $finalTime - 1.0e-9*$dT} {" << "\n";
+    s << "	set target $finalTime" << "\n";
+    s << "	if {$outputDT > 0.} {" << "\n";
+    s << "		set target [expr min($finalTime, (floor($currentTime/$outputDT + 1.0e-6) + 1.)*$outputDT)]" << "\n";
+    s << "	}" << "\n";
+    s << "	set stepDT [expr min($curDT, $target-$currentTime)]" << "\n";
+    s << "	if {$target-$currentTime-$stepDT < 0.5*$stepDT && $target-$currentTime <= $dtMax*(1.0+1.0e-6)} {" << "\n";
+    s << "		set stepDT [expr $target-$currentTime]" << "\n";
+    s << "	}" << "\n";
+    s << "	set success [analyze 1 $stepDT]" << "\n";
+    s << "	set iter [testIter]" << "\n";
+    s << "	incr numIter $iter" << "\n";
+    s << "	if {$success != 0} {" << "\n";
+    s << "		incr numRejected" << "\n";
+    s << "		progressEvent reject time [getTime] dt $stepDT subStep [expr max(0, int(round(log($dT/$stepDT)/log(2.0))))] iter $iter" << "\n";
+    s << "		if {$curDT <= $dtMin} {" << "\n";
+    s << "			puts \"Did not converge at [getTime] with dT = $curDT.\"" << "\n";
+    s << "			break" << "\n";
+    s << "		}" << "\n";
+    s << "		set curDT [expr max($curDT/2.0, $dtMin)]" << "\n";
+    s << "		puts \"Analysis failed at [getTime] . Try dT = $curDT\"" << "\n";
+    s << "		continue" << "\n";
+    s << "	}" << "\n";
+    s << "	incr numAccepted" << "\n";
+    s << "	if {$curDT < $dT*(1.0-1.0e-9)} {" << "\n";
+    s << "		set reducedTime [expr $reducedTime+$stepDT]" << "\n";
+    s << "	}" << "\n";
+    s << "	if {$iter <= $easyIter} {" << "\n";
+    s << "		set curDT [expr min($curDT*$growFactor, $dtMax)]" << "\n";
+    s << "	} elseif {$iter >= $hardIter} {" << "\n";
+    s << "		set curDT [expr max($curDT*$shrinkFactor, $dtMin)]" << "\n";
+    s << "	}" << "\n";
+    s << "	set currentTime [getTime]" << "\n";
+    s << "	set progress [expr $currentTime/$finalTime * 100.]" << "\n";
+    s << "	if { $progress > $timeMarker} {" << "\n";
+    s << "		set timeMarker [expr $timeMarker+1]" << "\n";
+    s << "		progressEvent step time $currentTime step $numAccepted dt $stepDT subStep [expr max(0, int(round(log($dT/$stepDT)/log(2.0))))] iter $iter progress $progress" << "\n";
+    s << "		puts \"$progress%\"" << "\n";
+    s << "	}" << "\n";
+    s << "}" << "\n";
+    s << "progressEvent analysis accepted $numAccepted rejected $numRejected iterations $numIter ok [expr $success == 0]" << "\n" << "\n";
+
+    s << "puts \"Adaptive time stepping: $numAccepted steps ($nSteps at dT = $dT), $numRejected rejected, $numIter Newton iterations (one factorization each), $reducedTime s at steps below dT.\"" << "\n" << "\n";
+}
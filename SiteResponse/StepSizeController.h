@@ -0,0 +1,89 @@
+/* ********************************************************************* **
+**                 Site Response Analysis Tool                           **
+**   -----------------------------------------------------------------   **
+**                                                                       **
+**   Developed by: Charles Wang  (c_w@berkeley.edu)                      **
+**                 Alborz Ghofrani (alborzgh@uw.edu)                     **
+**                 University of Washington                              **
+**                                                                       **
+**   Date: October 2018                                                  **
+**                                                                       **
+** ********************************************************************* */
+
+
+#ifndef STEPSIZECONTROLLER_H
+#define STEPSIZECONTROLLER_H
+
+#include <ostream>
+#include <string>
+
+// Adaptive time step for the dynamic analysis.
+//
+// A failed step is retried with half the step size, down to dtMin.
+// Converged steps change the step size by the number of Newton iterations
+// they took: easy steps grow it (up to dtMax), hard steps shrink it, so a
+// hard stretch of the motion is not re-attempted at dtMax at every step.
+// The same logic is written to the tcl script by writeTcl().
+class StepSizeController
+{
+public:
+    StepSizeController(double dtNominal, double dtMin, double dtMax, int maxIter);
+
+    void setGrowFactor(double f) { m_growFactor = f; }
+    void setShrinkFactor(double f) { m_shrinkFactor = f; }
+    void setIterationLimits(int easyIter, int hardIter) { m_easyIter = easyIter; m_hardIter = hardIter; }
+
+    double getDt() const { return m_dt; }
+    double getDtMin() const { return m_dtMin; }
+    double getDtMax() const { return m_dtMax; }
+
+    // steps never pass a multiple of recDT, so recorders written with
+    // -dT recDT get rows at a uniform interval whatever the step size does.
+    // Steps are then at most recDT long, a larger dtMax does not apply.
+    void setOutputInterval(double recDT) { m_outputDT = recDT; }
+
+    // step size for the next step, clipped so it ends at finalTime or the next
+    // point of the output interval; a remainder under half a step is taken
+    // with the step before it
+    double nextDt(double currentTime, double finalTime) const;
+    // start from dt instead of the nominal dT (clamped to dtMin, dtMax)
+    void setDt(double dt);
+    // the step taken with nextDt() converged in numIter Newton iterations
+    void accept(double dtTaken, int numIter);
+    // the step did not converge. Returns false if dt is already at dtMin.
+    bool reject(int numIter);
+
+    int getNumAccepted() const { return m_numAccepted; }
+    int getNumRejected() const { return m_numRejected; }
+    long getNumIterations() const { return m_numIter; }
+    // analysis time covered with steps smaller than the nominal dT
+    double getReducedTime() const { return m_reducedTime; }
+
+    // steps taken and rejected, Newton iterations (the tangent is formed at
+    // each) and the time covered with steps below the nominal dT
+    std::string summary(int nominalSteps) const;
+
+    // tcl version of the controller: the analysis loop of section 5.4.
+    // $dT, $nSteps and proc progressEvent (ProgressChannel) must be set.
+    // Sets $success (0 when finished).
+    void writeTcl(std::ostream &s) const;
+
+private:
+    double m_dtNominal;
+    double m_dtMin;
+    double m_dtMax;
+    double m_dt;
+    double m_outputDT = 0.0;
+    int    m_maxIter;
+    double m_growFactor = 1.5;
+    double m_shrinkFactor = 0.7;
+    int    m_easyIter;
+    int    m_hardIter;
+
+    int  m_numAccepted = 0;
+    int  m_numRejected = 0;
+    long m_numIter = 0;
+    double m_reducedTime = 0.0;
+};
+
+#endif // STEPSIZECONTROLLER_H
@@ -19,55 +19,19 @@
 #include <sstream>
 #include <numeric>
 #include <iostream>
+#include <memory>
 #include "Vector.h"
+#include "MotionFile.h"
+#include "SimpsonTimeSeriesIntegrator.h"
 
-bool fileExists(const char* fileName)
+// samples of a motion file, shared by the series that use them;
+// null if the file can not be opened or is empty
+static std::shared_ptr<const std::vector<double> > loadSamples(const std::string &fileName)
 {
-	// open the file to see if it exists
-	std::ifstream file(fileName);
-	if (file)
-		return true;
-
-	return false;
-}
-
-int readDT(const char* fileName, int& numSteps, std::vector<double>& dt)
-{
-	int res = -1;
-	numSteps = 0;
-    std::ifstream file(fileName);
-	if (file)
-	{
-		std::string line;
-		res = 1;
-		double t_n, t_n1;
-
-		// find the first non-empty line
-		while (getline(file, line))
-		{
-			// skip comment lines
-			if ((line == "") || (line[0] == '%') || (line[0] == '#'))
-				continue;
-			std::istringstream lines(line);
-			lines >> t_n;
-			break;
-		}
-
-		// count number of lines and calculate the dt for each step
-		while (getline(file, line))
-		{
-			// skip comment lines
-			if ((line == "") || (line[0] == '%') || (line[0] == '#'))
-				continue;
-			std::istringstream lines(line);
-            lines >> t_n1;
-			dt.push_back(t_n1 - t_n);
-			t_n = t_n1;
-			++numSteps;
-		}
-	}
-    numSteps += 1;
-	return res;
+	std::shared_ptr<std::vector<double> > values = std::make_shared<std::vector<double> >();
+	if (!MotionFile::read(fileName.c_str(), *values) || values->empty())
+		return std::shared_ptr<const std::vector<double> >();
+	return values;
 }
 
 OutcropMotion::OutcropMotion() :
@@ -94,13 +58,37 @@ OutcropMotion::OutcropMotion(const char* fName):
 
 OutcropMotion::~OutcropMotion() 
 {
+	this->clearMotion();
+}
 
+void
+OutcropMotion::clearMotion()
+{
+	// a series without a ground motion is owned here, else by the ground motion
+	if (theGroundMotion != NULL)
+		delete theGroundMotion;
+	else
+	{
+		delete theAccSeries;
+		delete theVelSeries;
+		delete theDispSeries;
+	}
+	theGroundMotion = NULL;
+	theAccSeries = NULL;
+	theVelSeries = NULL;
+	theDispSeries = NULL;
+	m_dt.clear();
+	m_numSteps = 0;
+	m_dt_avg = 0.0;
+	m_uniformDt = false;
 }
 
 void
 OutcropMotion::setMotion(const char* fName)
 {
 	isThisInitialized = true;
+	// the motion may be reset (batch runs), start from scratch
+	this->clearMotion();
 
 	// assuming time, displacement, velocity and acceleration are located in different files
 	std::string motionName(fName);
@@ -109,26 +97,39 @@ OutcropMotion::setMotion(const char* fName)
 	std::string velFName = motionName + ".vel";
 	std::string dispFName = motionName + ".disp";
 
-	// check to see if the time file exists
-	if (readDT(timeFName.c_str(), m_numSteps, m_dt) > 0)
-    {
-        if (m_dt.size()>0)
-            this->m_dt_avg = std::accumulate( m_dt.begin(), m_dt.end(), 0.0)/ double(m_dt.size());
+	// every file is read once: the time vector is shared by the three
+	// series and the dt's are taken from it
+	std::shared_ptr<const std::vector<double> > time = loadSamples(timeFName);
+	if (time)
+	{
+		m_numSteps = int(time->size());
+		m_dt.reserve(time->size());
+		for (size_t i = 1; i < time->size(); i++)
+			m_dt.push_back((*time)[i] - (*time)[i-1]);
+		m_uniformDt = MotionFile::uniformStep(*time, m_dt_avg);
+		if (!m_uniformDt && m_dt.size() > 0)
+			this->m_dt_avg = std::accumulate( m_dt.begin(), m_dt.end(), 0.0)/ double(m_dt.size());
+
 		// assuming acceleration is in g's
-		if (fileExists(accFName.c_str()))
-			theAccSeries = new PathTimeSeries(1, accFName.c_str(), timeFName.c_str(), 9.81, true);
+		std::shared_ptr<const std::vector<double> > acc = loadSamples(accFName);
+		if (acc)
+			theAccSeries = new PathTimeSeries(1, acc, time, 9.81, true);
 
 		// assuming velocity is in m/s
-		if (fileExists(velFName.c_str()))
-			theVelSeries = new PathTimeSeries(2, velFName.c_str(), timeFName.c_str(), 1.0, true);
+		std::shared_ptr<const std::vector<double> > vel = loadSamples(velFName);
+		if (vel)
+			theVelSeries = new PathTimeSeries(2, vel, time, 1.0, true);
 
 		// assuming displcement is in m
-		if (fileExists(dispFName.c_str()))
-			theDispSeries = new PathTimeSeries(3, dispFName.c_str(), timeFName.c_str(), 1.0, true);
+		std::shared_ptr<const std::vector<double> > disp = loadSamples(dispFName);
+		if (disp)
+			theDispSeries = new PathTimeSeries(3, disp, time, 1.0, true);
 
 		// create a ground motion. It's useful for UniformExcitatpon or MultipleSupport 
+		// the missing series are integrated at its 0.01 s step, Simpson's rule
+		// also samples the record half way between those
 		if ((theAccSeries != NULL) || (theVelSeries != NULL) || (theDispSeries != NULL))
-			theGroundMotion = new GroundMotion(theDispSeries, theVelSeries, theAccSeries, NULL);
+			theGroundMotion = new GroundMotion(theDispSeries, theVelSeries, theAccSeries, new SimpsonTimeSeriesIntegrator());
 		else
 		{
 			// only time file exists. This is a problem
@@ -147,7 +148,7 @@ OutcropMotion::setBBPMotion(const char* fName, int colNum)
 {
 	Vector Path(100000);
 	Vector Time(100000);
-	m_numSteps = 0;
+	this->clearMotion();
 	std::ifstream file(fName);
 	if (file)
 	{
@@ -193,7 +194,7 @@ OutcropMotion::setBBPMotion(const char* fName, int colNum)
 		
 		// create a ground motion. It's useful for UniformExcitatpon or MultipleSupport 
 		if ((theAccSeries != NULL) || (theVelSeries != NULL) || (theDispSeries != NULL))
-			theGroundMotion = new GroundMotion(theDispSeries, theVelSeries, theAccSeries, NULL);
+			theGroundMotion = new GroundMotion(theDispSeries, theVelSeries, theAccSeries, new SimpsonTimeSeriesIntegrator());
 		else
 		{
 			isThisInitialized = false;
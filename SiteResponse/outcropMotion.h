@@ -27,6 +27,9 @@ public:
 	OutcropMotion();
 	OutcropMotion(const char* fName);
 	~OutcropMotion();
+	// owns the ground motion, which owns the series
+	OutcropMotion(const OutcropMotion&) = delete;
+	OutcropMotion& operator=(const OutcropMotion&) = delete;
 
 	PathTimeSeries*  getDispSeries() { return theDispSeries; };
 	PathTimeSeries*  getVelSeries() { return theVelSeries; };
@@ -36,11 +39,16 @@ public:
 	bool                isInitialized() { return isThisInitialized; };
     std::vector<double> getDTvector() { return m_dt; }
     double              getDt() {return m_dt_avg;}
+    // the time file has a constant step (getDt())
+    bool                isUniform() {return m_uniformDt;}
     int                 getNumSteps() { return m_numSteps; }
 	void                setMotion(const char* fName);
     void                setBBPMotion(const char* fName, int colNum);
 
 private:
+	// drops the series and the ground motion of the previous motion
+	void clearMotion();
+
 	PathTimeSeries* theAccSeries;
 	PathTimeSeries* theVelSeries;
 	PathTimeSeries* theDispSeries;
@@ -49,7 +57,8 @@ private:
 	bool isThisInitialized;
     int  m_numSteps=0;
 	std::vector<double> m_dt;
-    double m_dt_avg;
+    double m_dt_avg = 0.0;
+    bool m_uniformDt = false;
 };
 
 
@@ -1,7 +1,10 @@
 
 #include <fstream>
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 #include "../UI/SiteResponse.h"
+#include "../UI/SiteResponseBatch.h"
 
 #ifdef WIN32  
 #include <windows.h>  
@@ -68,8 +71,74 @@ inline int isFileOrDir(std::string path)
 #endif
 }
 
+int runBatch(int argc, char **argv)
+{
+    if (argc < 6)
+    {
+        std::cout << "Please specify the parameters like this: s3hark -batch inputFile motions outputDir log [-np N] [-opensees path] [-no-gravity-reuse] [-eql] [-dtmin dt] [-dtmax dt] \n";
+        std::cout << "inputFile : the input file (json) \n";
+        std::cout << "motions   : a manifest (one motion per line: xMotion [yMotion]) or a directory of Rock-*.vel and Rock-*.time \n";
+        std::cout << "outputDir : the directory where one sub-directory per motion and batchSummary.json will be saved \n";
+        std::cout << "log       : path of log file \n";
+        std::cout << "-np       : number of OpenSees processes run at the same time (default: number of cores) \n";
+        std::cout << "-opensees : OpenSees executable (default: OpenSeesPath in inputFile) \n";
+        std::cout << "-no-gravity-reuse : run the gravity stage in every job instead of restoring a shared checkpoint \n";
+        std::cout << "-dtmin, -dtmax : bounds of the adaptive time step (default: dtMin / dtMax in inputFile, dtMax at most the analysis dT) \n";
+        std::cout << "-eql      : screen the motions with an equivalent linear analysis instead of running OpenSees (2D only) \n";
+        return -1;
+    }
+
+    std::string configureFile = argv[2];
+    std::string motions = argv[3];
+    std::string outDir = argv[4];
+    std::string log = argv[5];
+
+    if (isFileOrDir(outDir) != 1)
+    {
+        std::cout << outDir.c_str() << " directory doesn't exist." << "\n";
+        return 1;
+    }
+
+    if (isFileOrDir(configureFile) != -1)
+    {
+        std::cout << configureFile.c_str() << " doesn't exist." << "\n";
+        return 1;
+    }
+
+    SiteResponseBatch batch(configureFile, motions, outDir, log);
+    double dtMin = -1.0;
+    double dtMax = -1.0;
+    for (int i = 6; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-np") && i + 1 < argc)
+            batch.setNumWorkers(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-opensees") && i + 1 < argc)
+            batch.setOpenSeesPath(argv[++i]);
+        else if (!strcmp(argv[i], "-no-gravity-reuse"))
+            batch.setReuseGravity(false);
+        else if (!strcmp(argv[i], "-dtmin") && i + 1 < argc)
+            dtMin = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-dtmax") && i + 1 < argc)
+            dtMax = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-eql"))
+            batch.setEquivalentLinear(true);
+        else
+            std::cout << "Unknown option " << argv[i] << "\n";
+    }
+
+    batch.setStepBounds(dtMin, dtMax);
+    int numFailed = batch.run();
+    if (numFailed != 0)
+        std::cout << "Not all analyses were successful. Read " << outDir << "/batchSummary.json" << "\n";
+
+    return numFailed == 0 ? 0 : 1;
+}
+
 int main(int argc, char **argv)
 {
+    if (argc > 1 && !strcmp(argv[1], "-batch"))
+        return runBatch(argc, argv);
+
     if (argc != 5)
     {
         std::cout << "Please specify 3 parameters like this: s3hark inputFile workDir outputDir log \n";
@@ -77,6 +146,7 @@ int main(int argc, char **argv)
         std::cout << "workDir   : the directory where you have Rock-x.time and Rock-x.vel \n";
         std::cout << "outputDir : the directory where outputs will be saved \n";
         std::cout << "log       : path of log file \n";
+        std::cout << "To run a suite of motions: s3hark -batch inputFile motions outputDir log [-np N] [-opensees path] \n";
         //std::getchar();
         return -1;
     }
@@ -15,6 +15,8 @@
 
 #include "siteLayering.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -104,3 +106,25 @@ SiteLayering::readFromFile(const char* layerFileName)
 	layerFile.close();
 	return 0;
 }
+
+int
+SiteLayering::readFromJson(const nlohmann::json &soilLayers, double minESize)
+{
+	nlohmann::json layers = soilLayers;
+	std::sort(layers.begin(), layers.end(),
+		[](const nlohmann::json &a, const nlohmann::json &b) { return a["id"] < b["id"]; });
+	for (auto l : layers)
+	{
+		std::string layerName = l["name"];
+		if (!layerName.compare("Rock"))
+			continue;
+		double thick = l["thickness"];
+		double eSize = std::max(minESize, l.value("eSize", minESize));
+		int numElement = std::max(1, static_cast<int>(std::round(thick / eSize)));
+		std::string Material = std::to_string(l.value("material", 0));
+
+		SoilLayer newLayer(layerName, thick, l["vs"], l.value("vp", 0.0), l["density"], 0.0, 1.0, 1.0, numElement, Material, "");
+		this->addNewLayer(newLayer);
+	}
+	return 0;
+}
@@ -14,6 +14,7 @@
 
 
 #include <vector>
+#include <nlohmann/json.hpp>
 #include "soillayer.h"
 
 #ifndef SITELAYERING_H
@@ -35,6 +36,9 @@ public:
 	SoilLayer getLayer(int index);
 	double getNaturalPeriod();
 	int readFromFile(const char*);
+	// the layers of SRT["soilProfile"]["soilLayers"] top down, without the
+	// Rock; numEle as the 2D mesh, elements no smaller than minESize
+	int readFromJson(const nlohmann::json &soilLayers, double minESize);
 	
 private:
 	std::vector<SoilLayer> sl_layers;
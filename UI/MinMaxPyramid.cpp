@@ -0,0 +1,169 @@
+#include "MinMaxPyramid.h"
+
+#include <algorithm>
+
+void MinMaxPyramid::clear()
+{
+    m_table.clear();
+    m_time = ResultColumn();
+    m_values = ResultColumn();
+    m_min.clear();
+    m_max.clear();
+}
+
+void MinMaxPyramid::build(const QVector<double> &time, const QVector<double> &values)
+{
+    int n = std::min(time.size(), values.size());
+    ResultTable table(2, n);
+    for (int i=0; i<n; i++)
+    {
+        double row[2] = {time[i], values[i]};
+        table.appendRow(row, 2);
+    }
+    build(table, 0, 1);
+}
+
+void MinMaxPyramid::build(const ResultTable &table, int timeColumn, int valueColumn)
+{
+    clear();
+    m_table = table;
+    m_time = m_table[timeColumn];
+    m_values = m_table[valueColumn];
+
+    const double *v = m_values.constData();
+    int n = std::min(m_time.size(), m_values.size());
+
+    // level 0 from the samples, then each level from the one below
+    int numBlocks = n / Fanout;
+    while (numBlocks > 0)
+    {
+        QVector<int> levelMin(numBlocks);
+        QVector<int> levelMax(numBlocks);
+        int level = m_min.size();
+        for (int b=0; b<numBlocks; b++)
+        {
+            int iMin, iMax;
+            if (level == 0)
+            {
+                iMin = iMax = b*Fanout;
+                for (int i=b*Fanout+1; i<(b+1)*Fanout; i++)
+                {
+                    if (v[i] < v[iMin]) iMin = i;
+                    if (v[i] > v[iMax]) iMax = i;
+                }
+            } else {
+                const QVector<int> &belowMin = m_min[level-1];
+                const QVector<int> &belowMax = m_max[level-1];
+                iMin = belowMin[b*Fanout];
+                iMax = belowMax[b*Fanout];
+                for (int c=b*Fanout+1; c<(b+1)*Fanout; c++)
+                {
+                    if (v[belowMin[c]] < v[iMin]) iMin = belowMin[c];
+                    if (v[belowMax[c]] > v[iMax]) iMax = belowMax[c];
+                }
+            }
+            levelMin[b] = iMin;
+            levelMax[b] = iMax;
+        }
+        m_min.append(levelMin);
+        m_max.append(levelMax);
+        numBlocks /= Fanout;
+    }
+}
+
+void MinMaxPyramid::range(double t0, double t1, int &first, int &last) const
+{
+    int n = std::min(m_time.size(), m_values.size());
+    const double *t = m_time.constData();
+    first = int(std::lower_bound(t, t + n, t0) - t) - 1;
+    last = int(std::upper_bound(t, t + n, t1) - t) + 1;
+    first = std::max(first, 0);
+    last = std::min(last, n);
+    if (last < first)
+        last = first;
+}
+
+void MinMaxPyramid::minMax(int first, int last, int &iMin, int &iMax) const
+{
+    const double *v = m_values.constData();
+    iMin = iMax = first;
+    int pos = first;
+    while (pos < last)
+    {
+        // the coarsest block starting at pos that fits in the range
+        int level = -1;
+        int blockSize = 1;
+        while (level+1 < m_min.size() && pos % (blockSize*Fanout) == 0 && pos + blockSize*Fanout <= last)
+        {
+            blockSize *= Fanout;
+            level++;
+        }
+
+        int lo = pos, hi = pos;
+        if (level >= 0)
+        {
+            lo = m_min[level][pos / blockSize];
+            hi = m_max[level][pos / blockSize];
+        }
+        if (v[lo] < v[iMin]) iMin = lo;
+        if (v[hi] > v[iMax]) iMax = hi;
+        pos += blockSize;
+    }
+}
+
+QVector<int> MinMaxPyramid::indices(double t0, double t1, int numBuckets) const
+{
+    QVector<const MinMaxPyramid*> group;
+    group.append(this);
+    return indices(group, t0, t1, numBuckets);
+}
+
+QVector<int> MinMaxPyramid::indices(const QVector<const MinMaxPyramid*> &group, double t0, double t1, int numBuckets)
+{
+    QVector<int> result;
+    if (group.isEmpty() || group[0]->isEmpty())
+        return result;
+
+    int first, last;
+    group[0]->range(t0, t1, first, last);
+    for (int k=1; k<group.size(); k++)
+        last = std::min(last, group[k]->size());
+    int n = last - first;
+    if (n < 1)
+        return result;
+
+    if (numBuckets < 1 || n <= 4*numBuckets)
+    {
+        result.resize(n);
+        for (int i=0; i<n; i++)
+            result[i] = first + i;
+        return result;
+    }
+
+    result.reserve(2*numBuckets*(group.size()+1));
+    QVector<int> picked;
+    for (int b=0; b<numBuckets; b++)
+    {
+        int begin = first + int(qint64(b) * n / numBuckets);
+        int end = first + int(qint64(b+1) * n / numBuckets);
+        if (end <= begin)
+            continue;
+
+        picked.clear();
+        picked.append(begin);
+        for (int k=0; k<group.size(); k++)
+        {
+            int iMin, iMax;
+            group[k]->minMax(begin, end, iMin, iMax);
+            picked.append(iMin);
+            picked.append(iMax);
+        }
+        picked.append(end-1);
+
+        std::sort(picked.begin(), picked.end());
+        for (int i=0; i<picked.size(); i++)
+            if (i == 0 || picked[i] != picked[i-1])
+                result.append(picked[i]);
+    }
+    return result;
+}
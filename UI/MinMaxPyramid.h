@@ -0,0 +1,58 @@
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include <QVector>
+#include "ResultTable.h"
+
+// Min/max mip levels of one recorded time history.
+// Level L keeps, for every block of Fanout^(L+1) consecutive samples, the
+// index of the smallest and of the largest sample in it, so the extremes of
+// any index range are found from a few blocks per level instead of a scan of
+// the samples. A plot of [t0, t1] with N pixel columns then costs O(N) at any
+// zoom, and still shows the samples the recorder wrote.
+//
+// The samples are not copied: the pyramid keeps a shared copy of the table
+// the two columns belong to.
+class MinMaxPyramid
+{
+public:
+    MinMaxPyramid() {}
+    MinMaxPyramid(const ResultTable &table, int timeColumn, int valueColumn) {build(table, timeColumn, valueColumn);}
+    MinMaxPyramid(const QVector<double> &time, const QVector<double> &values) {build(time, values);}
+
+    void build(const ResultTable &table, int timeColumn, int valueColumn);
+    // for values computed on the fly, both are copied into a table of their own
+    void build(const QVector<double> &time, const QVector<double> &values);
+    void clear();
+    int size() const {return m_values.size();}
+    bool isEmpty() const {return m_values.isEmpty();}
+    int numLevels() const {return m_min.size();}
+    ResultColumn time() const {return m_time;}
+    ResultColumn values() const {return m_values;}
+
+    // samples of [first, last) covering [t0, t1], one sample either side included
+    void range(double t0, double t1, int &first, int &last) const;
+    // index of the smallest and largest sample in [first, last)
+    void minMax(int first, int last, int &iMin, int &iMax) const;
+
+    // sorted indices to draw [t0, t1] with numBuckets buckets (one per pixel
+    // column or so): the first, last, smallest and largest sample of each, all
+    // of them if there are fewer than 4 per bucket. Drawn as a polyline this
+    // gives the same picture as the full series, peaks included, which
+    // striding does not
+    QVector<int> indices(double t0, double t1, int numBuckets) const;
+    // same for traces sharing a time axis (the first one's), the indices are
+    // the union of the indices of the members
+    static QVector<int> indices(const QVector<const MinMaxPyramid*> &group, double t0, double t1, int numBuckets);
+
+private:
+    enum {Fanout = 4};
+
+    ResultTable m_table;
+    ResultColumn m_time;
+    ResultColumn m_values;
+    QVector<QVector<int>> m_min;
+    QVector<QVector<int>> m_max;
+};
+
+#endif // MINMAXPYRAMID_H
@@ -0,0 +1,384 @@
+#include "PlotDataProvider.h"
+#include "MinMaxPyramid.h"
+#include "PostProcessor.h"
+#include "ElementModel.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QByteArray>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+PlotDataProvider::PlotDataProvider(ElementModel *emodel, QObject *parent)
+    : QObject(parent), elementModel(emodel)
+{
+
+}
+
+PlotDataProvider::~PlotDataProvider()
+{
+    qDeleteAll(m_pyramids);
+}
+
+void PlotDataProvider::setPostProcessor(PostProcessor *postProcessort)
+{
+    if (postProcessor == postProcessort)
+        return;
+    if (postProcessor)
+        disconnect(postProcessor, nullptr, this, nullptr);
+    postProcessor = postProcessort;
+    if (postProcessor)
+    {
+        connect(postProcessor, SIGNAL(envelopesReady()), this, SLOT(invalidate()));
+        connect(postProcessor, SIGNAL(motionsReady()), this, SLOT(invalidate()));
+        connect(postProcessor, SIGNAL(updateFinished()), this, SLOT(invalidate()));
+        connect(postProcessor, SIGNAL(liveUpdated()), this, SLOT(invalidate()));
+    }
+    invalidate();
+}
+
+void PlotDataProvider::invalidate()
+{
+    m_cache.clear();
+    qDeleteAll(m_pyramids);
+    m_pyramids.clear();
+    m_revision++;
+    emit dataChanged();
+}
+
+void PlotDataProvider::setPlotBuckets(int n)
+{
+    if (n < 1 || n == plotBuckets)
+        return;
+    plotBuckets = n;
+    m_cache.clear();
+    m_revision++;
+    emit dataChanged();
+}
+
+QVariantList PlotDataProvider::series(const QString &kind, int id)
+{
+    QString key = kind + ":" + QString::number(id);
+    QHash<QString, QVariantList>::const_iterator it = m_cache.constFind(key);
+    if (it != m_cache.constEnd())
+        return it.value();
+
+    QVariantList result = seriesWindow(kind, id, -std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    m_cache.insert(key, result);
+    return result;
+}
+
+QVariantList PlotDataProvider::seriesWindow(const QString &kind, int id, double t0, double t1)
+{
+    QVariantList result;
+    if (!postProcessor || !elementModel)
+        return result;
+
+    if (kind=="acc" || kind=="vel" || kind=="disp")
+        result = nodeSeries(kind, id, t0, t1);
+    else if (kind=="pwp" || kind=="rupwp")
+        result = pwpSeries(kind, id, t0, t1);
+    else if (kind=="strain" || kind=="stress" || kind=="stressstrain")
+        result = elementSeries(kind, id, t0, t1);
+    else if (kind=="sa")
+        result = saSeries(id);
+    else
+        qWarning("Unknown plot data: %s", qPrintable(kind));
+    return result;
+}
+
+QVariantList PlotDataProvider::motions(const QString &kind)
+{
+    QString key = "motions:" + kind;
+    QHash<QString, QVariantList>::const_iterator it = m_cache.constFind(key);
+    if (it != m_cache.constEnd())
+        return it.value();
+
+    QVariantList result = motionsWindow(kind, -std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    m_cache.insert(key, result);
+    return result;
+}
+
+QVariantList PlotDataProvider::motionsWindow(const QString &kind, double t0, double t1)
+{
+    QVariantList result;
+    if (!postProcessor)
+        return result;
+
+    QString label[2] = {"Rock motion", "Surface motion"};
+    QString pos[2] = {"base", "surface"};
+    for (int k=0; k<2; k++)
+    {
+        const ResultTable *v = postProcessor->getMotion(pos[k], kind);
+        if (!v || v->rowCount() < 1)
+            continue;
+        QString key = "motions:" + kind + ":" + pos[k];
+        QVector<const MinMaxPyramid*> traces;
+        QStringList names;
+        traces.append(pyramid(key + ":x1", *v, 1));
+        if (simulationD==3 && v->columnCount() > 2)
+        {
+            traces.append(pyramid(key + ":x2", *v, 2));
+            names << label[k]+"-x1" << label[k]+"-x2";
+        } else
+            names << label[k];
+        result.append(group((*v)[0], names, traces, t0, t1));
+    }
+    return result;
+}
+
+QVariantList PlotDataProvider::nodeSeries(const QString &kind, int id, double t0, double t1)
+{
+    QVariantList result;
+    const ResultTable *v;
+    if (kind=="acc")
+        v = postProcessor->getaccAll();
+    else if (kind=="vel")
+        v = postProcessor->getvelAll();
+    else
+        v = postProcessor->getdispAll();
+
+    // 4 columns per node from column 7, in the reverse order of the element model
+    int j = 7 + 4 * (elementModel->getSize() - 1 - id);
+    int numComponents = simulationD==3 ? 2 : 1;
+    if (!v || v->size() < 1 || j < 7 || j + numComponents > v->size())
+        return result;
+
+    QString name = "Node " + QString::number(id);
+    QStringList names;
+    QVector<const MinMaxPyramid*> traces;
+    for (int c=0; c<numComponents; c++)
+    {
+        // built by the post processor, or here if it has not been yet
+        const MinMaxPyramid *p = postProcessor->pyramid(kind, j+c);
+        if (!p)
+        {
+            p = pyramid(kind + ":" + QString::number(j+c), *v, j+c);
+        }
+        traces.append(p);
+    }
+    if (simulationD==3)
+        names << name+"-x1" << name+"-x2";
+    else
+        names << name;
+    result.append(group((*v)[0], names, traces, t0, t1));
+    return result;
+}
+
+QVariantList PlotDataProvider::pwpSeries(const QString &kind, int id, double t0, double t1)
+{
+    QVariantList result;
+    QString fileName = postProcessor->getPWPFileName();
+
+    int startind = simulationD==3 ? 8 : 4;
+    int thisstep = simulationD==3 ? 4 : 2;
+    int eleInd = elementModel->getSize() - 1 - id;
+    int j = startind + thisstep * eleInd;
+    if (eleInd < 0)
+        return result;
+
+    QString key = kind + ":" + QString::number(j);
+    const MinMaxPyramid *p = m_pyramids.value(key);
+    if (!p)
+    {
+        const ResultTable v = columns(fileName);
+        if (j >= v.size() || v[j].isEmpty())
+            return result;
+        if (kind=="pwp")
+        {
+            p = pyramid(key, v, j);
+        } else {
+            QVector<double> v1 = postProcessor->getInitialStress();
+            if (eleInd >= v1.size())
+                return result;
+            ResultColumn pwp = v[j];
+            QVector<double> ru(pwp.size());
+            for (int i=0; i<pwp.size(); i++)
+                ru[i] = - (pwp[i]-pwp[0]) / v1[eleInd];
+            p = pyramid(key, v[0].toVector(), ru);
+        }
+    }
+
+    QString name = kind=="pwp" ? "Node " : "Element ";
+    name += QString::number(id);
+    QVector<const MinMaxPyramid*> traces;
+    traces.append(p);
+    result.append(group(p->time(), QStringList() << name, traces, t0, t1));
+    return result;
+}
+
+QVariantList PlotDataProvider::elementSeries(const QString &kind, int id, double t0, double t1)
+{
+    QVariantList result;
+    QString stressFileName = postProcessor->getStressFileName();
+    QString strainFileName = postProcessor->getStrainFileName();
+
+    // thisstep columns per element from startind, in the reverse order of the element model
+    int startind = simulationD==3 ? 4 : 3;
+    int thisstep = simulationD==3 ? 6 : 3;
+    int numComponents = simulationD==3 ? 3 : 1;
+    int j = startind + thisstep * (elementModel->getSize() - 1 - id);
+    if (j < startind)
+        return result;
+
+    // stress and strain are recorded at the same steps, the stress time is the x axis
+    QVector<const MinMaxPyramid*> stress, strain;
+    for (int c=0; c<numComponents; c++)
+    {
+        QString key = ":" + QString::number(j+c);
+        const MinMaxPyramid *p = m_pyramids.value("stress" + key);
+        const MinMaxPyramid *q = m_pyramids.value("strain" + key);
+        if (!p || !q)
+        {
+            const ResultTable vStress = columns(stressFileName);
+            const ResultTable vStrain = columns(strainFileName);
+            if (j+c >= vStress.size() || j+c >= vStrain.size())
+                return result;
+            p = pyramid("stress" + key, vStress, j+c);
+            q = pyramid("strain" + key, vStrain, j+c);
+        }
+        stress.append(p);
+        strain.append(q);
+    }
+
+    QString name = "Element " + QString::number(id);
+    const char *component[3] = {"12", "23", "13"};
+    if (kind=="stressstrain")
+    {
+        // stress against strain, one group per component
+        for (int c=0; c<numComponents; c++)
+        {
+            QVector<const MinMaxPyramid*> traces;
+            traces.append(stress[c]);
+            traces.append(strain[c]);
+            QVector<int> ind = MinMaxPyramid::indices(traces, t0, t1, plotBuckets);
+            QVariantMap g;
+            g["x"] = packFloat64(strain[c]->values(), ind);
+            QVariantMap s;
+            s["name"] = simulationD==3 ? name + " (" + component[c] + ")" : name;
+            s["data"] = packFloat32(stress[c]->values(), ind);
+            g["series"] = QVariantList() << s;
+            result.append(g);
+        }
+        return result;
+    }
+
+    QStringList names;
+    for (int c=0; c<numComponents; c++)
+        names << (simulationD==3 ? name + " (" + component[c] + ")" : name);
+    const QVector<const MinMaxPyramid*> &traces = kind=="strain" ? strain : stress;
+    result.append(group(traces[0]->time(), names, traces, t0, t1));
+    return result;
+}
+
+QVariantList PlotDataProvider::saSeries(int id)
+{
+    QVariantList result;
+    QVector<QVector<double>> *saVec = postProcessor->getSa();
+    QVector<double> *periods = postProcessor->getPeriods();
+    // rows in the reverse order of the element model, the first row is also the rock
+    int j = elementModel->getSize() - id;
+    if (!saVec || !periods || j < 0 || j >= saVec->size())
+        return result;
+
+    QVector<int> ind(periods->size());
+    for (int i=0; i<ind.size(); i++)
+        ind[i] = i;
+    QVariantList series;
+    QVariantMap rock;
+    rock["name"] = "Rock";
+    rock["data"] = packFloat32((*saVec)[0], ind);
+    series.append(rock);
+    QVariantMap node;
+    node["name"] = "Node " + QString::number(id);
+    node["data"] = packFloat32((*saVec)[j], ind);
+    series.append(node);
+
+    QVariantMap g;
+    g["x"] = packFloat64(*periods, ind);
+    g["series"] = series;
+    result.append(g);
+    return result;
+}
+
+QVariantMap PlotDataProvider::group(const ResultColumn &x, const QStringList &names,
+                                    const QVector<const MinMaxPyramid*> &traces, double t0, double t1)
+{
+    QVector<int> ind = MinMaxPyramid::indices(traces, t0, t1, plotBuckets);
+    QVariantMap g;
+    g["x"] = packFloat64(x, ind);
+    QVariantList series;
+    for (int k=0; k<traces.size(); k++)
+    {
+        QVariantMap s;
+        s["name"] = names.value(k);
+        s["data"] = packFloat32(traces[k]->values(), ind);
+        series.append(s);
+    }
+    g["series"] = series;
+    return g;
+}
+
+const MinMaxPyramid *PlotDataProvider::pyramid(const QString &key, const QVector<double> &time, const QVector<double> &values)
+{
+    MinMaxPyramid *p = m_pyramids.value(key);
+    if (!p)
+    {
+        p = new MinMaxPyramid(time, values);
+        m_pyramids.insert(key, p);
+    }
+    return p;
+}
+
+const MinMaxPyramid *PlotDataProvider::pyramid(const QString &key, const ResultTable &table, int column)
+{
+    MinMaxPyramid *p = m_pyramids.value(key);
+    if (!p)
+    {
+        p = new MinMaxPyramid(table, 0, column);
+        m_pyramids.insert(key, p);
+    }
+    return p;
+}
+
+ResultTable PlotDataProvider::columns(const QString &fileName)
+{
+    if (postProcessor)
+        return postProcessor->columns(fileName);
+    return ResultTable::read(fileName);
+}
+
+QString PlotDataProvider::packFloat32(const ResultColumn &v, const QVector<int> &indices)
+{
+    QByteArray bytes;
+    bytes.reserve(indices.size() * int(sizeof(float)));
+    for (int k=0; k<indices.size(); k++)
+    {
+        if (indices[k] >= v.size())
+            break;
+        float value = float(v[indices[k]]);
+        quint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = qToLittleEndian(bits);
+        bytes.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+    }
+    return QString::fromLatin1(bytes.toBase64());
+}
+
+QString PlotDataProvider::packFloat64(const ResultColumn &v, const QVector<int> &indices)
+{
+    QByteArray bytes;
+    bytes.reserve(indices.size() * int(sizeof(double)));
+    for (int k=0; k<indices.size(); k++)
+    {
+        if (indices[k] >= v.size())
+            break;
+        double value = v[indices[k]];
+        quint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = qToLittleEndian(bits);
+        bytes.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+    }
+    return QString::fromLatin1(bytes.toBase64());
+}
@@ -0,0 +1,86 @@
+#ifndef PLOTDATAPROVIDER_H
+#define PLOTDATAPROVIDER_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QVariantList>
+#include <QVariantMap>
+#include "ResultTable.h"
+
+class PostProcessor;
+class MinMaxPyramid;
+class ElementModel;
+
+// Serves the time histories of the result charts to the web pages over
+// QWebChannel (registered as "plotData"), so the pages can be static
+// (resources/ui/GroundMotion/results.html) instead of being regenerated with
+// every value written out as a number literal.
+//
+// A request returns a list of groups, each drawn against its own x axis:
+//   [{"x": <base64 Float64Array>, "series": [{"name": "Node 12", "data": <base64 Float32Array>}, ...]}, ...]
+// Arrays are little endian and hold the first, last, smallest and largest
+// sample of each of plotBuckets buckets, found from the min/max pyramids of
+// the histories (MinMaxPyramid.h), so a zoomed window is as cheap as the full
+// record. Pyramids and payloads are cached until invalidate(), which is
+// called whenever the post processor has new data; recorder columns are kept
+// by the post processor (PostProcessor::columns()).
+class PlotDataProvider : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int revision READ revision NOTIFY dataChanged)
+
+public:
+    explicit PlotDataProvider(ElementModel *emodel, QObject *parent = nullptr);
+    ~PlotDataProvider();
+
+    void setPostProcessor(PostProcessor *postProcessor);
+    void setSimulationD(int d) {simulationD = d; invalidate();}
+    int revision() const {return m_revision;}
+
+    // kind is one of acc, vel, disp, pwp, rupwp, strain, stress, stressstrain, sa
+    Q_INVOKABLE QVariantList series(const QString &kind, int id);
+    // rock and surface motions, kind is acc, vel or disp
+    Q_INVOKABLE QVariantList motions(const QString &kind);
+    // the same for t0 <= time <= t1, at the full plot resolution
+    Q_INVOKABLE QVariantList seriesWindow(const QString &kind, int id, double t0, double t1);
+    Q_INVOKABLE QVariantList motionsWindow(const QString &kind, double t0, double t1);
+    // buckets per trace, the pages set it to the pixel width of their chart;
+    // the cached payloads are dropped, the pyramids kept
+    Q_INVOKABLE void setPlotBuckets(int n);
+
+    static QString packFloat32(const ResultColumn &v, const QVector<int> &indices);
+    static QString packFloat64(const ResultColumn &v, const QVector<int> &indices);
+
+signals:
+    void dataChanged();
+
+public slots:
+    void invalidate();
+
+private:
+    // cached by the post processor until the file changes
+    ResultTable columns(const QString &fileName);
+    // pyramid of column against the time in column 0, sharing the table
+    const MinMaxPyramid *pyramid(const QString &key, const ResultTable &table, int column);
+    const MinMaxPyramid *pyramid(const QString &key, const QVector<double> &time, const QVector<double> &values);
+    QVariantMap group(const ResultColumn &x, const QStringList &names,
+                      const QVector<const MinMaxPyramid*> &traces, double t0, double t1);
+    QVariantList nodeSeries(const QString &kind, int id, double t0, double t1);
+    QVariantList elementSeries(const QString &kind, int id, double t0, double t1);
+    QVariantList pwpSeries(const QString &kind, int id, double t0, double t1);
+    QVariantList saSeries(int id);
+
+    PostProcessor *postProcessor = nullptr;
+    ElementModel *elementModel;
+    int simulationD = 2;
+    int plotBuckets = 500;
+    int m_revision = 0;
+
+    QHash<QString, QVariantList> m_cache;
+    // histories not kept by the post processor
+    QHash<QString, MinMaxPyramid*> m_pyramids;
+};
+
+#endif // PLOTDATAPROVIDER_H
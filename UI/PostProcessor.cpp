@@ -4,6 +4,10 @@
 #endif
 
 #include "PostProcessor.h"
+#include "RecorderFileReader.h"
+#include <QFileInfo>
+#include <QtConcurrent>
+#include "ResponseSpectrum.h"
 
 PostProcessor::PostProcessor(QWidget *parent) : QDialog(parent)
 {
@@ -15,6 +19,12 @@ PostProcessor::PostProcessor(QTabWidget *tab,QWidget *parent) : QDialog(parent)
 
 }
 
+PostProcessor::~PostProcessor()
+{
+    cancel();
+    endLive();
+}
+
 int PostProcessor::getEleCount()
 {
 //    /QFile file("out_tcl/elementInfo.dat");
@@ -30,6 +40,20 @@ int PostProcessor::getEleCount()
     return eleCount;
 }
 
+int PostProcessor::getNodeCount()
+{
+    QFile file(nodesFileName);
+    int nodeCount = 0;
+    file.open(QIODevice::ReadOnly); //| QIODevice::Text)
+    QTextStream in(&file);
+    while( !in.atEnd())
+    {
+        in.readLine();
+        nodeCount++;
+    }
+    return nodeCount;
+}
+
 int PostProcessor::checkDim(){
     QFile file(elementFileName);
     file.open(QIODevice::ReadOnly); //| QIODevice::Text)
@@ -118,327 +142,489 @@ void PostProcessor::update()
 
     calcDepths();
     calcRuDepths();
-    calcPGA();
-    calcGamma();
-    calcSigma();
-    calcDisp();
-    calcRu();
-    calcRupwp();
-
-    loadMotions();
+    // the envelopes stay eager: the same pass writes the pga, gamma and ru
+    // profiles. Motions, spectra, pyramids and element columns are computed
+    // when a tab first asks for them.
+    ensureEnvelopes();
 
     emit updateFinished();
 }
 
-void PostProcessor::loadMotions()
+void PostProcessor::updateInBackground()
 {
-    if (dim==3)
-    {
-        calcMotion3D("base", "vel");
-        calcMotion3D("base", "disp");
-        calcMotion3D("base", "acc");
-        calcMotion3D("surface", "vel");
-        calcMotion3D("surface", "disp");
-        calcMotion3D("surface", "acc");
+    cancel();
+    checkDim();
+    calcDepths();
+    calcRuDepths();
 
-        calcAllMotion("vel");
-        calcAllMotion("disp");
-        calcAllMotion("acc");
+    // keys of the files as they are now, given to the datasets as they finish
+    m_pendingKeys.clear();
+    m_pendingKeys.insert("envelopes", envelopesKey());
+    m_pendingKeys.insert("motions", motionsKey());
+    m_pendingKeys.insert("sa", envelopesKey());
+    m_pendingKeys.insert("pyramids", envelopesKey());
+
+    int stages = 0;
+    QStringList names = {"envelopes", "motions", "sa", "pyramids"};
+    for (int i=0; i<names.size(); i++)
+        if (isCurrent(names[i], m_pendingKeys.value(names[i])))
+            stages |= 1 << i;
+        else
+            m_datasetKeys.remove(names[i]);
 
-        calcSa();
-    } else {
-        calcMotion("base", "vel");
-        calcMotion("base", "disp");
-        calcMotion("base", "acc");
-        calcMotion("surface", "vel");
-        calcMotion("surface", "disp");
-        calcMotion("surface", "acc");
+    m_stagesPublished = 0;
+    m_stagesSignalled = 0;
+    m_stagesDone.storeRelease(stages);
+    if (stages == AllStages)
+    {
+        // nothing changed since the last update
+        QMetaObject::invokeMethod(this, "onPipelineProgress", Qt::QueuedConnection);
+        return;
+    }
+    m_pipeline = QtConcurrent::run(this, &PostProcessor::runPipeline);
+}
 
-        calcAllMotion("vel");
-        calcAllMotion("disp");
-        calcAllMotion("acc");
+void PostProcessor::cancel()
+{
+    m_cancel.storeRelease(1);
+    m_pipeline.waitForFinished();
+    m_cancel.storeRelease(0);
+    publishStages();
+}
 
+// on the thread pool: nothing in here may touch m_datasetKeys or emit directly
+void PostProcessor::runPipeline()
+{
+    // stages still current are already in use, they are left alone
+    int done = m_stagesDone.loadAcquire();
+
+    // the motions are small files, read next to the recorders
+    QFuture<void> motions;
+    if (!(done & StageMotions))
+        motions = QtConcurrent::run(this, &PostProcessor::loadMotions);
+    if (!(done & StageEnvelopes))
+        calcEnvelopes();
+    motions.waitForFinished();
+    if (isCanceled())
+        return;
+    finishStages(StageEnvelopes | StageMotions);
+
+    // Sa per depth is spread over the cores by ResponseSpectrum::computeAll
+    QFuture<void> pyramids;
+    if (!(done & StagePyramids))
+        pyramids = QtConcurrent::run(this, &PostProcessor::buildPyramids);
+    if (!(done & StageSa))
         calcSa();
+    pyramids.waitForFinished();
+    if (isCanceled())
+        return;
+    finishStages(StageSa | StagePyramids);
 }
+
+void PostProcessor::finishStages(int stages)
+{
+    {
+        QMutexLocker locker(&m_stageMutex);
+        m_stagesDone.fetchAndOrRelease(stages);
+    }
+    m_stageFinished.wakeAll();
+    QMetaObject::invokeMethod(this, "onPipelineProgress", Qt::QueuedConnection);
 }
 
-void PostProcessor::calcSa()
+// the stages finished by the background update become current datasets
+void PostProcessor::publishStages()
 {
-    QVector<QVector<double>> v = *accAll;
-    if(v.size()>0)
+    int done = m_stagesDone.loadAcquire();
+    QStringList names = {"envelopes", "motions", "sa", "pyramids"};
+    for (int i=0; i<names.size(); i++)
     {
-        saVec->clear();
-        Periods->clear();
-
-        double disp_init = 0.0;
-        double vel_init = 0.0;
-        double dt = v[0][1] - v[0][0];
-        double mass = 1.0;
-        double dampingRatio = 0.05;
-
-        int numT = 100;
-        QVector<QVector<double>> saVectmp((v.size()-1)/4,QVector<double>(numT));
-        *saVec = saVectmp;
-        //QVector<double> Periods;
-
-        double pi = M_PI;
-        int ind = -1;
-        for(int i=1;i<v.size();i+=4)// for each node
+        int stage = 1 << i;
+        if ((done & stage) && !(m_stagesPublished & stage))
         {
-            ind += 1;
-            QVector<double> acc = v[i];
-            QVector<double> f = acc; // because mass=1.
-
-            QVector<double> thisSa(numT);
-            for(int n=0;n<numT;n++)
-            {
-                double T = 0.04+n*0.02;
-                if(i==1)
-                    Periods->append(T);
-                double k = (2.*pi/T)*(2.*pi/T)*mass;
-                double natural_freq = 2*pi/T;
-                double damping = 2.*mass*natural_freq*dampingRatio;
-
-                double gamma = 0.5;
-                double beta = 0.25;
-
-                double maxDisp = newmark(mass,damping, k, disp_init, vel_init, gamma, beta, dt, f);
-                thisSa[n]=(maxDisp*natural_freq*natural_freq/9.81);
-            }
-            (*saVec)[ind]=(thisSa);
+            m_datasetKeys.insert(names[i], m_pendingKeys.value(names[i]));
+            m_stagesPublished |= stage;
         }
     }
 }
 
+void PostProcessor::onPipelineProgress()
+{
+    publishStages();
+    int ready = m_stagesPublished & ~m_stagesSignalled;
+    m_stagesSignalled |= ready;
+    if (ready & StageEnvelopes)
+        emit envelopesReady();
+    if (ready & StageMotions)
+        emit motionsReady();
+    if (ready & StageSa)
+        emit spectraReady();
+    if (ready && m_stagesSignalled == AllStages)
+        emit updateFinished();
+}
 
-double PostProcessor::newmark(double mass,double damping, double stiffness, double disp_init, double vel_init, double gamma, double beta, double time_step, QVector<double> force_hist)
+// A getter needs data the background update may still be writing: wait for
+// that stage only, the later ones go on in the background. The timeout
+// covers a canceled update, which ends without finishing its stages.
+void PostProcessor::waitForStage(int stage)
 {
-    QVector<double> disps(force_hist.size()+1);
-    QVector<double> vels(force_hist.size()+1);
-    QVector<double> accels(force_hist.size()+1);
+    {
+        QMutexLocker locker(&m_stageMutex);
+        while (m_pipeline.isRunning() && !(m_stagesDone.loadAcquire() & stage))
+            m_stageFinished.wait(&m_stageMutex, 100);
+    }
+    publishStages();
+}
 
-    // set initial values
-    disps[0]=(disp_init) ;
-    vels[0]=(vel_init);
-    accels[0]=((force_hist[0] - damping * vels[0] - stiffness * disps[0]) / mass);
+QString PostProcessor::envelopesKey() const
+{
+    return sourceKey(QStringList() << accFileName << accBinFileName << velFileName << velBinFileName
+                     << dispFileName << dispBinFileName << strainFileName << strainBinFileName
+                     << stressFileName << pwpFileName << accEnvFileName << strainEnvFileName
+                     << stressEnvFileName << pwpEnvFileName << stressInitialFileName << pwpInitialFileName);
+}
 
-    // Constants
-    double k_hat = stiffness + gamma * damping / (beta * time_step) + mass / (beta * time_step*time_step);
+QString PostProcessor::motionsKey() const
+{
+    QStringList files;
+    QStringList motions = {"acc", "vel", "disp"};
+    for (int i=0; i<motions.size(); i++)
+        files << analysisDir+"/out_tcl/base."+motions[i] << analysisDir+"/out_tcl/surface."+motions[i];
+    return sourceKey(files);
+}
 
-    for (int i=0;i<force_hist.size();i++)//index, force in enumerate(force_hist[1:], 1):
-    {
-        int index = i+1;
-        double force = force_hist[i];
-        // Prediction step
-        disps[index]=(disps[index - 1]);
-        vels[index]=((1.0 - gamma / beta) * vels[index - 1] + \
-                time_step * (1.0 - gamma / (2.0 * beta)) * accels[index - 1]);
-        accels[index]=((-1.0 / (beta * time_step)) * vels[index - 1] + \
-                (1.0 - 1.0/ (2.0 * beta)) * accels[index - 1]);
-
-        // Correction step
-        double d_disp = (force - mass * accels[index] - damping * vels[index] - stiffness * disps[index]) / k_hat;
-        disps[index]=(disps[index] + d_disp);
-        vels[index]=(vels[index] + gamma * d_disp / (beta * time_step));
-        accels[index]=(accels[index] + d_disp / (beta * time_step*time_step));
-    }
-    double maxDisp=0;
-    for(int i=0;i<disps.size();i++)
-    {
-        double thisDisp = fabs(disps[i]);
-        if (thisDisp>maxDisp)
-            maxDisp = thisDisp;
-    }
-    return maxDisp;
+void PostProcessor::setSpectrumPeriods(QVector<double> periods)
+{
+    waitForStage(StageSa);
+    m_spectrumPeriods = periods;
+    m_datasetKeys.remove("sa");
+}
 
-    //return disps, vels, accels
+void PostProcessor::setSpectrumDamping(QVector<double> damping)
+{
+    waitForStage(StageSa);
+    m_spectrumDamping = damping;
+    m_datasetKeys.remove("sa");
 }
 
-void PostProcessor::calcMotion(QString pos, QString motion)
+QString PostProcessor::sourceKey(const QStringList &fileNames) const
 {
-    QString vaseVelFileName = analysisDir+"/out_tcl/"+pos+"."+motion;
-    QFile baseVelFile(vaseVelFileName);
-    QStringList *xv;
-    QStringList *yv;
-    if(pos=="base")
+    QString key = m_outputDir;
+    for (int i=0; i<fileNames.size(); i++)
     {
-        if (motion == "vel")
-        {xv = xdBaseVel; yv = ydBaseVel;}
-        else if (motion == "acc")
-        {xv = xdBaseAcc; yv = ydBaseAcc;}
-        else // (motion == "disp")
-        {xv = xdBaseDisp; yv = ydBaseDisp;}
-    }else{
-        if (motion == "vel")
-        {xv = xdSurfaceVel; yv = ydSurfaceVel;}
-        else if (motion == "acc")
-        {xv = xdSurfaceAcc; yv = ydSurfaceAcc;}
-        else // (motion == "disp")
-        {xv = xdSurfaceDisp; yv = ydSurfaceDisp;}
+        QFileInfo info(fileNames[i]);
+        key += "|" + info.fileName();
+        if (info.exists())
+            key += "@" + QString::number(info.size()) + "@" + QString::number(info.lastModified().toMSecsSinceEpoch());
     }
+    return key;
+}
 
-    if(xv && yv)
-    {xv->clear(); yv->clear();}
+void PostProcessor::ensureEnvelopes()
+{
+    // live envelopes are filled row by row, update() reads them again at the end
+    if (isLive())
+        return;
+    waitForStage(StageEnvelopes);
+    // while the background update runs it is the only writer
+    if (isUpdating())
+        return;
+    QString key = envelopesKey();
+    if (isCurrent("envelopes", key))
+        return;
+    calcEnvelopes();
+    m_datasetKeys.insert("envelopes", key);
+    m_datasetKeys.remove("pyramids");
+}
 
-    if(baseVelFile.open(QIODevice::ReadOnly)) {
-        QTextStream in(&baseVelFile);
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            else
-            {
-                thisLine.removeAll("");
-                if(thisLine.size()>1)
-                {
-                   xv->append(thisLine[0].trimmed());
-                   yv->append(thisLine[1].trimmed());
-                }else
-                    break;
+void PostProcessor::ensureMotions()
+{
+    if (isLive())
+        return;
+    waitForStage(StageMotions);
+    if (isUpdating())
+        return;
+    QString key = motionsKey();
+    if (isCurrent("motions", key))
+        return;
+    loadMotions();
+    m_datasetKeys.insert("motions", key);
+}
 
-            }
+void PostProcessor::ensureSa()
+{
+    ensureEnvelopes();
+    waitForStage(StageSa);
+    if (isUpdating())
+        return;
+    QString key = m_datasetKeys.value("envelopes");
+    if (isCurrent("sa", key))
+        return;
+    calcSa();
+    m_datasetKeys.insert("sa", key);
+}
 
-        }
-        baseVelFile.close();
-    }
+void PostProcessor::ensurePyramids()
+{
+    ensureEnvelopes();
+    waitForStage(StagePyramids);
+    if (isUpdating())
+        return;
+    QString key = m_datasetKeys.value("envelopes");
+    if (isCurrent("pyramids", key))
+        return;
+    buildPyramids();
+    m_datasetKeys.insert("pyramids", key);
 }
 
-void PostProcessor::calcMotion3D(QString pos, QString motion)
+ResultTable PostProcessor::columns(QString fileName)
 {
-    QString vaseVelFileName = analysisDir+"/out_tcl/"+pos+"."+motion;
-    QFile baseVelFile(vaseVelFileName);
-    QStringList *xv;
-    QStringList *yv;
-    QStringList *yvx2;
-    if(pos=="base")
+    QString key = sourceKey(QStringList() << fileName);
+    if (!isCurrent("columns:" + fileName, key))
     {
-        if (motion == "vel")
-        {xv = xdBaseVel; yv = ydBaseVel;yvx2 = ydBaseVelx2; }
-        else if (motion == "acc")
-        {xv = xdBaseAcc; yv = ydBaseAcc;yvx2 = ydBaseAccx2;}
-        else // (motion == "disp")
-        {xv = xdBaseDisp; yv = ydBaseDisp;yvx2 = ydBaseDispx2;}
-    }else{
-        if (motion == "vel")
-        {xv = xdSurfaceVel; yv = ydSurfaceVel;yvx2 = ydSurfaceVelx2;}
-        else if (motion == "acc")
-        {xv = xdSurfaceAcc; yv = ydSurfaceAcc;yvx2 = ydSurfaceAccx2;}
-        else // (motion == "disp")
-        {xv = xdSurfaceDisp; yv = ydSurfaceDisp;yvx2 = ydSurfaceDispx2;}
+        m_columns.insert(fileName, ResultTable::read(fileName));
+        m_datasetKeys.insert("columns:" + fileName, key);
     }
+    return m_columns.value(fileName);
+}
 
-    if(xv && yv &&yvx2)
-    {xv->clear(); yv->clear(); yvx2->clear();}
+void PostProcessor::buildPyramids()
+{
+    const ResultTable *all[3] = {&m_accAll, &m_velAll, &m_dispAll};
+    QVector<MinMaxPyramid> *pyramids[3] = {&m_accPyramids, &m_velPyramids, &m_dispPyramids};
+    for (int k=0; k<3; k++)
+    {
+        const ResultTable &v = *all[k];
+        pyramids[k]->clear();
+        pyramids[k]->resize(v.size());
+        for (int j=1; j<v.size(); j++)
+            (*pyramids[k])[j].build(v, 0, j);
+    }
+}
 
-    if(baseVelFile.open(QIODevice::ReadOnly)) {
-        QTextStream in(&baseVelFile);
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            else
-            {
-                thisLine.removeAll("");
-                if(thisLine.size()>1)
-                {
-                   xv->append(thisLine[0].trimmed());
-                   yv->append(thisLine[1].trimmed());
-                   yvx2->append(thisLine[3].trimmed());
-                }else
-                    break;
+const MinMaxPyramid *PostProcessor::pyramid(QString motion, int column)
+{
+    // not built yet by the background update: the caller makes its own
+    // rather than wait for Sa and every pyramid
+    if (isUpdating() && !(m_stagesDone.loadAcquire() & StagePyramids))
+        return nullptr;
+    ensurePyramids();
+    const QVector<MinMaxPyramid> *pyramids;
+    if (motion=="acc")
+        pyramids = &m_accPyramids;
+    else if (motion=="vel")
+        pyramids = &m_velPyramids;
+    else if (motion=="disp")
+        pyramids = &m_dispPyramids;
+    else
+        return nullptr;
+    if (column < 1 || column >= pyramids->size() || (*pyramids)[column].isEmpty())
+        return nullptr;
+    return &(*pyramids)[column];
+}
 
-            }
+bool PostProcessor::beginLive()
+{
+    cancel();
+    endLive();
+    // nodesInfo.dat and elementInfo.dat are written with the tcl file
+    if (!QFile::exists(nodesFileName) || !QFile::exists(elementFileName))
+        return false;
 
-        }
-        baseVelFile.close();
+    checkDim();
+    calcDepths();
+    calcRuDepths();
+    clearEnvelopes();
+    m_baseAcc.reset(dim==3 ? 3 : 2);
+    m_surfaceAcc.reset(dim==3 ? 3 : 2);
+
+    m_liveStart = QDateTime::currentDateTime();
+    int strainStep = dim==3 ? 6 : 3;
+    m_live[LiveAcc] = new RecorderStream(accFileName, accBinFileName, 1 + 2*getNodeCount());
+    m_live[LiveStrain] = new RecorderStream(strainFileName, strainBinFileName, 1 + strainStep*getEleCount());
+    m_live[LiveStress] = new RecorderStream(stressFileName);
+    m_live[LiveBase] = new RecorderStream(baseAccFileName);
+    m_live[LiveSurface] = new RecorderStream(surfaceAccFileName);
+    for (int id=0; id<NumLiveRecorders; id++)
+    {
+        m_live[id]->setFollow(true);
+        m_liveRows[id] = 0;
     }
+    return true;
 }
 
-void PostProcessor::calcAllMotion(QString motion)
+bool PostProcessor::openLive(int id)
 {
-    QString motionFileName;
-    QVector<QVector<double>> *v;
-    if(motion=="acc")
+    // the recorders are only created once the dynamic analysis starts
+    QDateTime modified = m_live[id]->lastModified();
+    if (!modified.isValid() || modified < m_liveStart)
+        return false;
+    return m_live[id]->open();
+}
+
+bool PostProcessor::updateLive()
+{
+    if (!isLive())
+        return false;
+
+    QVector<double> row;
+    bool updated = false;
+    for (int id=0; id<NumLiveRecorders; id++)
     {
-        motionFileName = getAccFileName();
-        v = accAll;
+        if (!m_live[id]->isOpen() && !openLive(id))
+            continue;
+        while (m_live[id]->next(row))
+        {
+            bool firstRow = m_liveRows[id]++ == 0;
+            switch (id) {
+            case LiveAcc: envelopeAcc(row, firstRow); break;
+            case LiveStrain: envelopeStrain(row, firstRow); break;
+            case LiveStress: envelopeStress(row, firstRow); break;
+            case LiveBase: appendLiveMotion("base", row); break;
+            case LiveSurface: appendLiveMotion("surface", row); break;
+            }
+            updated = true;
+        }
     }
-    else if (motion=="vel")
+
+    if (updated)
     {
-        motionFileName = getVelFileName();
-        v = velAll;
+        saveProfile(pgaFileName, m_pga);
+        saveProfile(pgaFileNamex2, m_pgax2);
+        saveProfile(gammaMaxFileName, m_gamma);
+        saveProfile(sigmaMaxFileName, m_sigma);
+        saveProfile(ruFileName, m_ru);
+        emit liveUpdated();
     }
-    else if (motion=="disp")
+    return updated;
+}
+
+void PostProcessor::endLive()
+{
+    for (int id=0; id<NumLiveRecorders; id++)
     {
-        motionFileName = getDispFileName();
-        v = dispAll;
+        delete m_live[id];
+        m_live[id] = nullptr;
     }
-    else
-        qWarning("motion must be acc, vel or disp!");
-
-    v->clear();
-
-    QFile File(motionFileName);
-
+}
 
-    if(File.open(QIODevice::ReadOnly)) {
-        QTextStream in(&File);
-        int lineCount = 0;
-        int numCols = 0;
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            thisLine.removeAll("");
-            int sizeThisLine = thisLine.size();
-            lineCount += 1;
-            if (lineCount==1)
-                numCols = sizeThisLine;
-            if (sizeThisLine != numCols && lineCount>1)
-            {
-                lineCount -= 1;
-                break;
-            }
-            else
-            {
-                //thisLine.removeAll("");
-                int thisstep = dim==3 ? 8 : 4;
-                int thisind = 0 ;
+// same columns as calcMotion / calcMotion3D
+void PostProcessor::appendLiveMotion(QString pos, const QVector<double> &row)
+{
+    if (row.size() < (dim==3 ? 4 : 2))
+        return;
+    double values[3] = {row[0], row[1], dim==3 ? row[3] : 0.0};
+    motionTable(pos, "acc")->appendRow(values, dim==3 ? 3 : 2);
+}
 
+ResultTable *PostProcessor::motionTable(QString pos, QString motion)
+{
+    bool base = pos=="base";
+    if (motion=="vel")
+        return base ? &m_baseVel : &m_surfaceVel;
+    else if (motion=="acc")
+        return base ? &m_baseAcc : &m_surfaceAcc;
+    else // (motion == "disp")
+        return base ? &m_baseDisp : &m_surfaceDisp;
+}
 
-                // add time row to v
-                if (lineCount==1)
-                {
-                    QVector<double> tmpV;
-                    v->append(tmpV);
-                }
-                (*v)[0].append((thisLine[0].trimmed().toDouble()));
-                thisind += 1;
+const ResultTable *PostProcessor::getMotion(QString pos, QString motion)
+{
+    ensureMotions();
+    return motionTable(pos, motion);
+}
 
+void PostProcessor::loadMotions()
+{
+    if (dim==3)
+    {
+        calcMotion3D("base", "vel");
+        calcMotion3D("base", "disp");
+        calcMotion3D("base", "acc");
+        calcMotion3D("surface", "vel");
+        calcMotion3D("surface", "disp");
+        calcMotion3D("surface", "acc");
+    } else {
+        calcMotion("base", "vel");
+        calcMotion("base", "disp");
+        calcMotion("base", "acc");
+        calcMotion("surface", "vel");
+        calcMotion("surface", "disp");
+        calcMotion("surface", "acc");
+    }
+}
 
-                // add motion rows to v
-                for (int i=1; (i+thisstep-1)<thisLine.size();i+=thisstep)// TODO: 3D?
-                {
-                    for (int j=i; j<i+4; j++)
-                    {
-                        if (lineCount==1)
-                        {
-                            QVector<double> tmpV;
-                            v->append(tmpV);
-                        }
-                        (*v)[thisind].append((thisLine[j].trimmed().toDouble()));
-                        thisind += 1;
-                    }
-                }
-            }
+void PostProcessor::calcSa()
+{
+    const ResultTable &v = m_accAll;
+    saVec->clear();
+    Periods->clear();
+    m_saAll.clear();
+    if(v.size()<2 || v[0].size()<2 || m_spectrumPeriods.isEmpty() || m_spectrumDamping.isEmpty())
+        return;
+
+    double dt = v[0][1] - v[0][0];
+    int numT = m_spectrumPeriods.size();
+    int numDamping = m_spectrumDamping.size();
+
+    // x1 acceleration of the first node at each depth, all depths in parallel
+    std::vector<const double*> records;
+    for(int i=1;i<v.size();i+=4)
+        records.push_back(v[i].constData());
+
+    ResponseSpectrum spectrum(m_spectrumPeriods.toStdVector(), m_spectrumDamping.toStdVector());
+    std::vector<std::vector<double>> sa;
+    spectrum.computeAll(records, v[0].size(), dt, sa);
+
+    for(int n=0;n<numT;n++)
+        Periods->append(m_spectrumPeriods[n]);
+
+    m_saAll.resize(numDamping);
+    for(int d=0;d<numDamping;d++)
+    {
+        m_saAll[d].resize(int(records.size()));
+        for(int r=0;r<int(records.size());r++)
+        {
+            QVector<double> thisSa(numT);
+            for(int n=0;n<numT;n++)
+                thisSa[n] = sa[r][d*numT+n] / g;
+            m_saAll[d][r] = thisSa;
         }
-        File.close();
     }
+    *saVec = m_saAll[0];
 }
 
+void PostProcessor::calcMotion(QString pos, QString motion)
+{
+    // time and x1
+    ResultTable *v = motionTable(pos, motion);
+    v->reset(2);
+
+    RecorderStream in(analysisDir+"/out_tcl/"+pos+"."+motion);
+    if (!in.open())
+        return;
+    QVector<double> row;
+    while (in.next(row) && row.size()>1)
+        v->appendRow(row.constData(), 2);
+    v->squeeze();
+}
 
-
+void PostProcessor::calcMotion3D(QString pos, QString motion)
+{
+    // time, x1 and x2
+    ResultTable *v = motionTable(pos, motion);
+    v->reset(3);
+
+    RecorderStream in(analysisDir+"/out_tcl/"+pos+"."+motion);
+    if (!in.open())
+        return;
+    QVector<double> row;
+    while (in.next(row) && row.size()>3)
+    {
+        double values[3] = {row[0], row[1], row[3]};
+        v->appendRow(values, 3);
+    }
+    v->squeeze();
+}
 
 void PostProcessor::calcDepths()
 {
@@ -499,537 +685,364 @@ void PostProcessor::calcRuDepths()
     m_ruDepths << m_depths.last();
 }
 
-void PostProcessor::calcPGA()
+void PostProcessor::clearEnvelopes()
 {
-    //QString accFileName = accFileName;
-    QFile accFile(accFileName);
-    QVector<double> pga;
-    QVector<double> pgax2;
-    if(accFile.open(QIODevice::ReadOnly)) {
-        QTextStream in(&accFile);
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            else
-            {
-                thisLine.removeAll("");
-                QVector<double> thispga;
-                QVector<double> thispgax2;
-                int thisstep = dim==3 ? 8 :4;
-                for (int i=1; i<thisLine.size();i+=thisstep)// TODO: 3D?
-                {
-                    double tmp = fabs(thisLine[i].trimmed().toDouble());
-                    thispga << tmp;
-                    double tmpx2 = fabs(thisLine[i+1].trimmed().toDouble());
-                    thispgax2 << tmpx2;
-                }
-                if(pga.size()!=thispga.size() && pga.size()<1)
-                {
-                    for (int j=0;j<thispga.size();j++)
-                    {
-                        pga << thispga[j];
-                        pgax2 << thispgax2[j];
-                    }
-                }
-                if (pga.size()==thispga.size())
-                {
-                    for (int j=0;j<thispga.size();j++)
-                    {
-                        if (thispga[j]>pga[j])
-                        {
-                            pga[j] = thispga[j];
-                            pgax2[j] = thispgax2[j];
-                        }
-                    }
-                }
-            }
-        }
-        accFile.close();
-    }
+    m_pga.clear(); m_pgax2.clear();
+    m_disp.clear(); m_dispx2.clear();
+    m_gamma.clear(); m_gamma13.clear(); m_gamma23.clear();
+    m_sigma.clear();
+    m_ru.clear(); m_rupwp.clear();
+    m_initialStress.clear();
+}
 
-    if (m_pga.size()>0)
-    {
-        m_pga.clear();
-        m_pgax2.clear();
-    }
-    for(int i=0;i<pga.size();i++)
+void PostProcessor::calcEnvelopes()
+{
+    clearEnvelopes();
+    // the pyramids share the histories, let them go before these are read again
+    m_accPyramids.clear();
+    m_velPyramids.clear();
+    m_dispPyramids.clear();
+
+    // every recorder file is read exactly once
+    if (isEnvelopeOutput())
     {
-        m_pga.append( pga[i] / g );
-        m_pgax2.append( pgax2[i] / g );
+        // only a coarse displacement history is recorded besides the envelopes
+        m_accAll.clear();
+        m_velAll.clear();
+        scanMotion("disp");
+        scanEnvelopes();
+    } else {
+        // the recorders are independent and each fills its own envelopes,
+        // so they are scanned concurrently
+        QList<QFuture<void>> scans;
+        scans << QtConcurrent::run(this, &PostProcessor::scanMotion, QString("acc"));
+        scans << QtConcurrent::run(this, &PostProcessor::scanMotion, QString("vel"));
+        scans << QtConcurrent::run(this, &PostProcessor::scanMotion, QString("disp"));
+        scans << QtConcurrent::run(this, &PostProcessor::scanStrain);
+        scans << QtConcurrent::run(this, &PostProcessor::scanStressAndPWP);
+        for (int i=0; i<scans.size(); i++)
+            scans[i].waitForFinished();
     }
 
+    saveProfile(pgaFileName, m_pga);
+    saveProfile(pgaFileNamex2, m_pgax2);
+    saveProfile(gammaMaxFileName, m_gamma);
+    saveProfile(sigmaMaxFileName, m_sigma);
+    saveProfile(dispMaxFileName, m_disp);
+    saveProfile(dispMaxFileNamex2, m_dispx2);
+    saveProfile(ruFileName, m_ru);
+    saveProfile(rupwpFileName, m_rupwp);
+}
 
-
-    QFile saveFile(pgaFileName);
+void PostProcessor::saveProfile(QString fileName, const QVector<double> &v)
+{
+    QFile saveFile(fileName);
     if (!saveFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
         qWarning("Couldn't open save file.");
+        return;
     }
     QTextStream out(&saveFile);
+    for (int i=0;i<v.size();i++)
+        out << QString::number(v[i]) << "\n";
+    saveFile.close();
+}
 
-    QFile saveFilex2(pgaFileNamex2);
-    if (!saveFilex2.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-        qWarning("Couldn't open save file.");
+// acceleration: time histories + pga, velocity: time histories,
+// displacement: time histories + max displacement relative to the base
+void PostProcessor::scanMotion(QString motion)
+{
+    QString motionFileName;
+    QString binFileName;
+    ResultTable *v;
+    if(motion=="acc")
+    {
+        motionFileName = accFileName; binFileName = accBinFileName;
+        v = &m_accAll;
     }
-    QTextStream outx2(&saveFilex2);
-
-
-    for (int i=0;i<m_pga.size();i++)
+    else if (motion=="vel")
     {
-        out << QString::number(m_pga[i]) << "\n";
-        outx2 << QString::number(m_pgax2[i]) << "\n";
+        motionFileName = velFileName; binFileName = velBinFileName;
+        v = &m_velAll;
+    }
+    else if (motion=="disp")
+    {
+        motionFileName = dispFileName; binFileName = dispBinFileName;
+        v = &m_dispAll;
+    }
+    else
+    {
+        qWarning("motion must be acc, vel or disp!");
+        return;
     }
-    saveFile.close();
-    saveFilex2.close();
-
-
 
+    v->clear();
 
+    RecorderStream in(motionFileName, binFileName, 1 + 2*getNodeCount());
+    if (!in.open())
+        return;
 
+    int thisstep = dim==3 ? 8 : 4;
+    QVector<double> row;
+    QVector<double> kept;
+    bool firstRow = true;
+    while (!isCanceled() && in.next(row))
+    {
+        // time column + 4 columns per depth
+        kept.resize(0);
+        kept.append(row[0]);
+        for (int i=1; (i+thisstep-1)<row.size();i+=thisstep)
+            for (int j=i; j<i+4; j++)
+                kept.append(row[j]);
+        if (firstRow)
+            v->reset(kept.size());
+        v->appendRow(kept);
+
+        if (motion=="acc")
+            envelopeAcc(row, firstRow);
+        else if (motion=="disp")
+            envelopeDisp(row, firstRow);
+        firstRow = false;
+    }
+    v->squeeze();
 }
 
-
-void PostProcessor::calcGamma()
+void PostProcessor::envelopeAcc(const QVector<double> &row, bool firstRow)
 {
-    QString FileName = strainFileName;
-    QFile File(FileName);
-    QVector<double> v;
-    QVector<double> v13;
-    QVector<double> v23;
-    if(File.open(QIODevice::ReadOnly)) {
-        QTextStream in(&File);
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            else
-            {
-                thisLine.removeAll("");
-                QVector<double> thisv;
-                QVector<double> thisv13;
-                QVector<double> thisv23;
-                int startpoint = dim==3 ? 4 : 3;
-                int step = dim==3 ? 6 : 3;
-                for (int i=startpoint; i<thisLine.size();i+=step)// TODO: 3D?
-                {
-                    double tmp = fabs(thisLine[i].trimmed().toDouble());
-                    thisv << tmp;
-                    if (dim==3)
-                    {
-                        thisv13 << fabs(thisLine[i+1].trimmed().toDouble());
-                        thisv23 << fabs(thisLine[i+2].trimmed().toDouble());
-                    }
-
-                }
-                if(v.size()!=thisv.size() && v.size()<1)
-                {
-                    for (int j=0;j<thisv.size();j++)
-                    {
-                        v << thisv[j];
-                        if (dim==3)
-                        {
-                            v13 << thisv13[j];
-                            v23 << thisv23[j];
-                        }
-                    }
-                }
-                if (v.size()==thisv.size())
-                {
-                    for (int j=0;j<thisv.size();j++)
-                    {
-                        if (thisv[j]>v[j])
-                        {
-                            v[j] = thisv[j];
-                            if (dim==3)
-                            {
-                                v13[j] = thisv13[j];
-                                v23[j] = thisv23[j];
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        File.close();
-    }
-
-    if (m_gamma.size()>0)
+    int thisstep = dim==3 ? 8 : 4;
+    int n = 0;
+    for (int i=1; i+1<row.size(); i+=thisstep, n++)
     {
-        m_gamma.clear();
-        if (dim==3)
+        double tmp = fabs(row[i]) / g;
+        if (firstRow)
         {
-            m_gamma13.clear();m_gamma23.clear();
+            m_pga << tmp;
+            m_pgax2 << fabs(row[i+1]) / g;
+        } else if (n < m_pga.size() && tmp > m_pga[n]) {
+            m_pga[n] = tmp;
+            m_pgax2[n] = fabs(row[i+1]) / g;
         }
     }
-    for(int i=0;i<v.size();i++)
+}
+
+void PostProcessor::envelopeDisp(const QVector<double> &row, bool firstRow)
+{
+    int thisstep = dim==3 ? 8 : 4;
+    int n = 0;
+    for (int i=1; i+1<row.size(); i+=thisstep, n++)
     {
-        m_gamma.append( v[i] * 100 );
-        if (dim==3)
+        double thisDisp = fabs(row[i]-row[1]);
+        double thisDispx2 = fabs(row[i+1]-row[2]);
+        if (firstRow)
         {
-            m_gamma13.append( v13[i] * 100 );m_gamma23.append( v23[i] * 100 );
+            m_disp << thisDisp;
+            m_dispx2 << thisDispx2;
+        } else if (n < m_disp.size()) {
+            if (thisDisp>m_disp[n])
+                m_disp[n] = thisDisp;
+            if (thisDispx2>m_dispx2[n])
+                m_dispx2[n] = thisDispx2;
         }
     }
+}
 
-
-
-    QFile saveFile(gammaMaxFileName);
-    if (!saveFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-        qWarning("Couldn't open save file.");
+void PostProcessor::scanStrain()
+{
+    int step = dim==3 ? 6 : 3;
+    RecorderStream in(strainFileName, strainBinFileName, 1 + step*getEleCount());
+    if (!in.open())
+        return;
+
+    QVector<double> row;
+    bool firstRow = true;
+    while (!isCanceled() && in.next(row))
+    {
+        envelopeStrain(row, firstRow);
+        firstRow = false;
     }
-    QTextStream out(&saveFile);
-
-
-    for (int i=0;i<m_gamma.size();i++)
-        out << QString::number(m_gamma[i]) << "\n";
-    saveFile.close();
-
 }
 
-
-void PostProcessor::calcSigma()// actually tao, not sigma
+void PostProcessor::envelopeStrain(const QVector<double> &row, bool firstRow)
 {
-    QString FileName = stressFileName;
-    QFile File(FileName);
-    QVector<double> v;
-    if(File.open(QIODevice::ReadOnly)) {
-        QTextStream in(&File);
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
+    int step = dim==3 ? 6 : 3;
+    int startpoint = dim==3 ? 4 : 3;
+    int n = 0;
+    for (int i=startpoint; i<row.size() && (dim!=3 || i+2<row.size()); i+=step, n++)
+    {
+        if (!firstRow && n >= m_gamma.size())
+            break;
+        double tmp = fabs(row[i]) * 100;
+        if (firstRow || tmp > m_gamma[n])
+        {
+            if (firstRow)
+                m_gamma << tmp;
             else
+                m_gamma[n] = tmp;
+            if (dim==3)
             {
-                thisLine.removeAll("");
-                QVector<double> thisv;
-                int startpoint = dim==3 ? 4 : 3;
-                int step = dim==3 ? 3 : 6;
-                for (int i=startpoint; i<thisLine.size();i+=step)// TODO: 3D?
-                {
-                    double tmp = fabs(thisLine[i].trimmed().toDouble());
-                    thisv << tmp;
-                }
-                if(v.size()!=thisv.size() && v.size()<1)
+                if (firstRow)
                 {
-                    for (int j=0;j<thisv.size();j++)
-                        v << thisv[j];
-                }
-                if (v.size()==thisv.size())
-                {
-                    for (int j=0;j<thisv.size();j++)
-                    {
-                        if (thisv[j]>v[j])
-                            v[j] = thisv[j];
-                    }
+                    m_gamma13 << 0.0;
+                    m_gamma23 << 0.0;
                 }
+                m_gamma13[n] = fabs(row[i+1]) * 100;
+                m_gamma23[n] = fabs(row[i+2]) * 100;
             }
         }
-        File.close();
-    }
-
-    if (m_sigma.size()>0)
-        m_sigma.clear();
-    for(int i=0;i<v.size();i++)
-        m_sigma.append( v[i] );
-
-
-
-    QFile saveFile(sigmaMaxFileName);
-    if (!saveFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-        qWarning("Couldn't open save file.");
     }
-    QTextStream out(&saveFile);
-
-
-    for (int i=0;i<m_sigma.size();i++)
-        out << QString::number(m_sigma[i]) << "\n";
-    saveFile.close();
-
 }
 
-
-void PostProcessor::calcDisp()
+// stress and pore pressure are recorded at the same recDT, so they are read in lockstep:
+// tau, ru from the effective stress, and ru from the excess pore pressure.
+void PostProcessor::scanStressAndPWP()
 {
-    QString FileName = dispFileName;
-    QFile File(FileName);
-    QVector<double> v;
-    QVector<double> v1;
-    double thisDisp;
-    QVector<double> vx2;
-    QVector<double> v1x2;
-    double thisDispx2;
-    if(File.open(QIODevice::ReadOnly)) {
-        QTextStream in(&File);
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            else
-            {
-                thisLine.removeAll("");
-                QVector<double> thisv;
-                QVector<double> thisvx2;
-                int startpoint = dim==3 ? 1 : 1;
-                int step = dim==3 ? 8 : 4;
-                for (int i=startpoint; i<thisLine.size();i+=step)// TODO: 3D?
-                {
-                    double tmp = (thisLine[i].trimmed().toDouble());
-                    thisv << tmp;
-                    double tmpx2 = (thisLine[i+1].trimmed().toDouble());
-                    thisvx2 << tmpx2;
-                }
-
-                if(v.size()!=thisv.size() && v.size()<1)
-                {
-                    for (int j=0;j<thisv.size();j++)
-                    {
-                        v1 << thisv[j];
-                        v << 0.0;
-                        v1x2 << thisvx2[j];
-                        vx2 << 0.0;
-                    }
-                }
-                if (v.size()==thisv.size())
-                {
-                    for (int j=0;j<thisv.size();j++)
-                    {
-                        thisDisp = fabs(thisv[j]-thisv[0]);
-                        if (thisDisp>v[j])
-                            v[j] = thisDisp;
-
-                        thisDispx2 = fabs(thisvx2[j]-thisvx2[0]);
-                        if (thisDispx2>vx2[j])
-                            vx2[j] = thisDispx2;
-                    }
-                }
-            }
+    RecorderStream stressIn(stressFileName);
+    if (!stressIn.open())
+        return;
+    RecorderStream pwpIn(pwpFileName);
+    bool hasPWP = pwpIn.open();
+
+    QVector<double> stress;
+    QVector<double> pwpRow;
+    QVector<double> pwp;
+    QVector<double> pwp1;
+    bool firstRow = true;
+    while (!isCanceled() && stressIn.next(stress))
+    {
+        bool pwpThisRow = hasPWP && pwpIn.next(pwpRow);
+        if (pwpThisRow)
+        {
+            pwp = pwpAtDepths(pwpRow);
+            if (firstRow)
+                pwp1 = pwp;
         }
-        File.close();
-    }
-
-    if (m_disp.size()>0)
-        m_disp.clear();
-    for(int i=0;i<v.size();i++)
-        m_disp.append( v[i] );
-
-    if (m_dispx2.size()>0)
-        m_dispx2.clear();
-    for(int i=0;i<vx2.size();i++)
-        m_dispx2.append( vx2[i] );
-
-
-
-    QFile saveFile(dispMaxFileName);
-    if (!saveFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-        qWarning("Couldn't open save file.");
-    }
-    QTextStream out(&saveFile);
+        hasPWP = pwpThisRow;
 
-
-    for (int i=0;i<m_disp.size();i++)
-        out << QString::number(m_disp[i]) << "\n";
-    saveFile.close();
-
-    QFile saveFilex2(dispMaxFileNamex2);
-    if (!saveFilex2.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-        qWarning("Couldn't open save file.");
+        envelopeStress(stress, firstRow);
+        if (hasPWP)
+            envelopeRuPWP(pwp, pwp1, firstRow);
+        firstRow = false;
     }
-    QTextStream outx2(&saveFilex2);
-
-
-    for (int i=0;i<m_dispx2.size();i++)
-        outx2 << QString::number(m_dispx2[i]) << "\n";
-    saveFilex2.close();
-
 }
 
-
-void PostProcessor::calcRu()
+// one node per depth from a pore pressure row (time first)
+QVector<double> PostProcessor::pwpAtDepths(const QVector<double> &row)
 {
-    QString FileName = stressFileName;
-    QFile File(FileName);
-    QVector<double> v;
-    QVector<double> v1;
-    double thisValue;
-
+    int pwpStart = 1;
+    int pwpStep = dim==3 ? 4 : 2;
+    QVector<double> pwp;
+    for (int i=pwpStart; i<row.size(); i+=pwpStep)
+        pwp << row[i];
+    return pwp;
+}
 
-    eleCount = getEleCount();
+// ru from the excess pore pressure, averaged over the element's nodes
+void PostProcessor::envelopeRuPWP(const QVector<double> &pwp, const QVector<double> &pwp1, bool firstRow)
+{
+    for (int n=0; n<m_initialStress.size(); n++)
+    {
+        if (firstRow)
+            m_rupwp << 0.0;
 
-    if(File.open(QIODevice::ReadOnly)) {
-        QTextStream in(&File);
-        double tmp = 0.0;
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            else
-            {
-                thisLine.removeAll("");
-                QVector<double> thisv;
-                int startpoint = dim==3 ? 2 : 2;
-                int step = dim==3 ? 6 : 3;
-                for (int i=startpoint; i<thisLine.size();i+=step)// TODO: 3D?
-                {
-                    tmp = (thisLine[i].trimmed().toDouble());
-                    thisv << tmp;
-                }
-                if(v.size()!=thisv.size() && v.size()<1)// first time
-                {
-                    for (int j=0;j<thisv.size();j++)
-                    {
-                        v1 << thisv[j];
-                        v << 0.0;
-                    }
-                }
-                if (v.size()==thisv.size())
-                {
-                    for (int j=0;j<thisv.size();j++)
-                    {
-                        thisValue = -(thisv[j]-v1[j]) / v1[j];
-                        if (thisValue>v[j])
-                            v[j] = thisValue;
-                    }
-                }
-            }
+        if (n+1 < pwp.size() && n+1 < pwp1.size() && n < m_rupwp.size())
+        {
+            double s0 = m_initialStress[n];
+            int topNode = n+1;
+            int bottomnode = n;
+            double thisValue = -0.5*(pwp[topNode]-pwp1[topNode]+pwp[bottomnode]-pwp1[bottomnode]) / s0;
+            if (thisValue > m_rupwp[n])
+                m_rupwp[n] = thisValue;
         }
-        File.close();
     }
-
-    if (m_ru.size()>0)
-        m_ru.clear();
-    for(int i=0;i<v.size();i++)
-        m_ru.append(v[i]);
-
-
-
-    QFile saveFile(ruFileName);
-    if (!saveFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-        qWarning("Couldn't open save file.");
-    }
-    QTextStream out(&saveFile);
-
-
-    for (int i=0;i<m_ru.size();i++)
-        out << QString::number(m_ru[i]) << "\n";
-    saveFile.close();
-
 }
 
+// envelope recorders are written when the analysis ends, so newer *.env
+// files mean the last run used the "envelope" output profile
+bool PostProcessor::isEnvelopeOutput()
+{
+    QFileInfo envInfo(accEnvFileName);
+    if (!envInfo.exists())
+        return false;
+    QFileInfo historyInfo(accFileName);
+    QFileInfo binInfo(accBinFileName);
+    return !(historyInfo.exists() && historyInfo.lastModified() > envInfo.lastModified())
+            && !(binInfo.exists() && binInfo.lastModified() > envInfo.lastModified());
+}
 
-
-void PostProcessor::calcRupwp()
+// rows of a small recorder file; envelope files (min, max, absmax rows) have
+// no time column, a zero is put in front so the rows line up with histories
+bool PostProcessor::readRows(QString fileName, QVector<QVector<double>> &rows, bool addTime)
 {
-    QVector<QVector<double>> pwp;
-    QFile pwpFile(pwpFileName);
-    if(pwpFile.open(QIODevice::ReadOnly)) {
-        QTextStream in(&pwpFile);
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            else
-            {
-                thisLine.removeAll("");
-                QVector<double> thisv;
-                int startpoint = dim==3 ? 1 : 1;
-                int step = dim==3 ? 4 : 2;
-                for (int i=startpoint; i<thisLine.size();i+=step)// TODO: 3D?
-                {
-                    double tmp = (thisLine[i].trimmed().toDouble());
-                    thisv << tmp;
-                }
-                pwp.append(thisv);
-            }
-        }
-        pwpFile.close();
+    rows.clear();
+    RecorderStream in(fileName);
+    if (!in.open())
+        return false;
+    QVector<double> row;
+    while (in.next(row))
+    {
+        if (addTime)
+            row.prepend(0.0);
+        rows.append(row);
     }
+    return !rows.isEmpty();
+}
 
-    QString FileName = stressFileName;
-    QFile File(FileName);
-    QVector<double> v;
-    QVector<double> v1;
-    double thisValue;
-
-    eleCount = getEleCount();
-
-    if(File.open(QIODevice::ReadOnly)) {
-        QTextStream in(&File);
-        int timestep = -1;
-        QVector<double> pwp1 = pwp[0];
-        while(!in.atEnd()) {
-            timestep += 1;
-            QVector<double> pwpthis = pwp[timestep];
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            else
-            {
-                thisLine.removeAll("");
-                QVector<double> thisv;
-                // for PIMY, PDMY, PDMY02 in 3D, there are 7 stresses output, not 6!
-                int startpoint = dim==3 ? 2 : 2;
-                int step = dim==3 ? 6 : 3;
-                for (int i=startpoint; i<thisLine.size();i+=step)// TODO: 3D?
-                {
-                    double tmp = (thisLine[i].trimmed().toDouble());
-                    thisv << tmp;
-                }
-                if(v.size()!=thisv.size() && v.size()<1)// first time
-                {
-                    for (int j=0;j<thisv.size();j++)
-                    {
-                        v1 << thisv[j];
-                        v << 0.0;
-                    }
-                }
-                if (v.size()==thisv.size())
-                {
-                    for (int j=0;j<thisv.size();j++)
-                    {
-                        //thisValue = -(thisv[j]-v1[j]) / v1[j];
-                        int topNode = j+1;
-                        int bottomnode = j;
-                        thisValue = -0.5*(pwpthis[topNode]-pwp1[topNode]+pwpthis[bottomnode]-pwp1[bottomnode]) / v1[j];
-
-                        //thisValue = -(pwpthis[topNode]-pwp1[topNode]) / v1[j];
-                        if (thisValue>v[j])
-                            v[j] = thisValue;
+// Same envelopes as the full pass, from the *.env files: the absmax row gives
+// pga and gamma max, ru and tau max are taken over the min and max rows
+// relative to the single-row initial state. Components of pga and gamma are
+// maxima each on their own rather than at the time of the x1 maximum.
+void PostProcessor::scanEnvelopes()
+{
+    QVector<QVector<double>> env;
+    if (readRows(accEnvFileName, env, true) && env.size() > 2)
+        envelopeAcc(env[2], true);
+    if (readRows(strainEnvFileName, env, true) && env.size() > 2)
+        envelopeStrain(env[2], true);
+
+    QVector<QVector<double>> initial;
+    if (!readRows(stressInitialFileName, initial, false) || !readRows(stressEnvFileName, env, true) || env.size() < 2)
+        return;
+    envelopeStress(initial[0], true);
+    envelopeStress(env[0], false);
+    envelopeStress(env[1], false);
+
+    if (!readRows(pwpInitialFileName, initial, false) || !readRows(pwpEnvFileName, env, true) || env.size() < 2)
+        return;
+    QVector<double> pwp1 = pwpAtDepths(initial[0]);
+    envelopeRuPWP(pwpAtDepths(env[0]), pwp1, true);
+    envelopeRuPWP(pwpAtDepths(env[1]), pwp1, false);
+}
 
+// tau max, and ru from the change of the effective vertical stress
+void PostProcessor::envelopeStress(const QVector<double> &stress, bool firstRow)
+{
+    int tauStart = dim==3 ? 4 : 3;
+    int tauStep = dim==3 ? 3 : 6;
+    int sigStart = 2;
+    int sigStep = dim==3 ? 6 : 3;
 
-                    }
-                }
-            }
-        }
-        File.close();
+    int n = 0;
+    for (int i=tauStart; i<stress.size(); i+=tauStep, n++)
+    {
+        double tmp = fabs(stress[i]);
+        if (firstRow)
+            m_sigma << tmp;
+        else if (n < m_sigma.size() && tmp > m_sigma[n])
+            m_sigma[n] = tmp;
     }
 
-    if (m_rupwp.size()>0)
-        m_rupwp.clear();
-    for(int i=0;i<v.size();i++)
-        m_rupwp.append(v[i]);
-
-    if (m_initialStress.size()>0)
-        m_initialStress.clear();
-    for(int i=0;i<v1.size();i++)
-        m_initialStress.append( v1[i] );
-
-
-
-    QFile saveFile(rupwpFileName);
-    if (!saveFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-        qWarning("Couldn't open save file.");
+    n = 0;
+    for (int i=sigStart; i<stress.size(); i+=sigStep, n++)
+    {
+        if (firstRow)
+        {
+            m_initialStress << stress[i];
+            m_ru << 0.0;
+        }
+        if (n >= m_initialStress.size())
+            break;
+        double s0 = m_initialStress[n];
+        double thisValue = -(stress[i]-s0) / s0;
+        if (thisValue > m_ru[n])
+            m_ru[n] = thisValue;
     }
-    QTextStream out(&saveFile);
-
-
-    for (int i=0;i<m_rupwp.size();i++)
-        out << QString::number(m_rupwp[i]) << "\n";
-    saveFile.close();
-
 }
@@ -10,6 +10,17 @@
 #include <math.h>
 #include <QApplication>
 #include <QStandardPaths>
+#include <QDateTime>
+#include <QHash>
+#include <QFuture>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include "ResponseSpectrum.h"
+#include "MinMaxPyramid.h"
+#include "ResultTable.h"
+
+class RecorderStream;
 
 class PostProcessor : public QDialog
 {
@@ -18,45 +29,48 @@ public:
     explicit PostProcessor(QWidget *parent = nullptr);
     PostProcessor(QTabWidget *tab,QWidget *parent = nullptr);
     PostProcessor(QString outDir) : m_outputDir(outDir){}
-    void calcPGA();
+    ~PostProcessor();
     void update();
+    // Same results as update(), computed on the thread pool so the window stays
+    // responsive: the recorders are scanned concurrently (pga, gamma, max disp,
+    // tau and ru each come from their own file) next to the base and surface
+    // motions, then Sa and the pyramids. envelopesReady(), motionsReady() and
+    // spectraReady() are emitted as the pieces are done, updateFinished() at
+    // the end. A getter asking for a piece that is not done yet waits for it.
+    void updateInBackground();
+    // stops the background update and waits for it, e.g. when a new run starts
+    void cancel();
+    bool isUpdating() const {return m_pipeline.isRunning();}
     void calcDepths();
-    void calcGamma();
-    void calcSigma();
-    void calcDisp();
-    void calcRu();
-    void calcRupwp();
     void calcRuDepths();
-
-    double newmark(double mass,double damping, double k, double disp_init, double vel_init, double gamma, double beta, double dt, QVector<double> f );
-
+    // pga, max disp, max gamma, max tau, ru and ru_pwp in one pass over the recorders
+    void calcEnvelopes();
 
     void loadMotions();
     void calcMotion(QString, QString);
     void calcMotion3D(QString, QString);
-    void calcAllMotion(QString motion);
-    void calcAllMotion3D(QString motion);
     void calcSa();
 
     void calcSurfaceMotions();
     int getEleCount();
+    int getNodeCount();
 
-    QVector<double> getPga(){return m_pga;}
-    QVector<double> getPgax1(){return m_pga;}
-    QVector<double> getPgax2(){return m_pgax2;}
+    QVector<double> getPga(){ensureEnvelopes(); return m_pga;}
+    QVector<double> getPgax1(){ensureEnvelopes(); return m_pga;}
+    QVector<double> getPgax2(){ensureEnvelopes(); return m_pgax2;}
     QVector<double> getDepths(){return m_depths;}
     QVector<double> getRuDepths(){return m_ruDepths;}
-    QVector<double> getGamma(){return m_gamma;}
-    QVector<double> getGammax12(){return m_gamma;}
-    QVector<double> getGammax13(){return m_gamma13;}
-    QVector<double> getGammax23(){return m_gamma23;}
-    QVector<double> getSigma(){return m_sigma;}
-    QVector<double> getDisp(){return m_disp;}
-    QVector<double> getDispx1(){return m_disp;}
-    QVector<double> getDispx2(){return m_dispx2;}
-    QVector<double> getRu(){return m_ru;}
-    QVector<double> getRupwp(){return m_rupwp;}
-    QVector<double> getInitialStress(){return m_initialStress;}
+    QVector<double> getGamma(){ensureEnvelopes(); return m_gamma;}
+    QVector<double> getGammax12(){ensureEnvelopes(); return m_gamma;}
+    QVector<double> getGammax13(){ensureEnvelopes(); return m_gamma13;}
+    QVector<double> getGammax23(){ensureEnvelopes(); return m_gamma23;}
+    QVector<double> getSigma(){ensureEnvelopes(); return m_sigma;}
+    QVector<double> getDisp(){ensureEnvelopes(); return m_disp;}
+    QVector<double> getDispx1(){ensureEnvelopes(); return m_disp;}
+    QVector<double> getDispx2(){ensureEnvelopes(); return m_dispx2;}
+    QVector<double> getRu(){ensureEnvelopes(); return m_ru;}
+    QVector<double> getRupwp(){ensureEnvelopes(); return m_rupwp;}
+    QVector<double> getInitialStress(){ensureEnvelopes(); return m_initialStress;}
 
     QString getElementFileName(){return elementFileName;}
     QString getNodesFileName(){return nodesFileName;}
@@ -68,44 +82,98 @@ public:
     QString getStressFileName(){return stressFileName;}
     QString getPWPFileName(){return pwpFileName;}
 
-    QStringList * getxdBaseVel(){return xdBaseVel;}
-    QStringList * getydBaseVel(){return ydBaseVel;}
-    QStringList * getydBaseVelx1(){return ydBaseVel;}
-    QStringList * getydBaseVelx2(){return ydBaseVelx2;}
-    QStringList * getxdSurfaceVel(){return xdSurfaceVel;}
-    QStringList * getydSurfaceVel(){return ydSurfaceVel;}
-    QStringList * getydSurfaceVelx2(){return ydSurfaceVelx2;}
-
-    QStringList * getxdBaseDisp(){return xdBaseDisp;}
-    QStringList * getydBaseDisp(){return ydBaseDisp;}
-    QStringList * getydBaseDispx2(){return ydBaseDispx2;}
-    QStringList * getxdSurfaceDisp(){return xdSurfaceDisp;}
-    QStringList * getydSurfaceDisp(){return ydSurfaceDisp;}
-    QStringList * getydSurfaceDispx2(){return ydSurfaceDispx2;}
-
-    QStringList * getxdBaseAcc(){return xdBaseAcc;}
-    QStringList * getydBaseAcc(){return ydBaseAcc;}
-    QStringList * getydBaseAccx2(){return ydBaseAccx2;}
-    QStringList * getxdSurfaceAcc(){return xdSurfaceAcc;}
-    QStringList * getydSurfaceAcc(){return ydSurfaceAcc;}
-    QStringList * getydSurfaceAccx2(){return ydSurfaceAccx2;}
-
-    QVector<QVector<double>> *getvelAll(){return velAll;}
-    QVector<QVector<double>> *getaccAll(){return accAll;}
-    QVector<QVector<double>> *getdispAll(){return dispAll;}
-
-    QVector<QVector<double>> *getSa(){return saVec;}
-    QVector<double> *getPeriods(){return Periods;}
+    // base or surface motion (pos), acc, vel or disp: time, x1 and, for 3D, x2 columns
+    const ResultTable *getMotion(QString pos, QString motion);
+
+    // node histories: time, then 4 columns per depth (see scanMotion)
+    const ResultTable *getvelAll(){ensureEnvelopes(); return &m_velAll;}
+    const ResultTable *getaccAll(){ensureEnvelopes(); return &m_accAll;}
+    const ResultTable *getdispAll(){ensureEnvelopes(); return &m_dispAll;}
+    // min/max pyramid of a column of getaccAll(), getvelAll() or getdispAll(),
+    // nullptr for the time column, and while the background update has not
+    // built the pyramids yet
+    const MinMaxPyramid *pyramid(QString motion, int column);
+    // columns of a whitespace separated recorder file (stress, strain, pore pressure),
+    // read again only once the file has changed. The table shares its data with the cache.
+    ResultTable columns(QString fileName);
+
+    QVector<QVector<double>> *getSa(){ensureSa(); return saVec;}
+    QVector<double> *getPeriods(){ensureSa(); return Periods;}
+    // Sa for every damping ratio: [damping][depth][period]
+    QVector<QVector<QVector<double>>> getSaAll(){ensureSa(); return m_saAll;}
+    QVector<double> getSpectrumDamping(){return m_spectrumDamping;}
+    // period grid and damping ratios of the spectra, the first damping ratio fills getSa()
+    void setSpectrumPeriods(QVector<double> periods);
+    void setSpectrumDamping(QVector<double> damping);
 
     int checkDim();
     void check3DStress();
 
+    // Live mode, while the analysis is running: the recorders are followed from
+    // the offset reached by the previous call, so each call only reads what was
+    // appended. Keeps running envelopes (pga, gamma max, tau max, ru) and the
+    // base and surface acceleration histories; rupwp, displacements and spectra
+    // are left to update() once the analysis is finished.
+    bool beginLive();
+    // true if anything new was read
+    bool updateLive();
+    void endLive();
+    bool isLive() const {return m_live[0] != nullptr;}
+
 
 
 
 signals:
     void updateFinished();
+    void liveUpdated();
+    // pieces of updateInBackground()
+    void envelopesReady();
+    void motionsReady();
+    void spectraReady();
+private slots:
+    void onPipelineProgress();
 private:
+    void scanMotion(QString motion);
+    void scanStrain();
+    void scanStressAndPWP();
+    void saveProfile(QString fileName, const QVector<double> &v);
+    // running envelopes, one recorder row at a time
+    void envelopeAcc(const QVector<double> &row, bool firstRow);
+    void envelopeDisp(const QVector<double> &row, bool firstRow);
+    void envelopeStrain(const QVector<double> &row, bool firstRow);
+    void envelopeStress(const QVector<double> &stress, bool firstRow);
+    void envelopeRuPWP(const QVector<double> &pwp, const QVector<double> &pwp1, bool firstRow);
+    QVector<double> pwpAtDepths(const QVector<double> &row);
+    void clearEnvelopes();
+    // outputProfile "envelope"
+    bool isEnvelopeOutput();
+    bool readRows(QString fileName, QVector<QVector<double>> &rows, bool addTime);
+    void scanEnvelopes();
+    bool openLive(int id);
+    void buildPyramids();
+
+    // Derived results are computed on first use. Each dataset keeps the key of
+    // the files it was computed from (output directory, names, sizes and
+    // modification times) and is only computed again once that key changes,
+    // that is once a new run has written the files.
+    QString sourceKey(const QStringList &fileNames) const;
+    bool isCurrent(const QString &dataset, const QString &key) const {return m_datasetKeys.contains(dataset) && m_datasetKeys.value(dataset) == key;}
+    void ensureEnvelopes();
+    void ensureMotions();
+    void ensureSa();
+    void ensurePyramids();
+    QString envelopesKey() const;
+    QString motionsKey() const;
+
+    enum {StageEnvelopes = 1, StageMotions = 2, StageSa = 4, StagePyramids = 8, AllStages = 15};
+    void runPipeline();
+    void finishStages(int stages);
+    void publishStages();
+    void waitForStage(int stage);
+    bool isCanceled() const {return m_cancel.loadAcquire() != 0;}
+    void appendLiveMotion(QString pos, const QVector<double> &row);
+    ResultTable *motionTable(QString pos, QString motion);
+
     QString rootDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);//qApp->applicationDirPath();
     QString analysisName = "analysis";
     QString analysisDir = QDir(rootDir).filePath(analysisName);
@@ -138,6 +206,20 @@ private:
     QString strainFileName = QDir(m_outputDir).filePath("strain.out");
     QString stressFileName = QDir(m_outputDir).filePath("stress.out");
     QString pwpFileName = QDir(m_outputDir).filePath("porePressure.out");
+    // written instead of the .out files when recorderFormat is "binary"
+    QString accBinFileName = QDir(m_outputDir).filePath("acceleration.bin");
+    QString dispBinFileName = QDir(m_outputDir).filePath("displacement.bin");
+    QString velBinFileName = QDir(m_outputDir).filePath("velocity.bin");
+    QString strainBinFileName = QDir(m_outputDir).filePath("strain.bin");
+    // written instead of the full histories when outputProfile is "envelope"
+    QString accEnvFileName = QDir(m_outputDir).filePath("acceleration.env");
+    QString strainEnvFileName = QDir(m_outputDir).filePath("strain.env");
+    QString stressEnvFileName = QDir(m_outputDir).filePath("stress.env");
+    QString pwpEnvFileName = QDir(m_outputDir).filePath("porePressure.env");
+    QString stressInitialFileName = QDir(m_outputDir).filePath("stressInitial.out");
+    QString pwpInitialFileName = QDir(m_outputDir).filePath("porePressureInitial.out");
+    QString baseAccFileName = QDir(m_outputDir).filePath("base.acc");
+    QString surfaceAccFileName = QDir(m_outputDir).filePath("surface.acc");
 
     // processed dat
     QString pgaFileName = QDir(m_outputDir).filePath("pga.dat");
@@ -149,34 +231,49 @@ private:
     QString dispMaxFileName = QDir(m_outputDir).filePath("dispMax.dat");
     QString dispMaxFileNamex2 = QDir(m_outputDir).filePath("dispMaxx2.dat");
 
-    QStringList *xdBaseVel = new QStringList();
-    QStringList *ydBaseVel = new QStringList();
-    QStringList *ydBaseVelx2 = new QStringList();
-    QStringList *xdBaseDisp = new QStringList();
-    QStringList *ydBaseDisp = new QStringList();
-    QStringList *ydBaseDispx2 = new QStringList();
-    QStringList *xdBaseAcc = new QStringList();
-    QStringList *ydBaseAcc = new QStringList();
-    QStringList *ydBaseAccx2 = new QStringList();
-    QStringList *xdSurfaceVel = new QStringList();
-    QStringList *ydSurfaceVel = new QStringList();
-    QStringList *ydSurfaceVelx2 = new QStringList();
-    QStringList *xdSurfaceDisp = new QStringList();
-    QStringList *ydSurfaceDisp = new QStringList();
-    QStringList *ydSurfaceDispx2 = new QStringList();
-    QStringList *xdSurfaceAcc = new QStringList();
-    QStringList *ydSurfaceAcc = new QStringList();
-    QStringList *ydSurfaceAccx2 = new QStringList();
-
-    QVector<QVector<double>> *velAll = new QVector<QVector<double>>;
-    QVector<QVector<double>> *accAll = new QVector<QVector<double>>;
-    QVector<QVector<double>> *dispAll = new QVector<QVector<double>>;
+    // base and surface motions, see getMotion()
+    ResultTable m_baseAcc;
+    ResultTable m_baseVel;
+    ResultTable m_baseDisp;
+    ResultTable m_surfaceAcc;
+    ResultTable m_surfaceVel;
+    ResultTable m_surfaceDisp;
+
+    ResultTable m_velAll;
+    ResultTable m_accAll;
+    ResultTable m_dispAll;
+    // built once the recorders are read, for zooming into the histories
+    QVector<MinMaxPyramid> m_accPyramids;
+    QVector<MinMaxPyramid> m_velPyramids;
+    QVector<MinMaxPyramid> m_dispPyramids;
+    QHash<QString, QString> m_datasetKeys;
+    QHash<QString, ResultTable> m_columns;
+
+    // background update: only the worker writes the results of a stage until
+    // its bit is set in m_stagesDone
+    QFuture<void> m_pipeline;
+    QAtomicInt m_cancel;
+    QAtomicInt m_stagesDone;
+    QMutex m_stageMutex;
+    QWaitCondition m_stageFinished;
+    int m_stagesPublished = 0;
+    int m_stagesSignalled = 0;
+    QHash<QString, QString> m_pendingKeys;
 
     QVector<double> *Periods = new QVector<double>;
     QVector<QVector<double>> *saVec = new QVector<QVector<double>>;
+    QVector<QVector<QVector<double>>> m_saAll;
+    QVector<double> m_spectrumPeriods = QVector<double>::fromStdVector(ResponseSpectrum::defaultPeriods());
+    QVector<double> m_spectrumDamping = {0.05};
 
     int dim = 2;
 
+    enum {LiveAcc, LiveStrain, LiveStress, LiveBase, LiveSurface, NumLiveRecorders};
+    RecorderStream *m_live[NumLiveRecorders] = {};
+    qint64 m_liveRows[NumLiveRecorders] = {};
+    // recorder files older than this are left over from a previous run
+    QDateTime m_liveStart;
+
 
 
 
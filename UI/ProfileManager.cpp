@@ -1,5 +1,6 @@
 #include "ProfileManager.h"
 #include <QChar>
+#include <QDebug>
 
 ProfileManager::ProfileManager(QWidget *parent) : QDialog(parent)
 {
@@ -13,6 +14,8 @@ ProfileManager::ProfileManager(QTabWidget *tab,PostProcessor *postProcessort,QWi
 {
 
     connect(m_tab, SIGNAL(tabBarClicked(int)), this, SLOT(onTabBarClicked(int)));
+    connect(postProcessor, SIGNAL(liveUpdated()), this, SLOT(onPostProcessorLiveUpdated()));
+    connect(postProcessor, SIGNAL(envelopesReady()), this, SLOT(onPostProcessorUpdated()));
 
     // pga view
     pgaHtmlView = new QWebEngineView(this);
@@ -98,7 +101,14 @@ ProfileManager::ProfileManager(QTabWidget *tab,PostProcessor *postProcessort,QWi
 
 void ProfileManager::updatePostProcessor(PostProcessor *postProcessort)
 {
+    if (postProcessor)
+    {
+        disconnect(postProcessor, SIGNAL(liveUpdated()), this, SLOT(onPostProcessorLiveUpdated()));
+        disconnect(postProcessor, SIGNAL(envelopesReady()), this, SLOT(onPostProcessorUpdated()));
+    }
     postProcessor = postProcessort;
+    connect(postProcessor, SIGNAL(liveUpdated()), this, SLOT(onPostProcessorLiveUpdated()));
+    connect(postProcessor, SIGNAL(envelopesReady()), this, SLOT(onPostProcessorUpdated()));
 }
 
 void ProfileManager::onTabBarClicked(int ind)
@@ -140,6 +150,18 @@ void ProfileManager::onPostProcessorUpdated()
 
 }
 
+void ProfileManager::onPostProcessorLiveUpdated()
+{
+    int dim = postProcessor->checkDim();
+    if (dim==3) updatePGAHtml3D(); else updatePGAHtml();
+    if (dim==3) updateGammaHtml3D(); else updateGammaHtml();
+    updateRuHtml();
+
+    pgaHtmlView->reload();
+    gammaHtmlView->reload();
+    ruHtmlView->reload();
+}
+
 void ProfileManager::updatePGAHtml()
 {
     // get file paths
@@ -28,6 +28,8 @@ public:
 
 public slots:
     void onPostProcessorUpdated();
+    // pga, gamma max and ru while the analysis is running
+    void onPostProcessorLiveUpdated();
     void onTabBarClicked(int);
 public:
     QString rootDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);//qApp->applicationDirPath();
@@ -0,0 +1,57 @@
+#ifndef PROGRESSQUEUE_H
+#define PROGRESSQUEUE_H
+
+#include <atomic>
+
+// Fixed size ring of progress values handed from the analysis thread (the
+// only producer) to the UI thread (the only consumer), without locks and
+// without a queued signal per step.
+//
+// push() never blocks: a value that does not fit is dropped and push()
+// returns false. The analysis reports at most one value per percent plus
+// the final 100, so Capacity holds a whole run even if nothing is drained.
+class ProgressQueue
+{
+public:
+    enum {Capacity = 256};
+
+    ProgressQueue() : m_head(0), m_tail(0) {}
+
+    // producer thread
+    bool push(double value)
+    {
+        unsigned tail = m_tail.load(std::memory_order_relaxed);
+        unsigned next = (tail + 1) % Capacity;
+        if (next == m_head.load(std::memory_order_acquire))
+            return false;
+        m_values[tail] = value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // consumer thread
+    bool pop(double &value)
+    {
+        unsigned head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+        value = m_values[head];
+        m_head.store((head + 1) % Capacity, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    ProgressQueue(const ProgressQueue &);
+    ProgressQueue &operator=(const ProgressQueue &);
+
+    double m_values[Capacity];
+    std::atomic<unsigned> m_head;
+    std::atomic<unsigned> m_tail;
+};
+
+#endif // PROGRESSQUEUE_H
@@ -0,0 +1,108 @@
+#include "ProgressReader.h"
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <cmath>
+
+ProgressReader::ProgressReader(QString fileName, QObject *parent)
+    : QObject(parent), m_fileName(fileName), m_file(fileName)
+{
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(poll()));
+}
+
+void ProgressReader::start(int interval)
+{
+    stop();
+    m_offset = 0;
+    m_partial.clear();
+    m_lastStep = QJsonObject();
+    m_progress = -1;
+    m_finished = false;
+    m_timer.start(interval);
+}
+
+void ProgressReader::stop()
+{
+    m_timer.stop();
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+void ProgressReader::poll()
+{
+    if (m_finished)
+        return;
+
+    if (!m_file.isOpen())
+    {
+        // the analysis may not have created it yet
+        if (!m_file.exists() || !m_file.open(QIODevice::ReadOnly))
+            return;
+    }
+
+    // rewritten by a new run
+    if (m_file.size() < m_offset)
+    {
+        m_offset = 0;
+        m_partial.clear();
+    }
+    if (m_file.size() == m_offset)
+        return;
+
+    m_file.seek(m_offset);
+    QByteArray chunk = m_file.readAll();
+    m_offset += chunk.size();
+    m_partial.append(chunk);
+
+    int begin = 0;
+    int end;
+    while (!m_finished && (end = m_partial.indexOf('\n', begin)) >= 0)
+    {
+        parseLine(m_partial.mid(begin, end - begin));
+        begin = end + 1;
+    }
+    m_partial.remove(0, begin);
+}
+
+void ProgressReader::parseLine(const QByteArray &line)
+{
+    if (line.trimmed().isEmpty())
+        return;
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject())
+    {
+        qWarning("Couldn't parse progress line: %s", line.constData());
+        return;
+    }
+
+    QJsonObject event = doc.object();
+    QString type = event["event"].toString();
+    if (type == "step")
+    {
+        m_lastStep = event;
+        emit stepReported(event["time"].toDouble(), event["step"].toInt(), event["subStep"].toInt(),
+                          event["iter"].toInt(), event["rate"].toDouble());
+        int p = int(std::ceil(event["progress"].toDouble()));
+        if (p > m_progress && p > 0)
+        {
+            m_progress = p;
+            emit progress(p < 100 ? p : 99);
+        }
+    }
+    else if (type == "reject")
+    {
+        emit stepRejected(event["time"].toDouble(), event["dt"].toDouble(), event["subStep"].toInt());
+    }
+    else if (type == "stage")
+    {
+        emit stageChanged(event["name"].toString());
+    }
+    else if (type == "finished")
+    {
+        // recorders are closed by now
+        m_finished = true;
+        stop();
+        emit finished(event["ok"].toInt() != 0);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef PROGRESSREADER_H
+#define PROGRESSREADER_H
+
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+
+// Follows the progress stream written by the analysis (see ProgressChannel.h).
+// The file is polled on a timer; only the bytes appended since the last poll
+// are read, and a trailing partial line is kept until its newline arrives.
+class ProgressReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProgressReader(QString fileName, QObject *parent = nullptr);
+
+    QString fileName() const {return m_fileName;}
+    bool isRunning() const {return m_timer.isActive();}
+    bool isFinished() const {return m_finished;}
+
+    // the last "step" event
+    QJsonObject lastStep() const {return m_lastStep;}
+
+signals:
+    void progress(int);
+    void stageChanged(QString);
+    void stepReported(double time, int step, int subStep, int numIter, double rate);
+    void stepRejected(double time, double dt, int subStep);
+    void finished(bool ok);
+
+public slots:
+    // start following from the beginning of the file
+    void start(int interval = 500);
+    void stop();
+    // read whatever was appended since the last call
+    void poll();
+
+private:
+    void parseLine(const QByteArray &line);
+
+    QString m_fileName;
+    QFile m_file;
+    QTimer m_timer;
+    qint64 m_offset = 0;
+    QByteArray m_partial;
+    QJsonObject m_lastStep;
+    int m_progress = -1;
+    bool m_finished = false;
+};
+
+#endif // PROGRESSREADER_H
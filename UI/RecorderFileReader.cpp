@@ -0,0 +1,280 @@
+#include "RecorderFileReader.h"
+#include "MotionFile.h"
+#include <QFileInfo>
+#include <QDateTime>
+#include <cmath>
+#include <cstring>
+
+RecorderFileReader::RecorderFileReader(QString fileName, int numCols)
+    : m_file(fileName), m_cols(numCols)
+{
+
+}
+
+RecorderFileReader::~RecorderFileReader()
+{
+    close();
+}
+
+// Records are numCols raw doubles, or one byte more with the newline some
+// OpenSees versions write after each. The binary recorders write no header,
+// so the file tells: padded records put a newline at every padded record
+// end, raw ones are a whole number of records. 0 while that can't be told
+// yet, i.e. the first raw record is still being written.
+static qint64 recordBytesOf(const uchar *data, qint64 fileSize, qint64 rawBytes)
+{
+    qint64 paddedBytes = rawBytes + 1;
+    bool padded = fileSize >= paddedBytes;
+    for (qint64 i = paddedBytes - 1; padded && i < fileSize; i += paddedBytes)
+        padded = data[i] == '\n';
+    if (padded)
+        return paddedBytes;
+    if (fileSize % rawBytes == 0)
+        return rawBytes;
+    return 0;
+}
+
+bool RecorderFileReader::open()
+{
+    close();
+    if (m_cols < 1 || !m_file.open(QIODevice::ReadOnly))
+        return false;
+    // tried again once a complete record is there
+    if (!map() || m_rows < 1)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool RecorderFileReader::refresh()
+{
+    if (!isOpen())
+        return open();
+    if (m_file.size() > m_mappedSize)
+        map();
+    return m_rows > 0;
+}
+
+bool RecorderFileReader::map()
+{
+    qint64 fileSize = m_file.size();
+    qint64 rawBytes = qint64(m_cols) * qint64(sizeof(double));
+    if (fileSize < rawBytes)
+        return false;
+
+    uchar *data = m_file.map(0, fileSize);
+    if (data == nullptr)
+    {
+        qWarning("Couldn't map recorder file %s.", qPrintable(m_file.fileName()));
+        return false;
+    }
+    if (m_data != nullptr)
+        m_file.unmap(m_data);
+    m_data = data;
+    m_mappedSize = fileSize;
+
+    // the layout doesn't change while the file grows, a partial record at
+    // its end is left out until it is complete. A single raw-sized record
+    // may still be a padded one without its newline, so that is looked at
+    // again with the next.
+    if (m_rows < 2)
+        m_recordBytes = recordBytesOf(m_data, fileSize, rawBytes);
+    m_rows = m_recordBytes > 0 ? fileSize / m_recordBytes : 0;
+    return true;
+}
+
+void RecorderFileReader::close()
+{
+    if (m_data != nullptr)
+        m_file.unmap(m_data);
+    m_data = nullptr;
+    m_mappedSize = 0;
+    m_recordBytes = 0;
+    m_rows = 0;
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+RecorderColumn RecorderFileReader::column(int col) const
+{
+    if (m_data == nullptr || col < 0 || col >= m_cols)
+        return RecorderColumn();
+    return RecorderColumn(m_data + qint64(col) * qint64(sizeof(double)), m_recordBytes, m_rows);
+}
+
+void RecorderFileReader::readRow(qint64 row, double *dest) const
+{
+    std::memcpy(dest, m_data + row * m_recordBytes, size_t(m_cols) * sizeof(double));
+}
+
+bool RecorderFileReader::preferBinary(QString binFileName, QString textFileName)
+{
+    QFileInfo binInfo(binFileName);
+    if (!binInfo.exists())
+        return false;
+    QFileInfo textInfo(textFileName);
+    if (!textInfo.exists())
+        return true;
+    return binInfo.lastModified() >= textInfo.lastModified();
+}
+
+
+static inline bool isRecorderSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// parse one number starting at p, returns the position after it. Numbers go
+// through the motion file parser (exact, locale independent); what it does
+// not take is nan, inf, -nan(ind) ... as OpenSees writes them
+static const char *parseRecorderValue(const char *p, const char *end, double &value)
+{
+    if (MotionFile::parseNumber(p, end, value))
+        return p;
+
+    const char *word = p;
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+'))
+        ++word;
+    while (p < end && !isRecorderSpace(*p))
+        ++p;
+    bool isInf = (p - word) >= 3 && (word[0] == 'i' || word[0] == 'I');
+    value = isInf ? HUGE_VAL : NAN;
+    if (negative)
+        value = -value;
+    return p;
+}
+
+int parseRecorderLine(const char *begin, const char *end, QVector<double> &row)
+{
+    row.resize(0);
+    const char *p = begin;
+    while (p < end)
+    {
+        while (p < end && isRecorderSpace(*p))
+            ++p;
+        if (p >= end)
+            break;
+        double value;
+        p = parseRecorderValue(p, end, value);
+        row.append(value);
+        // skip garbage so a bad token cannot stall the loop
+        while (p < end && !isRecorderSpace(*p))
+            ++p;
+    }
+    return row.size();
+}
+
+
+RecorderStream::RecorderStream(QString textFileName, QString binFileName, int numColsBinary)
+    : m_file(textFileName), m_binFileName(binFileName), m_reader(binFileName, numColsBinary)
+{
+
+}
+
+bool RecorderStream::open()
+{
+    close();
+    m_binary = !m_binFileName.isEmpty()
+            && RecorderFileReader::preferBinary(m_binFileName, m_file.fileName())
+            && m_reader.open();
+    if (m_binary)
+        return true;
+    return m_file.open(QIODevice::ReadOnly);
+}
+
+void RecorderStream::close()
+{
+    m_reader.close();
+    if (m_file.isOpen())
+        m_file.close();
+    m_binary = false;
+    m_row = 0;
+    m_width = -1;
+    m_buffer.clear();
+    m_bufferPos = 0;
+    m_eof = false;
+}
+
+QDateTime RecorderStream::lastModified() const
+{
+    QFileInfo textInfo(m_file.fileName());
+    QFileInfo binInfo(m_binFileName);
+    bool hasBin = !m_binFileName.isEmpty() && binInfo.exists();
+    if (!textInfo.exists())
+        return hasBin ? binInfo.lastModified() : QDateTime();
+    if (hasBin && binInfo.lastModified() > textInfo.lastModified())
+        return binInfo.lastModified();
+    return textInfo.lastModified();
+}
+
+bool RecorderStream::fillBuffer()
+{
+    static const int chunkSize = 1 << 20;
+    if (m_eof)
+        return false;
+    // drop what has been consumed, keep the partial line
+    if (m_bufferPos > 0)
+    {
+        m_buffer.remove(0, m_bufferPos);
+        m_bufferPos = 0;
+    }
+    int oldSize = m_buffer.size();
+    m_buffer.resize(oldSize + chunkSize);
+    qint64 numRead = m_file.read(m_buffer.data() + oldSize, chunkSize);
+    if (numRead <= 0)
+    {
+        m_buffer.resize(oldSize);
+        m_eof = true;
+        return false;
+    }
+    m_buffer.resize(oldSize + int(numRead));
+    return true;
+}
+
+bool RecorderStream::next(QVector<double> &row)
+{
+    if (m_binary)
+    {
+        // map the records written since the last call, the file stays open
+        if (m_row >= m_reader.rows() && (!m_follow || !m_reader.refresh() || m_row >= m_reader.rows()))
+            return false;
+        row.resize(m_reader.cols());
+        m_reader.readRow(m_row++, row.data());
+        return true;
+    }
+
+    if (!m_file.isOpen())
+        return false;
+
+    while (true)
+    {
+        const char *begin = m_buffer.constData() + m_bufferPos;
+        const char *end = m_buffer.constData() + m_buffer.size();
+        const char *eol = static_cast<const char *>(std::memchr(begin, '\n', size_t(end - begin)));
+        if (eol == nullptr)
+        {
+            if (fillBuffer())
+                continue;
+            if (m_follow)
+            {
+                // the line is still being written, try again later
+                m_eof = false;
+                return false;
+            }
+            // last line without a newline
+            if (begin == end)
+                return false;
+            eol = end;
+        }
+        m_bufferPos = int(eol - m_buffer.constData()) + (eol < end ? 1 : 0);
+        int width = parseRecorderLine(begin, eol, row);
+        if (width == 0)
+            continue;
+        if (m_width < 0)
+            m_width = width;
+        return width == m_width && width > 1;
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef RECORDERFILEREADER_H
+#define RECORDERFILEREADER_H
+
+#include <QFile>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <cstring>
+
+// Read-only view of one column of a binary recorder file.
+// Values are read in place from the mapped file, nothing is copied.
+class RecorderColumn
+{
+public:
+    RecorderColumn() : m_base(nullptr), m_stride(0), m_size(0) {}
+    RecorderColumn(const uchar *base, qint64 stride, qint64 size)
+        : m_base(base), m_stride(stride), m_size(size) {}
+
+    qint64 size() const {return m_size;}
+    bool isEmpty() const {return m_size < 1;}
+    // records may be padded with a newline, so do not assume alignment
+    double operator[](qint64 row) const
+    {
+        double value;
+        std::memcpy(&value, m_base + row * m_stride, sizeof(double));
+        return value;
+    }
+
+private:
+    const uchar *m_base;
+    qint64 m_stride;
+    qint64 m_size;
+};
+
+
+// Memory-mapped reader for recorders written with "-binary".
+// OpenSees writes each record as numCols raw doubles (time first when
+// -time is given), optionally followed by a newline; which of the two is
+// told from the newlines at the record ends and the file size.
+class RecorderFileReader
+{
+public:
+    RecorderFileReader(QString fileName, int numCols);
+    ~RecorderFileReader();
+
+    bool open();
+    // a growing file: map it again if it got longer. Columns taken before
+    // are invalid after that
+    bool refresh();
+    void close();
+    bool isOpen() const {return m_data != nullptr;}
+
+    qint64 rows() const {return m_rows;}
+    int cols() const {return m_cols;}
+    double value(qint64 row, int col) const {return column(col)[row];}
+    RecorderColumn column(int col) const;
+    // copy one record into dest (numCols doubles)
+    void readRow(qint64 row, double *dest) const;
+
+    // true if a binary recorder file exists and is newer than its text counterpart
+    static bool preferBinary(QString binFileName, QString textFileName);
+
+private:
+    bool map();
+
+    QFile m_file;
+    int m_cols;
+    qint64 m_rows = 0;
+    qint64 m_recordBytes = 0;
+    qint64 m_mappedSize = 0;
+    uchar *m_data = nullptr;
+};
+
+
+// Parse the whitespace separated numbers in [begin, end) into row.
+// Locale independent (QCoreApplication sets LC_NUMERIC, so strtod is not safe)
+// and much faster than QString::split + toDouble.
+int parseRecorderLine(const char *begin, const char *end, QVector<double> &row);
+
+
+// Streams the records of a recorder file one row at a time, from the binary
+// file when it is the newer one, otherwise from the text file.
+// Only one chunk of the file is held in memory.
+//
+// In follow mode the file is expected to grow: next() returns false at the
+// current end of the data, keeps a partial last line (or record) and picks
+// up from the same offset on the next call.
+class RecorderStream
+{
+public:
+    RecorderStream(QString textFileName, QString binFileName = QString(), int numColsBinary = 0);
+
+    bool open();
+    void close();
+    bool isOpen() const {return m_binary ? m_reader.isOpen() : m_file.isOpen();}
+    bool isBinary() const {return m_binary;}
+    void setFollow(bool follow) {m_follow = follow;}
+    // the newer of the text and binary file, invalid if neither exists
+    QDateTime lastModified() const;
+
+    // next record; false at the end of the data or on a record of different width
+    bool next(QVector<double> &row);
+
+private:
+    bool fillBuffer();
+
+    QFile m_file;
+    QString m_binFileName;
+    bool m_binary = false;
+    RecorderFileReader m_reader;
+    qint64 m_row = 0;
+    int m_width = -1;
+    QByteArray m_buffer;
+    int m_bufferPos = 0;
+    bool m_eof = false;
+    bool m_follow = false;
+};
+
+#endif // RECORDERFILEREADER_H
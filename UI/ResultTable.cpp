@@ -0,0 +1,95 @@
+#include "ResultTable.h"
+#include "RecorderFileReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+QVector<double> ResultColumn::toVector() const
+{
+    QVector<double> v(m_size);
+    if (m_size > 0)
+        std::memcpy(v.data(), m_data, size_t(m_size) * sizeof(double));
+    return v;
+}
+
+void ResultTable::reset(int numColumns, int rowsHint)
+{
+    m_data = QVector<double>();
+    m_columns = std::max(numColumns, 0);
+    m_rows = 0;
+    m_stride = 0;
+    if (m_columns > 0 && rowsHint > 0)
+        grow(rowsHint);
+}
+
+void ResultTable::grow(int minRows)
+{
+    int stride = std::max(minRows, std::max(256, m_stride + m_stride / 2));
+    QVector<double> data(stride * m_columns);
+    const double *from = m_data.constData();
+    double *to = data.data();
+    for (int j=0; j<m_columns && m_rows>0; j++)
+        std::memcpy(to + size_t(j) * stride, from + size_t(j) * m_stride, size_t(m_rows) * sizeof(double));
+    m_data.swap(data);
+    m_stride = stride;
+}
+
+void ResultTable::appendRow(const double *values, int count)
+{
+    if (m_columns < 1)
+        return;
+    if (m_rows == m_stride)
+        grow(m_rows + 1);
+
+    double *d = m_data.data();
+    int n = std::min(count, m_columns);
+    for (int j=0; j<n; j++)
+        d[size_t(j) * m_stride + m_rows] = values[j];
+    for (int j=n; j<m_columns; j++)
+        d[size_t(j) * m_stride + m_rows] = 0.0;
+    m_rows++;
+}
+
+void ResultTable::squeeze()
+{
+    if (m_stride == m_rows)
+        return;
+    if (m_rows == 0)
+    {
+        reset(m_columns);
+        return;
+    }
+
+    // columns only move towards the front
+    double *d = m_data.data();
+    for (int j=1; j<m_columns; j++)
+        std::memmove(d + size_t(j) * m_rows, d + size_t(j) * m_stride, size_t(m_rows) * sizeof(double));
+    m_data.resize(m_rows * m_columns);
+    m_data.squeeze();
+    m_stride = m_rows;
+}
+
+ResultColumn ResultTable::column(int j) const
+{
+    if (j < 0 || j >= m_columns || m_rows < 1)
+        return ResultColumn();
+    return ResultColumn(m_data.constData() + size_t(j) * m_stride, m_rows);
+}
+
+ResultTable ResultTable::read(QString fileName, QString binFileName, int numColsBinary)
+{
+    ResultTable table;
+    RecorderStream in(fileName, binFileName, numColsBinary);
+    if (!in.open())
+        return table;
+
+    QVector<double> row;
+    while (in.next(row))
+    {
+        if (table.isEmpty())
+            table.reset(row.size());
+        table.appendRow(row);
+    }
+    table.squeeze();
+    return table;
+}
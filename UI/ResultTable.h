@@ -0,0 +1,81 @@
+#ifndef RESULTTABLE_H
+#define RESULTTABLE_H
+
+#include <QString>
+#include <QVector>
+
+// Read-only view of one column of a ResultTable (or of a QVector<double>).
+// Nothing is copied: the view is valid as long as the data it points to is
+// alive and not modified.
+class ResultColumn
+{
+public:
+    ResultColumn() : m_data(nullptr), m_size(0) {}
+    ResultColumn(const double *data, int size) : m_data(data), m_size(size) {}
+    ResultColumn(const QVector<double> &v) : m_data(v.constData()), m_size(v.size()) {}
+
+    int size() const {return m_size;}
+    bool isEmpty() const {return m_size < 1;}
+    const double *constData() const {return m_data;}
+    const double *begin() const {return m_data;}
+    const double *end() const {return m_data + m_size;}
+    double operator[](int i) const {return m_data[i];}
+    double at(int i) const {return m_data[i];}
+    double first() const {return m_data[0];}
+    double last() const {return m_data[m_size-1];}
+    QVector<double> toVector() const;
+
+private:
+    const double *m_data;
+    int m_size;
+};
+
+
+// Numeric results (time histories, recorder columns) kept column-major in a
+// single contiguous buffer: column j is rowCount() doubles starting at
+// j * stride. Rows are appended as they are read, the stride grows
+// geometrically and squeeze() drops the slack once the table is complete.
+//
+// Copies share the buffer (QVector implicit sharing), so a table can be
+// handed out by value and kept alive by whoever still uses its columns;
+// columns are handed out as ResultColumn views. Indexing mirrors the
+// QVector<QVector<double>> it replaces: v.size() columns, v[j][i].
+class ResultTable
+{
+public:
+    ResultTable() {}
+    explicit ResultTable(int numColumns, int rowsHint = 0) {reset(numColumns, rowsHint);}
+
+    // empty table with numColumns columns
+    void reset(int numColumns, int rowsHint = 0);
+    void clear() {reset(0);}
+
+    int columnCount() const {return m_columns;}
+    int rowCount() const {return m_rows;}
+    int size() const {return m_columns;}
+    bool isEmpty() const {return m_columns < 1;}
+
+    // values past count are set to 0
+    void appendRow(const double *values, int count);
+    void appendRow(const QVector<double> &row) {appendRow(row.constData(), row.size());}
+    // release the capacity reserved for rows not appended
+    void squeeze();
+
+    // empty view if j is out of range
+    ResultColumn column(int j) const;
+    ResultColumn operator[](int j) const {return column(j);}
+
+    // whitespace separated (or binary, see RecorderStream) recorder columns,
+    // up to the first incomplete row
+    static ResultTable read(QString fileName, QString binFileName = QString(), int numColsBinary = 0);
+
+private:
+    void grow(int minRows);
+
+    QVector<double> m_data;
+    int m_columns = 0;
+    int m_rows = 0;
+    int m_stride = 0;
+};
+
+#endif // RESULTTABLE_H
@@ -2,6 +2,7 @@
 #include "RockOutcrop.h"
 #include "ui_RockOutcrop.h"
 #include "InsertWindow.h"
+#include "ProgressChannel.h"
 #include <QQmlContext>
 
 #include <QTime>
@@ -193,6 +194,9 @@ RockOutcrop::RockOutcrop(QWidget *parent) :
     postProcessor = new PostProcessor(outputDir);
     //postProcessor->update();
 
+    // PGA, gamma max, ru ... profiles, redrawn while OpenSees runs
+    profiler = new ProfileManager(resultsTab, postProcessor, this);
+
 
     // add the profile tab into the ui's layout
     ui->meshLayout->addWidget(resultsTab);
@@ -347,6 +351,17 @@ RockOutcrop::RockOutcrop(QWidget *parent) :
     //connect(openseesProcess, SIGNAL(readyReadStandardOutput()),this,SLOT(onOpenSeesFinished()));
     connect(openseesProcess, SIGNAL(readyReadStandardError()),this,SLOT(onOpenSeesFinished()));
 
+    // progress comes from the analysis' own status stream, not from stderr
+    progressReader = new ProgressReader(QDir(outputDir).filePath(PROGRESS_FILE_NAME), this);
+    connect(progressReader, SIGNAL(progress(int)), this, SIGNAL(signalProgress(int)));
+    connect(progressReader, SIGNAL(finished(bool)), this, SLOT(onAnalysisFinished(bool)));
+    // the last lines may arrive after stderr went quiet
+    connect(openseesProcess, SIGNAL(finished(int,QProcess::ExitStatus)), progressReader, SLOT(poll()));
+
+    liveTimer = new QTimer(this);
+    liveTimer->setInterval(liveInterval);
+    connect(liveTimer, SIGNAL(timeout()), this, SLOT(onLiveUpdate()));
+
     ui->rightLayout->setContentsMargins(0,0,0,0);
     ui->rightLayout->setSpacing(0);
 
@@ -1057,14 +1072,17 @@ bool RockOutcrop::outputToJSON(QJsonObject &root)
 
 void RockOutcrop::on_killBtn_clicked()
 {
+    progressReader->stop();
+    liveTimer->stop();
+    postProcessor->endLive();
     openseesProcess->kill();
     if (shark)
     {
-        shark->setStopSignal();
-        shark->requestInterruption();
-        shark->quit();
+        // returns at the analysis' next step; deleteLater as this may be
+        // called from one of shark's signals
+        shark->cancel();
         shark->wait();
-        delete shark;
+        shark->deleteLater();
         shark = nullptr;
     }
     emit signalProgress(0);
@@ -1369,8 +1387,29 @@ void RockOutcrop::on_runBtn_clicked()
             }
             m_runningStochastic = srt->runningStochastic(); // check if running random field
 
+            std::string eqlStatus = srt->equivalentLinearStatus();
+            if (eqlStatus == "failed" || eqlStatus == "unsupported")
+                QMessageBox::warning(this,tr("Equivalent linear"), "The equivalent linear analysis could not be run, the effective stress model is analyzed instead. See eqlSummary.json in the output directory.", tr("OK."));
+            else if (eqlStatus == "not converged")
+                QMessageBox::warning(this,tr("Equivalent linear"), "The equivalent linear analysis did not converge, results are from the last iteration.", tr("OK."));
+
+            if (srt->solvedInFrequencyDomain())
+            {
+                // elastic profile, the results are already written
+                emit runBtnClicked();
+                refreshRun(100.);
+                return;
+            }
+
             if (!m_runningStochastic)
             {
+                QFile::remove(progressReader->fileName());
+                progressReader->start();
+                if (postProcessor->beginLive())
+                {
+                    theTabManager->updatePostProcessor(postProcessor);
+                    liveTimer->start();
+                }
                 openseesProcess->start(openseesPathVariant.toString(),QStringList()<<tclName);
                 // Let EE-UQ wait before running UQ engine
                 // openseesProcess->waitForFinished();
@@ -1409,6 +1448,8 @@ bool RockOutcrop::refreshRun(double step) {
 
         postProcessor = new PostProcessor(outputDir);
         theTabManager->updatePostProcessor(postProcessor);
+
+        profiler->updatePostProcessor(postProcessor);
         postProcessor->update();
 
         emit signalProgress(100);
@@ -1418,9 +1459,11 @@ bool RockOutcrop::refreshRun(double step) {
 
         on_killBtn_clicked();
 
+        postProcessor->cancel();
         postProcessor = new PostProcessor(outputDir);
         theTabManager->updatePostProcessor(postProcessor);
-        postProcessor->update();
+        profiler->updatePostProcessor(postProcessor);
+        postProcessor->updateInBackground();
 
         //theTabManager->setGMViewLoaded();
         //theTabManager->reFreshGMTab();
@@ -1445,64 +1488,60 @@ void RockOutcrop::onInternalFEAInvoked()
 
     shark = new SSSharkThread(srtFileName,analysisDir,outputDir,femLog, this);
     connect(shark,SIGNAL(updateProgress(double)), this, SLOT(onInternalFEAUpdated(double)));
+    connect(shark,SIGNAL(resultReady(bool)), this, SLOT(onInternalFEAFinished(bool)));
     shark->start();
 }
 
-
-void RockOutcrop::onOpenSeesFinished()
+void RockOutcrop::onInternalFEAFinished(bool ok)
 {
-
-    // writeSurfaceMotion();
-    QString str_err = openseesProcess->readAllStandardError();
-
-    if(openseesErrCount==1)
+    // only reached if the run ended without reporting 100%
+    if (ok)
     {
-        if(str_err.contains(" response analysis is finished."))
-        {
-
-            //qDebug() << "opensees says:" << str_err;
-            openseesErrCount = 2;
-
-            postProcessor = new PostProcessor(outputDir);
-            theTabManager->updatePostProcessor(postProcessor);
-            postProcessor->update();
-
-           // theTabManager->setGMViewLoaded();
-           //theTabManager->reFreshGMTab();
-
-            //theTabManager->reFreshGMView();
-           // theTabManager->getTab()->setCurrentIndex(2);
-           // resultsTab->setCurrentIndex(1);
-
-            // QMessageBox::information(this,tr("OpenSees Information"), "Analysis is done.", tr("I know."));
+        refreshRun(100.);
+        return;
+    }
+    on_killBtn_clicked();
+    QMessageBox::warning(this,tr("s3hark Information"), "The analysis in s3hark did not finish.", tr("OK."));
+}
 
 
+void RockOutcrop::onOpenSeesFinished()
+{
+    // stderr is only drained here, the status is in the progress file
+    openseesProcess->readAllStandardError();
+    progressReader->poll();
+}
 
+void RockOutcrop::onAnalysisFinished(bool ok)
+{
+    if(openseesErrCount!=1)
+        return;
+    openseesErrCount = 2;
 
-            emit signalProgress(100);
-            ui->progressBar->hide();
+    liveTimer->stop();
+    postProcessor->endLive();
+    postProcessor->cancel();
 
-        }else{
-            QRegularExpression rxlen("(.+)(%)");
+    postProcessor = new PostProcessor(outputDir);
+    theTabManager->updatePostProcessor(postProcessor);
 
-            QRegularExpressionMatch match = rxlen.match(str_err);
+    profiler->updatePostProcessor(postProcessor);
+    postProcessor->updateInBackground();
 
-            if (match.hasMatch()) {
+    emit signalProgress(100);
+    ui->progressBar->hide();
 
-                QString value = match.captured(1);
-                int step = int(ceil(value.toDouble()));
-                if(step>0)
-                    emit signalProgress(step);
-            }
+    if(!ok)
+        QMessageBox::warning(this,tr("OpenSees Information"), "The analysis did not converge, results are shown up to the last converged step.", tr("OK."));
+}
 
 
-        }
-    }
 
+void RockOutcrop::onLiveUpdate()
+{
+    postProcessor->updateLive();
 }
 
-
-
 void RockOutcrop::writeSurfaceMotion()
 {
 
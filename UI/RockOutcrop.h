@@ -6,11 +6,14 @@
 #include "Mesher.h"
 #include "ElementModel.h"
 #include <QProcess>
+#include <QTimer>
 #include "TabManager.h"
 #include "PostProcessor.h"
+#include "ProfileManager.h"
 #include "SimCenterAppWidget.h"
 #include "SiteResponse.h"
 #include "SSSharkThread.h"
+#include "ProgressReader.h"
 #include <QStandardPaths>
 #include <QCheckBox>
 #include <QDesktopServices>
@@ -62,6 +65,7 @@ public slots:
     void onConfigTabUpdated();
     void onInternalFEAInvoked();
     void onInternalFEAUpdated(double step){refreshRun(step);}
+    void onInternalFEAFinished(bool ok);
 
 private slots:
 
@@ -103,6 +107,8 @@ private slots:
     ElementModel* getElementModel()const;
 
     void onOpenSeesFinished();
+    void onAnalysisFinished(bool ok);
+    void onLiveUpdate();
 
     void hideShowTab();
     void showShowTab();
@@ -135,10 +141,15 @@ private:// some of them were public
     //QQuickView *pgaView;
     ElementModel* elementModel;
     QProcess* openseesProcess;
+    ProgressReader* progressReader;
+    // post-processes the recorders while OpenSees is running
+    QTimer* liveTimer;
+    int liveInterval = 3000;
     QProcess* pythonProcess;
     TabManager* theTabManager;
     QTabWidget* resultsTab;
     PostProcessor* postProcessor;
+    ProfileManager* profiler;
 
     double maxPGA;
 
@@ -1,12 +1,60 @@
 #include "SSSharkThread.h"
 
+#include <QTimer>
+
 SSSharkThread::SSSharkThread(QString srtFileNametmp, QString analysisDirtmp,QString outputDirtmp,QString femLogtmp, QObject *parent) :
+    QThread(parent),
     analysisDir(analysisDirtmp),
     outputDir(outputDirtmp),
     srtFileName(srtFileNametmp),
-    femLog(femLogtmp),
-    QThread(parent)
+    femLog(femLogtmp)
+{
+    // lives on the UI thread, as this object does
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(progressInterval);
+    connect(m_progressTimer, SIGNAL(timeout()), this, SLOT(drainProgress()));
+    connect(this, SIGNAL(started()), m_progressTimer, SLOT(start()));
+    connect(this, SIGNAL(finished()), this, SLOT(onFinished()));
+}
+
+SSSharkThread::~SSSharkThread()
 {
+    cancel();
+    wait();
+}
+
+void SSSharkThread::run()
+{
+    if (m_cancel.isCanceled())
+        return;
 
+    SiteResponse srt(srtFileName.toStdString(),
+                     analysisDir.toStdString(),
+                     outputDir.toStdString(),
+                     femLog.toStdString(),
+                     std::bind(&SSSharkThread::pushProgress, this, std::placeholders::_1));
+    srt.setCancelToken(&m_cancel);
+    m_result = srt.run();
 }
 
+bool SSSharkThread::pushProgress(double step)
+{
+    m_progress.push(step);
+    return !m_cancel.isCanceled();
+}
+
+void SSSharkThread::drainProgress()
+{
+    // nothing is reported once canceled, the receiver may already be gone
+    double step;
+    while (!m_cancel.isCanceled() && m_progress.pop(step))
+        emit updateProgress(step);
+}
+
+void SSSharkThread::onFinished()
+{
+    m_progressTimer->stop();
+    drainProgress();
+    if (!m_cancel.isCanceled())
+        emit resultReady(m_result > 0);
+}
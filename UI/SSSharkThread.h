@@ -2,78 +2,58 @@
 #define SSSHARKTHREAD_H
 
 #include "SiteResponse.h"
+#include "CancelToken.h"
+#include "ProgressQueue.h"
 #include <QThread>
 #include <QObject>
-#include <QtMath>
-using namespace std::placeholders;
-
-//#include <iostream>
-//#include <QDateTime>
-
+#include <QString>
+
+class QTimer;
+
+// One run of the internal (linked) FE analysis.
+//
+// run() builds the model, analyzes the motion once and returns; the thread
+// finishes with it. cancel() may be called from any thread, the analysis
+// stops at its next time step (see CancelToken). Progress is pushed by the
+// analysis into a ProgressQueue and drained on the UI thread every
+// progressInterval ms, where updateProgress() is emitted; resultReady() is
+// emitted on the UI thread after the last value.
 class SSSharkThread : public QThread
 {
     Q_OBJECT
 signals:
-    void resultReady();
+    // ok is false if the analysis failed or was canceled
+    void resultReady(bool ok);
     void updateProgress(double);
 
 public:
     SSSharkThread(QString srtFileNametmp,QString analysisDirtmp,QString outputDirtmp,QString femLog,QObject *parent = nullptr);
+    ~SSSharkThread() override;
 
-    bool updateProgressBar(double step){emit updateProgress(step);return forward;}
-    std::function<bool(double)> m_callbackFunction = std::bind(&SSSharkThread::updateProgressBar,this, _1);
-    void setStopSignal(){forward = false;}
-    bool getForward(){return forward;}
-
-
-    void run() override {
-        if (isInterruptionRequested())
-        {   forward = false;
-            srt->kill();
-        }
-        while (!isInterruptionRequested())
-        {
-
-            if (!exist) {
-                srt = new SiteResponse(srtFileName.toStdString(),
-                                                                 analysisDir.toStdString(),
-                                                                 outputDir.toStdString(),
-                                                                 femLog.toStdString(),
-                                                                 m_callbackFunction );
-                exist = true;
-            }
-
-            if (!isRunning){
-                srt->run();
-                isRunning = true;
-            } else {
-                //QDateTime local(QDateTime::currentDateTime());
-                //std::cout << "Local time is:" << local.toString().toStdString() << endln;
-            }
-
-        }
+    void cancel() {m_cancel.cancel();}
+    bool isCanceled() const {return m_cancel.isCanceled();}
 
-    }
-    /*
-    ~SSSharkThread() Q_DECL_OVERRIDE{
-            requestInterruption();
-            quit();
-            wait();
-        }
-    */
+protected:
+    void run() override;
 
+private slots:
+    void drainProgress();
+    void onFinished();
 
 private:
+    // called by the analysis on the worker thread
+    bool pushProgress(double step);
 
     QString analysisDir ;
     QString outputDir ;
     QString srtFileName ;
     QString femLog ;
-    bool isRunning = false;
-    bool exist = false;
-    SiteResponse *srt;
-    bool forward = true;
 
+    CancelToken m_cancel;
+    ProgressQueue m_progress;
+    QTimer *m_progressTimer;
+    int m_result = -1;
+    int progressInterval = 100;
 
 };
 
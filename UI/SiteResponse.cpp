@@ -54,6 +54,9 @@ void SiteResponse::init(std::string configureFile,std::string anaDir,std::string
     if (!thisSimType.compare("3D2D")) is3D = true;
     if (!thisSimType.compare("3D1D")) is3D = true;
 
+    m_motionProcessor = MotionPreprocessor(SRT["basicSettings"].value("motionProcessing", json()));
+    prepareMotions(anaDir);
+
     //./siteresponse ../test/siteLayering.loc -bbp ../test/9130326.nwhp.vel.bbp out thisLog
     // read the layering file
     std::string layersFN("/Users/simcenter/Codes/SimCenter/SiteResponseTool/test/siteLayering.loc");
@@ -117,6 +120,34 @@ void SiteResponse::init(std::string configureFile,std::string anaDir,std::string
     }
 
 }
+void SiteResponse::setMotionDir(std::string anaDir, std::string outDir)
+{
+    m_analysisDir = anaDir;
+    m_outputDir = outDir;
+
+    prepareMotions(anaDir);
+    std::string motionXFN(anaDir+"/Rock-x");//TODO: may not work on windows
+    motionX.setMotion(motionXFN.c_str());
+    if (is3D)
+    {
+        std::string motionZFN(anaDir+"/Rock-y");//TODO: may not work on windows
+        motionZ.setMotion(motionZFN.c_str());
+    }
+    model->setOutputDir(outDir);
+    model->setAnalysisDir(anaDir);
+    model->setTclOutputDir(outDir);
+}
+
+void SiteResponse::prepareMotions(const std::string &anaDir)
+{
+    // also when processing is off, to bring back an earlier original
+    std::string cacheDir(anaDir+"/"+MOTION_CACHE_DIR);
+    std::vector<std::string> motions(1, anaDir+"/Rock-x");
+    if (is3D)
+        motions.push_back(anaDir+"/Rock-y");
+    m_motionProcessor.prepare(motions, cacheDir);
+}
+
 void SiteResponse::buildTcl()
 {
     bool runAnalysis = false;
@@ -137,9 +168,9 @@ void SiteResponse::kill()
 
 int SiteResponse::run()
 {
-    if (is3D) run3D();
-    else run2D();
-    return 0;
+    if (is3D)
+        return run3D();
+    return run2D();
 }
 int SiteResponse::run2D()
 {
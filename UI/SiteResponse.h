@@ -6,6 +6,7 @@
 #include "siteLayering.h"
 #include "soillayer.h"
 #include "outcropMotion.h"
+#include "MotionPreprocessor.h"
 
 //#include "StandardStream.h"
 ////#include "FileStream.h"
@@ -20,13 +21,25 @@ public:
 	~SiteResponse();
 
     void init(std::string configureFile,std::string anaDir,std::string outDir);
+    // reload Rock-x (and Rock-y) from anaDir, the profile is kept
+    void setMotionDir(std::string anaDir, std::string outDir);
+    void setGravityCheckpointDir(std::string dir) {model->setGravityCheckpointDir(dir);}
+    void setStepBounds(double dtMin, double dtMax) {model->setStepBounds(dtMin, dtMax);}
     int run();
     int run2D();
     int run3D();
     void buildTcl();
     void buildTcl3D();
     void kill();
+    // cancel() on token stops the analysis between steps, from any thread
+    void setCancelToken(CancelToken *token) {model->setCancelToken(token);}
     bool runningStochastic() {return model->m_runningStochastic;};
+    // results of the last build are already written, see SiteResponseModel
+    bool solvedInFrequencyDomain() {return model->solvedInFrequencyDomain();}
+    std::string equivalentLinearStatus() {return model->equivalentLinearStatus();}
+    // "equivalentLinear" for screening runs, see SiteResponseModel
+    void setAnalysisMode(std::string mode) {model->setAnalysisMode(mode);}
+    bool threeD() {return is3D;}
 
     std::function<bool(double)> m_callbackFunction;
 
@@ -34,7 +47,11 @@ public:
 
 	
 private:
+    // basicSettings "motionProcessing" on Rock-x (and Rock-y) in anaDir
+    void prepareMotions(const std::string &anaDir);
+
     SiteResponseModel *model;
+    MotionPreprocessor m_motionProcessor;
     // read the motion
     OutcropMotion motionX;
     OutcropMotion motionZ;
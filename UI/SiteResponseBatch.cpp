@@ -0,0 +1,514 @@
+#include "SiteResponseBatch.h"
+#include "SiteResponse.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+#ifdef WIN32
+#include <windows.h>
+#include <direct.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <climits>
+#endif
+
+
+static bool fileExists(std::string fileName)
+{
+    std::ifstream file(fileName);
+    return bool(file);
+}
+
+static void makeDir(std::string dirName)
+{
+#ifdef WIN32
+    _mkdir(dirName.c_str());
+#else
+    mkdir(dirName.c_str(), 0755);
+#endif
+}
+
+static bool copyFile(std::string from, std::string to)
+{
+    std::ifstream src(from, std::ios::binary);
+    std::ofstream dst(to, std::ios::binary);
+    if (!src || !dst)
+        return false;
+    dst << src.rdbuf();
+    return true;
+}
+
+static std::string dirName(std::string path)
+{
+    size_t pos = path.find_last_of("/\\");
+    return pos == std::string::npos ? std::string(".") : path.substr(0, pos);
+}
+
+static std::string baseName(std::string path)
+{
+    size_t pos = path.find_last_of("/\\");
+    return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+static bool endsWith(const std::string &s, const std::string &suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// motion path without the .vel / .time extension
+static std::string motionPrefix(std::string path)
+{
+    if (endsWith(path, ".vel") || endsWith(path, ".acc"))
+        return path.substr(0, path.size() - 4);
+    if (endsWith(path, ".time"))
+        return path.substr(0, path.size() - 5);
+    return path;
+}
+
+// Rock-RSN766-x -> RSN766
+static std::string jobName(std::string prefix)
+{
+    std::string name = baseName(prefix);
+    if (name.compare(0, 5, "Rock-") == 0 && name.size() > 5)
+        name = name.substr(5);
+    if (endsWith(name, "-x"))
+        name = name.substr(0, name.size() - 2);
+    return name;
+}
+
+// duration of a motion from the first and last entries of its .time file
+static double motionDuration(std::string prefix)
+{
+    std::ifstream file(prefix + ".time");
+    std::string line;
+    bool first = true;
+    double t0 = 0.0, t1 = 0.0;
+    while (getline(file, line))
+    {
+        if ((line == "") || (line[0] == '%') || (line[0] == '#'))
+            continue;
+        std::istringstream lines(line);
+        double t;
+        if (!(lines >> t))
+            continue;
+        if (first)
+            t0 = t;
+        t1 = t;
+        first = false;
+    }
+    return t1 - t0;
+}
+
+static int runOpenSees(std::string openSeesPath, std::string dir, std::string script, std::string log)
+{
+    std::string command;
+#ifdef WIN32
+    command = "cd /d \"" + dir + "\" && \"" + openSeesPath + "\" " + script + " > " + log + " 2>&1";
+#else
+    command = "cd \"" + dir + "\" && \"" + openSeesPath + "\" " + script + " > " + log + " 2>&1";
+#endif
+    return std::system(command.c_str());
+}
+
+static std::string absolutePath(std::string path)
+{
+#ifdef WIN32
+    char buf[_MAX_PATH];
+    if (_fullpath(buf, path.c_str(), _MAX_PATH) != NULL)
+        return std::string(buf);
+#else
+    char buf[PATH_MAX];
+    if (realpath(path.c_str(), buf) != NULL)
+        return std::string(buf);
+#endif
+    return path;
+}
+
+
+SiteResponseBatch::SiteResponseBatch(std::string configureFile, std::string motions, std::string outDir, std::string femLog) :
+    m_configureFile(configureFile),
+    m_motions(motions),
+    m_outputDir(outDir),
+    m_femLog(femLog)
+{
+
+}
+
+bool SiteResponseBatch::readManifest(std::string fileName)
+{
+    std::ifstream file(fileName);
+    if (!file)
+        return false;
+
+    std::string baseDir = dirName(fileName);
+    std::string line;
+    while (getline(file, line))
+    {
+        std::istringstream lines(line);
+        std::string x, y;
+        if (!(lines >> x) || x[0] == '#' || x[0] == '%')
+            continue;
+        lines >> y;
+
+        Job job;
+        bool isAbsolute = x[0] == '/' || x[0] == '\\' || (x.size() > 1 && x[1] == ':');
+        job.motionX = motionPrefix(isAbsolute ? x : baseDir + "/" + x);
+        if (!y.empty())
+        {
+            isAbsolute = y[0] == '/' || y[0] == '\\' || (y.size() > 1 && y[1] == ':');
+            job.motionY = motionPrefix(isAbsolute ? y : baseDir + "/" + y);
+        }
+        job.name = jobName(job.motionX);
+        m_jobs.push_back(job);
+    }
+    return true;
+}
+
+bool SiteResponseBatch::scanDirectory(std::string dir)
+{
+    std::vector<std::string> files;
+#ifdef WIN32
+    WIN32_FIND_DATA findData;
+    HANDLE h = FindFirstFile((dir + "\\Rock-*.vel").c_str(), &findData);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+    do {
+        files.push_back(findData.cFileName);
+    } while (FindNextFile(h, &findData));
+    FindClose(h);
+#else
+    DIR *d = opendir(dir.c_str());
+    if (d == NULL)
+        return false;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL)
+    {
+        std::string name(entry->d_name);
+        if (name.compare(0, 5, "Rock-") == 0 && endsWith(name, ".vel"))
+            files.push_back(name);
+    }
+    closedir(d);
+#endif
+    std::sort(files.begin(), files.end());
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        std::string prefix = motionPrefix(dir + "/" + files[i]);
+        if (!fileExists(prefix + ".time"))
+        {
+            std::cout << "Skipping " << files[i] << ": no matching .time file." << "\n";
+            continue;
+        }
+        // Rock-<name>-y is the second component of Rock-<name>-x
+        if (endsWith(prefix, "-y") && fileExists(prefix.substr(0, prefix.size() - 2) + "-x.vel"))
+            continue;
+
+        Job job;
+        job.motionX = prefix;
+        if (endsWith(prefix, "-x"))
+        {
+            std::string y = prefix.substr(0, prefix.size() - 2) + "-y";
+            if (fileExists(y + ".vel") && fileExists(y + ".time"))
+                job.motionY = y;
+        }
+        job.name = jobName(prefix);
+        m_jobs.push_back(job);
+    }
+    return true;
+}
+
+// copy the motions into one directory per job and write model.tcl there.
+// The profile is read once; only the motion changes between jobs.
+bool SiteResponseBatch::prepareJobs()
+{
+    SiteResponse *srt = NULL;
+
+    for (size_t i = 0; i < m_jobs.size(); i++)
+    {
+        Job &job = m_jobs[i];
+
+        // keep job directories unique: name, name_2, name_3, ...
+        std::string baseName = job.name;
+        for (int n = 2; ; n++)
+        {
+            bool taken = false;
+            for (size_t j = 0; j < i && !taken; j++)
+                taken = m_jobs[j].name == job.name;
+            if (!taken)
+                break;
+            job.name = baseName + "_" + std::to_string(n);
+        }
+
+        job.jobDir = m_outputDir + "/" + job.name;
+        job.duration = motionDuration(job.motionX);
+        makeDir(job.jobDir);
+        makeDir(job.jobDir + "/out_tcl");
+
+        bool ok = copyFile(job.motionX + ".vel", job.jobDir + "/Rock-x.vel")
+                && copyFile(job.motionX + ".time", job.jobDir + "/Rock-x.time");
+        if (ok && !job.motionY.empty())
+            ok = copyFile(job.motionY + ".vel", job.jobDir + "/Rock-y.vel")
+                    && copyFile(job.motionY + ".time", job.jobDir + "/Rock-y.time");
+        if (!ok)
+        {
+            job.status = "missing motion";
+            continue;
+        }
+
+        if (srt == NULL)
+        {
+            srt = new SiteResponse(m_configureFile, job.jobDir, job.jobDir + "/out_tcl", m_femLog);
+            is3D = srt->threeD();
+            if (m_equivalentLinear)
+                srt->setAnalysisMode("equivalentLinear");
+            srt->setStepBounds(m_dtMin, m_dtMax);
+            // the jobs run in their own directories, give them one shared place
+            if (m_reuseGravity && !m_equivalentLinear)
+            {
+                makeDir(m_outputDir + "/gravity");
+                srt->setGravityCheckpointDir(absolutePath(m_outputDir + "/gravity"));
+            }
+        }
+        else
+            srt->setMotionDir(job.jobDir, job.jobDir + "/out_tcl");
+
+        if (is3D && job.motionY.empty())
+        {
+            job.status = "missing y motion";
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (srt->run() == -1)
+        {
+            job.status = "model failed";
+            continue;
+        }
+        // a screening run does not fall back to OpenSees
+        std::string eqlStatus = srt->equivalentLinearStatus();
+        if (m_equivalentLinear && !srt->solvedInFrequencyDomain())
+        {
+            job.status = "equivalent linear " + (eqlStatus.empty() ? std::string("failed") : eqlStatus);
+            continue;
+        }
+        if (srt->solvedInFrequencyDomain())
+        {
+            job.status = eqlStatus == "not converged" ? "not converged" : "done";
+            job.exitCode = 0;
+            job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            continue;
+        }
+        job.status = "ready";
+    }
+
+    if (srt == NULL)
+        return false;
+    delete srt;
+    return true;
+}
+
+// ready jobs on a pool of OpenSees processes, the gravity stage run first
+void SiteResponseBatch::runJobs()
+{
+    // longest motions first, so the pool does not end waiting for one long run
+    std::vector<size_t> order;
+    for (size_t i = 0; i < m_jobs.size(); i++)
+        if (m_jobs[i].status == "ready")
+            order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return m_jobs[a].duration > m_jobs[b].duration;
+    });
+
+    if (m_reuseGravity && !order.empty() && !runGravity(m_jobs[order[0]]))
+    {
+        // the half written shared checkpoint must not be restored, and the
+        // jobs must not all save into it at once: each gets its own
+        std::cout << "The gravity stage failed, every job will run its own." << "\n";
+        for (size_t k = 0; k < order.size(); k++)
+            useOwnGravity(m_jobs[order[k]]);
+    }
+
+    int numWorkers = m_numWorkers > 0 ? m_numWorkers : int(std::thread::hardware_concurrency());
+    numWorkers = std::max(1, std::min(numWorkers, int(order.size())));
+    m_numWorkers = numWorkers;
+
+    std::cout << "Running " << order.size() << " motions with " << numWorkers << " OpenSees processes." << "\n";
+
+    // each worker thread waits on one OpenSees process at a time
+    std::atomic<size_t> next(0);
+    std::mutex printMutex;
+    std::vector<std::thread> workers;
+    for (int w = 0; w < numWorkers; w++)
+    {
+        workers.push_back(std::thread([&]() {
+            size_t k;
+            while ((k = next++) < order.size())
+            {
+                Job &job = m_jobs[order[k]];
+                {
+                    std::lock_guard<std::mutex> lock(printMutex);
+                    std::cout << "Started " << job.name << " (" << job.duration << " s)" << std::endl;
+                }
+                runJob(job);
+                {
+                    std::lock_guard<std::mutex> lock(printMutex);
+                    std::cout << "Finished " << job.name << ": " << job.status << " in " << job.seconds << " s" << std::endl;
+                }
+            }
+        }));
+    }
+    for (size_t w = 0; w < workers.size(); w++)
+        workers[w].join();
+}
+
+// run the gravity stage of one job alone, so the pool starts from its checkpoint
+bool SiteResponseBatch::runGravity(Job &job)
+{
+    std::ofstream gravity(job.jobDir + "/gravity.tcl");
+    gravity << "set gravityOnly 1" << "\n";
+    gravity << "source model.tcl" << "\n";
+    gravity.close();
+
+    std::cout << "Running the gravity stage in " << job.jobDir << std::endl;
+    return runOpenSees(m_openSeesPath, job.jobDir, "gravity.tcl", "gravity.log") == 0;
+}
+
+// point the gravity checkpoint of a job into its own directory
+void SiteResponseBatch::useOwnGravity(Job &job)
+{
+    std::ofstream script(job.jobDir + "/ownGravity.tcl");
+    script << "set checkpointDir gravity" << "\n";
+    script << "source model.tcl" << "\n";
+    script.close();
+    job.script = "ownGravity.tcl";
+}
+
+void SiteResponseBatch::runJob(Job &job)
+{
+    auto start = std::chrono::steady_clock::now();
+    job.exitCode = runOpenSees(m_openSeesPath, job.jobDir, job.script, "opensees.log");
+    job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // OpenSees may exit with 0 after a failed analysis, check the log as well
+    bool finished = false;
+    std::ifstream log(job.jobDir + "/opensees.log");
+    std::string line;
+    while (getline(log, line))
+        if (line.find("Site response analysis is finished.") != std::string::npos)
+            finished = true;
+    job.status = (job.exitCode == 0 && finished) ? "done" : "failed";
+}
+
+bool SiteResponseBatch::writeSummary()
+{
+    json jobs = json::array();
+    for (size_t i = 0; i < m_jobs.size(); i++)
+    {
+        const Job &job = m_jobs[i];
+        json j;
+        j["name"] = job.name;
+        j["motionX"] = job.motionX;
+        j["motionY"] = job.motionY;
+        j["duration"] = job.duration;
+        j["jobDir"] = job.jobDir;
+        j["status"] = job.status;
+        j["exitCode"] = job.exitCode;
+        j["seconds"] = job.seconds;
+        std::ifstream eql(job.jobDir + "/out_tcl/eqlSummary.json");
+        if (m_equivalentLinear && eql)
+        {
+            try {
+                json e;
+                eql >> e;
+                if (e.find("status") != e.end())
+                    j["eqlStatus"] = e["status"];
+                const char *keys[] = {"pga", "maxStrain", "converged", "reason"};
+                for (const char *key : keys)
+                    if (e.find(key) != e.end())
+                        j[key] = e[key];
+            } catch (std::exception &) {}
+        }
+        jobs.push_back(j);
+    }
+
+    json summary;
+    summary["inputFile"] = m_configureFile;
+    summary["motions"] = m_motions;
+    summary["simType"] = is3D ? "3D" : "2D";
+    summary["numWorkers"] = m_numWorkers;
+    summary["reuseGravity"] = m_reuseGravity && !m_equivalentLinear;
+    summary["analysisMode"] = m_equivalentLinear ? "equivalentLinear" : "effectiveStress";
+    summary["jobs"] = jobs;
+
+    std::ofstream o(m_outputDir + "/batchSummary.json");
+    if (!o)
+        return false;
+    o << std::setw(4) << summary << std::endl;
+    return true;
+}
+
+int SiteResponseBatch::run()
+{
+    m_jobs.clear();
+    if (!scanDirectory(m_motions) && !readManifest(m_motions))
+    {
+        std::cout << "Couldn't read motions from " << m_motions << "\n";
+        return -1;
+    }
+    if (m_jobs.empty())
+    {
+        std::cout << "No motions found in " << m_motions << "\n";
+        return -1;
+    }
+
+    if (m_openSeesPath.empty())
+    {
+        std::ifstream i(m_configureFile);
+        json SRT;
+        try {
+            i >> SRT;
+            m_openSeesPath = SRT["basicSettings"].value("OpenSeesPath", std::string(""));
+        } catch (std::exception &e) {
+            std::cout << "Couldn't read " << m_configureFile << ": " << e.what() << "\n";
+            return -1;
+        }
+        if (m_openSeesPath.empty())
+            m_openSeesPath = "OpenSees";
+    }
+
+    if (!prepareJobs())
+    {
+        std::cout << "None of the motions could be read." << "\n";
+        writeSummary();
+        return -1;
+    }
+
+    // a screening run is solved by prepareJobs, nothing is left for OpenSees
+    if (!m_equivalentLinear)
+        runJobs();
+
+    int numFailed = 0;
+    for (size_t i = 0; i < m_jobs.size(); i++)
+        if (m_jobs[i].status != "done")
+            numFailed++;
+
+    if (!writeSummary())
+        std::cout << "Couldn't write " << m_outputDir << "/batchSummary.json" << "\n";
+    std::cout << m_jobs.size() - numFailed << " of " << m_jobs.size() << " motions done. Summary: "
+              << m_outputDir << "/batchSummary.json" << "\n";
+
+    return numFailed;
+}
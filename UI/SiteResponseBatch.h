@@ -0,0 +1,82 @@
+#ifndef SITERESPONSEBATCH_H
+#define SITERESPONSEBATCH_H
+
+#include <string>
+#include <vector>
+
+// Runs one soil profile against a suite of input motions.
+//
+// Motions come from a manifest (one motion per line: "xMotion [yMotion]",
+// paths with or without the .vel extension, relative to the manifest) or
+// from a directory of Rock-*.vel / Rock-*.time pairs. Each motion gets its
+// own job directory outDir/<name> holding Rock-x.*, model.tcl and out_tcl,
+// so the OpenSees runs cannot overwrite each other's recorders.
+// Jobs run in a bounded pool of OpenSees processes, longest motion first,
+// and a summary index is written to outDir/batchSummary.json.
+// The gravity stage is run once, before the pool starts, and the jobs
+// restore its checkpoint. If it fails, each job keeps a checkpoint of its
+// own in jobDir/gravity.
+// Jobs on an all elastic 2D profile are solved in the frequency domain while
+// their model is built and need no OpenSees run, as are all jobs of an
+// equivalent linear screening run (setEquivalentLinear), whose peak surface
+// acceleration and largest strain go into the summary. A screening job that
+// does not converge is marked "not converged", one the equivalent linear
+// analysis cannot solve (3D, random fields, bad input) fails instead of
+// running OpenSees.
+class SiteResponseBatch {
+
+public:
+    struct Job {
+        std::string name;
+        std::string motionX;   // path without extension
+        std::string motionY;   // 3D only
+        std::string jobDir;
+        double duration = 0.0;
+        int exitCode = -1;
+        double seconds = 0.0;
+        std::string status = "pending";
+        std::string script = "model.tcl";
+    };
+
+    SiteResponseBatch(std::string configureFile, std::string motions, std::string outDir, std::string femLog);
+
+    void setNumWorkers(int n) { m_numWorkers = n; }
+    void setOpenSeesPath(std::string path) { m_openSeesPath = path; }
+    // share one gravity checkpoint (outDir/gravity) between the jobs
+    void setReuseGravity(bool reuse) { m_reuseGravity = reuse; }
+    // screen the motions with the equivalent linear analysis of the profile
+    void setEquivalentLinear(bool eql) { m_equivalentLinear = eql; }
+    // adaptive time step bounds, negative: basicSettings "dtMin" / "dtMax"
+    void setStepBounds(double dtMin, double dtMax) { m_dtMin = dtMin; m_dtMax = dtMax; }
+
+    // returns the number of failed jobs, -1 if nothing could be run
+    int run();
+
+    const std::vector<Job>& getJobs() const { return m_jobs; }
+
+private:
+    bool readManifest(std::string fileName);
+    bool scanDirectory(std::string dirName);
+    bool prepareJobs();
+    void runJobs();
+    bool runGravity(Job &job);
+    void useOwnGravity(Job &job);
+    void runJob(Job &job);
+    bool writeSummary();
+
+    std::string m_configureFile;
+    std::string m_motions;
+    std::string m_outputDir;
+    std::string m_femLog;
+    std::string m_openSeesPath;
+    int m_numWorkers = 0;
+    bool m_reuseGravity = true;
+    bool m_equivalentLinear = false;
+    double m_dtMin = -1.0;
+    double m_dtMax = -1.0;
+    bool is3D = false;
+
+    std::vector<Job> m_jobs;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "ElementModel.h"
 #include "PostProcessor.h"
 #include "BonzaTableView.h"
+#include "PlotDataProvider.h"
 
 #include <QDebug>
 #include <QAbstractItemModel>
@@ -17,6 +18,8 @@
 #include <QLabel>
 #include <QComboBox>
 #include <QDialog>
+#include <QWebChannel>
+#include <QWebEngineView>
 
 #include <ui_FEM.h>
 #include <ui_DefaultMatTab.h>
@@ -35,28 +38,13 @@
 
 TabManager::TabManager(QWidget *parent) : QDialog(parent)
 {
-
+    plotData = new PlotDataProvider(nullptr, this);
 }
 
 TabManager::TabManager(BonzaTableView *tableViewIn, ElementModel *emodel,QWidget *parent) : QDialog(parent),elementModel(emodel)
 {
 
     qsHtmlName = QDir(rootDir).filePath("/Users/simcenter/Codes/SimCenter/s3hark/resources/ui/chat.html");
-    GMTabHtmlName = QDir(rootDir).filePath("resources/ui/GroundMotion/index.html");
-    accHtmlName = QDir(rootDir).filePath("resources/ui/GroundMotion/acc.html");
-    dispHtmlName = QDir(rootDir).filePath("resources/ui/GroundMotion/disp.html");
-    pwpHtmlName = QDir(rootDir).filePath("resources/ui/GroundMotion/pwp.html");
-    rupwpHtmlName = QDir(rootDir).filePath("resources/ui/GroundMotion/rupwp.html");
-    strainHtmlName = QDir(rootDir).filePath("resources/ui/GroundMotion/strain.html");
-    stressHtmlName = QDir(rootDir).filePath("resources/ui/GroundMotion/stress.html");
-
-    GMTabHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/index-template.html");
-    accHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/acc-template.html");
-    dispHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/disp-template.html");
-    pwpHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/pwp-template.html");
-    rupwpHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/rupwp-template.html");
-    strainHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/strain-template.html");
-    stressHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/stress-template.html");
 
     analysisDir = QDir(rootDir).filePath(analysisName);
     femFilename = QDir(analysisDir).filePath("configure.dat");
@@ -69,6 +57,9 @@ TabManager::TabManager(BonzaTableView *tableViewIn, ElementModel *emodel,QWidget
     if(!QDir(analysisDir).exists())
         QDir().mkdir(analysisDir);
 
+    plotData = new PlotDataProvider(elementModel, this);
+    plotData->setPlotBuckets(plotBuckets);
+
 }
 
 void TabManager::onTabBarClicked(int tabinx)
@@ -139,23 +130,14 @@ void TabManager::init(QTabWidget* theTab){
     Ui::DefaultMatTabUi ui2;
     ui2.setupUi(defaultWidget);
 
-    /* removing response
     // load ground motion view from html
     GMView = new QWebEngineView(this);
-    //GMView->load(QUrl("file:////Users/simcenter/Codes/SimCenter/SiteResponseTool/resources/ui/GroundMotion/index.html"));
-    QString GMTabHtmlName_true = QDir(rootDir).filePath(GMTabHtmlName);
-    //GMView->load(QUrl::fromLocalFile(QFileInfo(GMTabHtmlName_true).absoluteFilePath()));
     QWebChannel *pWebChannel   = new QWebChannel(GMView->page());
-    //TInteractObj *pInteractObj = new TInteractObj(this);
-    pWebChannel->registerObject(QStringLiteral("elementModel"), elementModel);
+    registerPlotData(pWebChannel);
     GMView->page()->setWebChannel(pWebChannel);
-    GMView->page()->load(QUrl::fromLocalFile(QFileInfo(GMTabHtmlName_true).absoluteFilePath()));
-    //GMView->show();
-
-    //GMView->reload();
+    GMView->page()->load(QUrl::fromLocalFile(QDir(rootDir).filePath("resources/ui/GroundMotion/results.html")));
 
     tab->addTab(GMView,"Response");
-    removing response  */
 
 
 
@@ -576,7 +558,6 @@ void TabManager::init(QTabWidget* theTab){
 
 
     //reFreshGMTab();
-    initGMTab();
 
 
     //connect(elementModel,SIGNAL(dataChanged(QModelIndex,QModelIndex)), this, SLOT(onElementDataChanged(QModelIndex,QModelIndex)));
@@ -1113,1275 +1094,30 @@ void TabManager::onFEMTabEdited()
 void TabManager::reFreshGMTab()
 {
 
-
-    updateVelHtml();
-    updateAccHtml();
-    updateDispHtml();
-    updatePWPHtml();
-    updateSaHtml();
-    updateStrainHtml();
-    updateStressHtml();
-    updateStressStrainHtml();
-    updateRupwpHtml();
+    // results.html asks plotData for the series it shows
+    plotData->invalidate();
 
     //GMView->reload();
     //GMView->show();
 
 }
 
-void TabManager::initGMTab()
-{
-    QString GMTabHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/index-template.html");
-    QString accHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/acc-template.html");
-    QString dispHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/disp-template.html");
-    QString pwpHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/pwp-template.html");
-    QString rupwpHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/rupwp-template.html");
-    QString strainHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/strain-template.html");
-    QString stressHtmlNameTmp = QDir(rootDir).filePath("resources/ui/GroundMotion/stress-template.html");
-
-    QFile file1(GMTabHtmlName);
-    if(!file1.exists())
-        QFile::copy(GMTabHtmlNameTmp, GMTabHtmlName);
-    QFile file2(accHtmlName);
-    if(!file2.exists())
-        QFile::copy(accHtmlNameTmp, accHtmlName);
-    QFile file3(dispHtmlName);
-    if(!file3.exists())
-        QFile::copy(dispHtmlNameTmp, dispHtmlName);
-    QFile file4(pwpHtmlName);
-    if(!file4.exists())
-        QFile::copy(pwpHtmlNameTmp, pwpHtmlName);
-    QFile file5(rupwpHtmlName);
-    if(!file5.exists())
-        QFile::copy(rupwpHtmlNameTmp, rupwpHtmlName);
-    QFile file6(strainHtmlName);
-    if(!file6.exists())
-        QFile::copy(strainHtmlNameTmp, strainHtmlName);
-    QFile file7(stressHtmlName);
-    if(!file7.exists())
-        QFile::copy(stressHtmlNameTmp, stressHtmlName);
-
-    //GMView->reload();
-}
-
-void TabManager::updateVelHtml()
-{
-    // get file paths
-    QString tmpPath;
-
-    QFileInfo indexHtmlInfo(GMTabHtmlName);
-    if (simulationD==3) tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/index3D2D-template.html");
-    else tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/index-template.html");
-    QString newPath = QDir(rootDir).filePath("resources/ui/GroundMotion/index.html");
-    QFile::remove(newPath);
-    //QFile::copy(tmpPath, newPath);
-
-    // read template file into string
-    QFile file(tmpPath);
-    QString text;
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QByteArray t = file.readAll();
-        text = QString(t);
-        file.close();
-    }
-
-
-    QString insertedString = loadGMtoString();
-    text.replace(QString("//UPDATEPOINT"), insertedString);
-
-    // write to index.html
-    QFile newfile(newPath);
-    if(newfile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        newfile.write(text.toUtf8());
-        newfile.close();
-    }
-}
-
-
-void TabManager::updateAccHtml()
-{
-    // get file paths
-    QFileInfo htmlInfo(accHtmlName);
-    //QString dir = htmlInfo.path();
-    QString tmpPath;
-    if (simulationD==3) tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/acc3D2D-template.html");
-    else tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/acc-template.html");
-    QString newPath = QDir(rootDir).filePath("resources/ui/GroundMotion/acc.html");
-    QFile::remove(newPath);
-
-    // read template file into string
-    QString text;
-    QFile file(tmpPath);
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QByteArray t = file.readAll();
-        text = QString(t);
-        file.close();
-    }
-
-
-
-    QString insertedString = loadMotions2String("acc");
-    text.replace(QString("//UPDATEPOINT"), insertedString);
-
-
-    // write to index.html
-    QFile newfile(newPath);
-    if(newfile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        newfile.write(text.toUtf8());
-        newfile.close();
-    }
-}
-
-void TabManager::updateDispHtml()
-{
-    // get file paths
-    QFileInfo htmlInfo(dispHtmlName);
-    //QString dir = htmlInfo.path();
-    QString tmpPath;
-    if (simulationD==3) tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/disp3D2D-template.html");
-    else tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/disp-template.html");
-    QString newPath = QDir(rootDir).filePath("resources/ui/GroundMotion/disp.html");
-    QFile::remove(newPath);
-
-    // read template file into string
-    QString text;
-    QFile file(tmpPath);
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QByteArray t = file.readAll();
-        text = QString(t);
-        file.close();
-    }
-
-
-    QString insertedString = loadMotions2String("disp");
-    text.replace(QString("//UPDATEPOINT"), insertedString);
-
-
-    // write to index.html
-    QFile newfile(newPath);
-    if(newfile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        newfile.write(text.toUtf8());
-        newfile.close();
-    }
-}
-
-void TabManager::updateStrainHtml()
-{
-    // get file paths
-    QFileInfo htmlInfo(strainHtmlName);
-    //QString dir = htmlInfo.path();
-    QString tmpPath;
-    if (simulationD==3) tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/strain3D2D-template.html");
-    else tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/strain-template.html");
-    QString newPath = QDir(rootDir).filePath("resources/ui/GroundMotion/strain.html");
-    QFile::remove(newPath);
-
-    // read template file into string
-    QFile file(tmpPath);
-    QString text;
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QByteArray t = file.readAll();
-        text = QString(t);
-        file.close();
-    }
-
-
-    QString insertedString = loadEleResponse("strain");
-    text.replace(QString("//UPDATEPOINT"), insertedString);
-
-
-    // write to index.html
-    QFile newfile(newPath);
-    if(newfile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        newfile.write(text.toUtf8());
-        newfile.close();
-    }
-}
-
-
-void TabManager::updateStressHtml()
-{
-    // get file paths
-    QFileInfo htmlInfo(strainHtmlName);
-    //QString dir = htmlInfo.path();
-    QString tmpPath;
-    if (simulationD==3) tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/stress3D2D-template.html");
-    else tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/stress-template.html");
-    QString newPath = QDir(rootDir).filePath("resources/ui/GroundMotion/stress.html");
-    QFile::remove(newPath);
-
-    // read template file into string
-    QFile file(tmpPath);
-    QString text;
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QByteArray t = file.readAll();
-        text = QString(t);
-        file.close();
-    }
-
-
-    QString insertedString = loadEleResponse("stress");
-    text.replace(QString("//UPDATEPOINT"), insertedString);
-
-
-    // write to index.html
-    QFile newfile(newPath);
-    if(newfile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        newfile.write(text.toUtf8());
-        newfile.close();
-    }
-}
-
-void TabManager::updateStressStrainHtml()
-{
-    // get file paths
-    QFileInfo htmlInfo(strainHtmlName);
-    //QString dir = htmlInfo.path();
-    QString tmpPath;
-    if (simulationD==3) tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/stressstrain3D2D-template.html");
-    else tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/stressstrain-template.html");
-    QString newPath = QDir(rootDir).filePath("resources/ui/GroundMotion/stressstrain.html");
-    QFile::remove(newPath);
-
-    // read template file into string
-    QFile file(tmpPath);
-    QString text;
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QByteArray t = file.readAll();
-        text = QString(t);
-        file.close();
-    }
-
-
-    QString insertedString = loadEleResponse("stressstrain");
-    text.replace(QString("//UPDATEPOINT"), insertedString);
-
-
-    // write to index.html
-    QFile newfile(newPath);
-    if(newfile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        newfile.write(text.toUtf8());
-        newfile.close();
-    }
-}
-
-void TabManager::updatePWPHtml()
-{
-    // get file paths
-    QFileInfo htmlInfo(pwpHtmlName);
-    //QString dir = htmlInfo.path();
-    QString tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/pwp-template.html");
-    QString newPath = QDir(rootDir).filePath("resources/ui/GroundMotion/pwp.html");
-    QFile::remove(newPath);
-
-    // read template file into string
-    QFile file(tmpPath);
-    QString text;
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QByteArray t = file.readAll();
-        text = QString(t);
-        file.close();
-    }
-
-
-    QString insertedString = loadPWPResponse();
-    text.replace(QString("//UPDATEPOINT"), insertedString);
-
-
-    // write to index.html
-    QFile newfile(newPath);
-    if(newfile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        newfile.write(text.toUtf8());
-        newfile.close();
-    }
-}
-
-
-void TabManager::updateRupwpHtml()
-{
-    // get file paths
-    QFileInfo htmlInfo(rupwpHtmlName);
-    //QString dir = htmlInfo.path();
-    QString tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/rupwp-template.html");
-    QString newPath = QDir(rootDir).filePath("resources/ui/GroundMotion/rupwp.html");
-    QFile::remove(newPath);
-
-    // read template file into string
-    QFile file(tmpPath);
-    QString text;
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QByteArray t = file.readAll();
-        text = QString(t);
-        file.close();
-    }
-
-
-    QString insertedString = loadruPWPResponse();
-    text.replace(QString("//UPDATEPOINT"), insertedString);
-
-
-    // write to index.html
-    QFile newfile(newPath);
-    if(newfile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        newfile.write(text.toUtf8());
-        newfile.close();
-    }
-}
-
-
-void TabManager::updateSaHtml()
-{
-    // get file paths
-    QFileInfo htmlInfo(pwpHtmlName);
-    //QString dir = htmlInfo.path();
-    QString tmpPath = QDir(rootDir).filePath("resources/ui/GroundMotion/sa-template.html");
-    QString newPath = QDir(rootDir).filePath("resources/ui/GroundMotion/sa.html");
-    QFile::remove(newPath);
-
-    // read template file into string
-    QFile file(tmpPath);
-    QString text;
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QByteArray t = file.readAll();
-        text = QString(t);
-        file.close();
-    }
-
-
-    QString insertedString = loadNodeSa();
-    text.replace(QString("//UPDATEPOINT"), insertedString);
-
-
-    // write to index.html
-    QFile newfile(newPath);
-    if(newfile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        newfile.write(text.toUtf8());
-        newfile.close();
-    }
-}
-
-
-
-
-QString TabManager::loadGMtoString()
-{
-
-    QString text;
-    QTextStream stream(&text);
-
-    /*
-     * Get rock motion from file
-     */
-    writeGM();
-
-    QStringList *xd = postProcessor->getxdBaseVel();
-    QStringList *yd = postProcessor->getydBaseVel();
-    QStringList *ydx2 = postProcessor->getydBaseVelx2();
-
-    overStep = int(floor(xd->size()/maxStepToShow));
-    if (overStep < 1)
-        overStep = 1;
-
-    stream << "xnew = ['x'";
-    for (int i=0; i<xd->size(); i+=overStep)
-        stream << ", "<<xd->at(i);
-    stream <<"];" <<"\n";
-
-    if (simulationD==3)
-    {
-        stream << "ynewx1 = ['Rock motion-x1'";
-        for (int i=0; i<yd->size(); i+=overStep)
-            stream << ", "<<yd->at(i);
-        stream <<"];" <<"\n";
-        stream << "ynewx2 = ['Rock motion-x2'";
-        for (int i=0; i<ydx2->size(); i+=overStep)
-            stream << ", "<<ydx2->at(i);
-        stream <<"];" <<"\n";
-    }
-    else {
-        stream << "ynew = ['Rock motion'";
-        for (int i=0; i<yd->size(); i+=overStep)
-            stream << ", "<<yd->at(i);
-        stream <<"];" <<"\n";
-    }
-
-    /*
-     * Get surface motion from file
-     */
-    //QString surfaceVelFileName = "/Users/simcenter/Codes/SimCenter/SiteResponseTool/bin/out_tcl/vel_surface.txt";
-
-    QStringList *xdSurfaceVel = postProcessor->getxdSurfaceVel();
-    QStringList *ydSurfaceVel = postProcessor->getydSurfaceVel();
-    QStringList *ydSurfaceVelx2 = postProcessor->getydSurfaceVelx2();
-
-    //overStep = int(floor(xdSurfaceVel->size()/maxStepToShow));
-    stream << "xSurfaceVel = ['x'";
-    for (int i=0; i<xdSurfaceVel->size(); i+=overStep)
-        stream << ", "<<xdSurfaceVel->at(i);
-    stream <<"];" <<"\n";
-
-    if (simulationD==3)
-    {
-        stream << "ySurfaceVelx1 = ['Surface motion-x1'";
-        for (int i=0; i<ydSurfaceVel->size(); i+=overStep)
-            stream << ", "<<ydSurfaceVel->at(i).toDouble();
-        stream <<"];" <<"\n";
-
-        stream << "ySurfaceVelx2 = ['Surface motion-x2'";
-        for (int i=0; i<ydSurfaceVelx2->size(); i+=overStep)
-            stream << ", "<<ydSurfaceVelx2->at(i).toDouble();
-        stream <<"];" <<"\n";
-    }
-    else {
-        stream << "ySurfaceVel = ['Surface motion'";
-        for (int i=0; i<ydSurfaceVel->size(); i+=overStep)
-            stream << ", "<<ydSurfaceVel->at(i).toDouble();
-        stream <<"];" <<"\n";
-    }
-
-    QString nodeResponseStr = loadNodeResponse("vel");
-    stream << nodeResponseStr;
-
-    writeSurfaceMotion();
-
-
-
-
-    //stream << "       xnew = ['x', 1, 2, 3, 4, 5, 6];" <<endl;
-    //stream << "       ynew = ['Ground motion', 70, 180, 190, 180, 80, 250];"<<endl;
-    //stream << "       chart.unload();"<<endl;
-    stream << "       setTimeout(function () {"<<"\n";
-    stream << "       chart.load({"<<"\n";
-    stream << "           columns: ["<<"\n";
-    stream << "           xnew,"<<"\n";
-    if(simulationD==3)
-    {
-    stream <<"           ynewx1,"<<"\n";
-    stream <<"           ynewx2"<<"\n";
-    }
-    else stream <<"           ynew"<<"\n";
-    stream <<"           ]"<<"\n";
-    stream <<"       });"<<"\n";
-
-    stream << "       chart.load({"<<"\n";
-    stream << "           columns: ["<<"\n";
-    stream << "           xSurfaceVel,"<<"\n";
-    if(simulationD==3)
-    {
-    stream <<"           ySurfaceVelx1,"<<"\n";
-    stream <<"           ySurfaceVelx2"<<"\n";
-    }
-    else stream <<"           ySurfaceVel"<<"\n";
-    stream <<"           ]"<<"\n";
-    stream <<"       });"<<"\n";
-
-    stream <<"       chart.unload({"<<"\n";
-    stream <<"           ids: 'Demo motion 1'"<<"\n";
-    stream <<"       });"<<"\n";
-    stream <<"       chart.unload({"<<"\n";
-    stream <<"           ids: 'Demo motion 2'"<<"\n";
-    stream <<"       });"<<"\n";
-    stream <<"       }, 1000);"<<"\n";
-    return text;
-
-}
-
-
-QString TabManager::loadGMtoStringVintage()
-{
-
-    QString text;
-    QTextStream stream(&text);
-
-
-
-    /*
-     * Get rock motion from file
-     */
-    QString newGmPathStr = FEMWidget->findChild<QLineEdit*>("GMPath")->text();
-    QFile file(newGmPathStr);
-    QStringList xd, yd;
-    if(file.open(QIODevice::ReadOnly)) {
-        QTextStream in(&file);
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            xd.append(thisLine[0].trimmed());
-            yd.append(thisLine[1].trimmed());
-        }
-        file.close();
-    }
-
-    stream << "xnew = ['x'";
-    for (int i=0; i<xd.size(); i++)
-        stream << ", "<<xd.at(i);
-    stream <<"];" <<"\n";
-
-    stream << "ynew = ['Rock motion'";
-    for (int i=0; i<yd.size(); i++)
-        stream << ", "<<yd.at(i);
-    stream <<"];" <<"\n";
-
-    /*
-     * Get surface motion from file
-     */
-    //QString surfaceVelFileName = "/Users/simcenter/Codes/SimCenter/SiteResponseTool/bin/out_tcl/vel_surface.txt";
-    QString surfaceVelFileName = analysisDir+"/out_tcl/surface.vel";
-    QFile surfaceVelFile(surfaceVelFileName);
-    QStringList xdSurfaceVel, ydSurfaceVel;
-    if(surfaceVelFile.open(QIODevice::ReadOnly)) {
-        QTextStream in(&surfaceVelFile);
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            if (thisLine.size()<2)
-                break;
-            else
-            {
-                thisLine.removeAll("");
-                if(thisLine.size()>1)
-                {
-                xdSurfaceVel.append(thisLine[0].trimmed());
-                ydSurfaceVel.append(thisLine[1].trimmed());
-                }else
-                    break;
-
-            }
-
-        }
-        surfaceVelFile.close();
-    }
-
-    stream << "xSurfaceVel = ['x'";
-    for (int i=0; i<xdSurfaceVel.size(); i++)
-        stream << ", "<<xdSurfaceVel.at(i);
-    stream <<"];" <<"\n";
-
-    stream << "ySurfaceVel = ['Surface motion'";
-    for (int i=0; i<ydSurfaceVel.size(); i++)
-        stream << ", "<<ydSurfaceVel.at(i).toDouble();
-    stream <<"];" <<"\n";
-
-    QString nodeResponseStr = loadNodeResponse("vel");
-    stream << nodeResponseStr;
-
-    writeSurfaceMotion();
-
-
-
-
-    //stream << "       xnew = ['x', 1, 2, 3, 4, 5, 6];" <<"\n";
-    //stream << "       ynew = ['Ground motion', 70, 180, 190, 180, 80, 250];"<<"\n";
-    //stream << "       chart.unload();"<<"\n";
-    stream << "       setTimeout(function () {"<<"\n";
-    stream << "       chart.load({"<<"\n";
-    stream << "           columns: ["<<"\n";
-    stream << "           xnew,"<<"\n";
-    stream <<"           ynew"<<"\n";
-    stream <<"           ]"<<"\n";
-    stream <<"       });"<<"\n";
-
-    stream << "       chart.load({"<<"\n";
-    stream << "           columns: ["<<"\n";
-    stream << "           xSurfaceVel,"<<"\n";
-    if(simulationD==3)
-    {
-    stream <<"           ySurfaceVelx1,"<<"\n";
-    stream <<"           ySurfaceVelx2"<<"\n";
-    }
-    else stream <<"           ySurfaceVel"<<"\n";
-    stream <<"           ]"<<"\n";
-    stream <<"       });"<<"\n";
-
-    stream <<"       chart.unload({"<<"\n";
-    stream <<"           ids: 'Demo motion 1'"<<"\n";
-    stream <<"       });"<<"\n";
-    stream <<"       chart.unload({"<<"\n";
-    stream <<"           ids: 'Demo motion 2'"<<"\n";
-    stream <<"       });"<<"\n";
-    stream <<"       }, 1000);"<<"\n";
-    return text;
-
-}
-
-
-QString TabManager::loadMotions2String(QString motion)
-{
-
-    QString text;
-    QTextStream stream(&text);
-
-    QStringList *xdBase;
-    QStringList *xdSurface;
-    QStringList *ydBase;
-    QStringList *ydBasex2;
-    QStringList *ydSurface;
-    QStringList *ydSurfacex2;
-
-    if (motion=="vel")
-    {
-        xdBase = postProcessor->getxdBaseVel();
-        ydBase = postProcessor->getydBaseVel();
-        if(simulationD==3) ydBasex2 = postProcessor->getydBaseVelx2();
-        xdSurface = postProcessor->getxdSurfaceVel();
-        ydSurface = postProcessor->getydSurfaceVel();
-        if(simulationD==3) ydSurfacex2 = postProcessor->getydSurfaceVelx2();
-    } else if (motion=="acc")
-    {
-        xdBase = postProcessor->getxdBaseAcc();
-        ydBase = postProcessor->getydBaseAcc();
-        if(simulationD==3) ydBasex2 = postProcessor->getydBaseAccx2();
-        xdSurface = postProcessor->getxdSurfaceAcc();
-        ydSurface = postProcessor->getydSurfaceAcc();
-        if(simulationD==3) ydSurfacex2 = postProcessor->getydSurfaceAccx2();
-    } else {
-        xdBase = postProcessor->getxdBaseDisp();
-        ydBase = postProcessor->getydBaseDisp();
-        if(simulationD==3) ydBasex2 = postProcessor->getydBaseDispx2();
-        xdSurface = postProcessor->getxdSurfaceDisp();
-        ydSurface = postProcessor->getydSurfaceDisp();
-        if(simulationD==3) ydSurfacex2 = postProcessor->getydSurfaceDispx2();
-    }
-
-
-    //int overStep;
-    if(xdBase && ydBase)
-    {
-        //overStep = int(floor(xdBase->size()/maxStepToShow));
-        stream << "xnew = ['x'";
-        for (int i=0; i<xdBase->size(); i+=overStep)
-            stream << ", "<<xdBase->at(i);
-        stream <<"];" <<"\n";
-
-        if(simulationD==3)
-        {
-            stream << "ynewx1 = ['Rock motion-x1'";
-            for (int i=0; i<ydBase->size(); i+=overStep)
-                stream << ", "<<ydBase->at(i);
-            stream <<"];" <<"\n";
-            stream << "ynewx2 = ['Rock motion-x2'";
-            for (int i=0; i<ydBasex2->size(); i+=overStep)
-                stream << ", "<<ydBasex2->at(i);
-            stream <<"];" <<"\n";
-        }else {
-            stream << "ynew = ['Rock motion'";
-            for (int i=0; i<ydBase->size(); i+=overStep)
-                stream << ", "<<ydBase->at(i);
-            stream <<"];" <<"\n";
-
-        }
-    }
-
-
-
-    QString nodeResponseStr = loadNodeResponse(motion);
-    stream << nodeResponseStr;
-
-
-
-    /*
-     * Get surface motion from file
-     */
-
-
-    if(xdSurface && ydSurface)
-    {
-        stream << "xSurfaceVel = ['x'";
-        for (int i=0; i<xdSurface->size(); i+=overStep)
-            stream << ", "<<xdSurface->at(i);
-        stream <<"];" <<"\n";
-        if(simulationD==3)
-        {
-            stream << "ySurfaceVelx1 = ['Surface motion-x1'";
-            for (int i=0; i<ydSurface->size(); i+=overStep)
-                stream << ", "<<ydSurface->at(i).toDouble();
-            stream <<"];" <<"\n";
-            stream << "ySurfaceVelx2 = ['Surface motion-x2'";
-            for (int i=0; i<ydSurfacex2->size(); i+=overStep)
-                stream << ", "<<ydSurfacex2->at(i).toDouble();
-            stream <<"];" <<"\n";
-        }else {
-            stream << "ySurfaceVel = ['Surface motion'";
-            for (int i=0; i<ydSurface->size(); i+=overStep)
-                stream << ", "<<ydSurface->at(i).toDouble();
-            stream <<"];" <<"\n";
-
-        }
-    }
-
-    writeSurfaceMotion();
-
-
-
-
-    //stream << "       xnew = ['x', 1, 2, 3, 4, 5, 6];" <<"\n";
-    //stream << "       ynew = ['Ground motion', 70, 180, 190, 180, 80, 250];"<<"\n";
-    stream << "       chart.unload();"<<"\n";
-    stream << "       setTimeout(function () {"<<"\n";
-    stream << "       chart.load({"<<"\n";
-    stream << "           columns: ["<<"\n";
-    stream << "           xnew,"<<"\n";
-    if(simulationD==3)
-    {stream <<"           ynewx1,"<<"\n";
-        stream <<"           ynewx2"<<"\n";
-    }else {
-        stream <<"           ynew"<<"\n";
-    }
-    stream <<"           ]"<<"\n";
-    stream <<"       });"<<"\n";
-
-    stream << "       chart.load({"<<"\n";
-    stream << "           columns: ["<<"\n";
-    stream << "           xSurfaceVel,"<<"\n";
-    if(simulationD==3)
-    {stream <<"           ySurfaceVelx1,"<<"\n";
-        stream <<"           ySurfaceVelx2"<<"\n";
-    }else {
-        stream <<"           ySurfaceVel"<<"\n";
-    }
-    stream <<"           ]"<<"\n";
-    stream <<"       });"<<"\n";
-
-    stream <<"       chart.unload({"<<"\n";
-    stream <<"           ids: 'Demo motion 1'"<<"\n";
-    stream <<"       });"<<"\n";
-    stream <<"       chart.unload({"<<"\n";
-    stream <<"           ids: 'Demo motion 2'"<<"\n";
-    stream <<"       });"<<"\n";
-    stream <<"       }, 500);"<<"\n";
-    return text;
-
-}
-
 void TabManager::updatePostProcessor(PostProcessor *postProcessort)
 {
     postProcessor = postProcessort;
+    plotData->setPostProcessor(postProcessort);
 }
 
-QString TabManager::loadNodeResponse(QString motion)
-{
-
-    QVector<QVector<double>> *v;
-    if(motion=="acc")
-    {
-        v = postProcessor->getaccAll();
-    }
-    else if (motion=="vel")
-    {
-        v = postProcessor->getvelAll();
-    }
-    else if (motion=="disp")
-    {
-        v = postProcessor->getdispAll();
-    }
-    else
-        qWarning("motion must be acc, vel or disp!");
-
-
-    QString text;
-    QTextStream stream(&text);
-
-
-
-    if(v->size()>0)
-    {
-        //int overStep = int(floor((*v)[0].size()/maxStepToShow));
-
-        stream << "time = ['x'";
-        for (int i=0; i<(*v)[0].size(); i+=overStep)
-            stream << ", "<<(*v)[0][i];
-        stream <<"];" <<"\n";
-
-        int eleID = elementModel->getSize();
-        for (int j=7;j<v->size();j+=4)
-        {
-            eleID -= 1;
-            if(simulationD==2)
-            {
-                stream << "n"+QString::number(eleID)+" = ['Node "+QString::number(eleID)+"'";
-                for (int i=0; i<(*v)[j].size(); i+=overStep)
-                    stream << ", "<<(*v)[j][i];
-                stream <<"];" <<"\n";
-            }else {
-                stream << "n"+QString::number(eleID)+"x1 = ['Node "+QString::number(eleID)+"-x1'";
-                for (int i=0; i<(*v)[j].size(); i+=overStep)
-                    stream << ", "<<(*v)[j][i];
-                stream <<"];" <<"\n";
-                stream << "n"+QString::number(eleID)+"x2 = ['Node "+QString::number(eleID)+"-x2'";
-                for (int i=0; i<(*v)[j+1].size(); i+=overStep)
-                    stream << ", "<<(*v)[j+1][i];
-                stream <<"];" <<"\n";
-            }
-        }
-
-    }
-
-
-    return text;
-
-}
-
-
-QString TabManager::loadNodeSa()
-{   // TODO: this function is too spaghetti....
-
-    QVector<QVector<double>> *v = postProcessor->getaccAll();
-    QVector<QVector<double>> *saVec = postProcessor->getSa();
-    QVector<double> *Periods = postProcessor->getPeriods();
-
-
-    QString text;
-    QTextStream stream(&text);
-
-    if(v->size()>0)
-    {
-        stream << "xnew = ['x'";
-        for (int i=0; i<Periods->size(); i++)
-            stream << ", "<< (*Periods)[i];
-        stream <<"];" <<"\n";
-
-        stream << "ynew = ['Rock'";
-        for (int i=0; i<(*saVec)[0].size(); i++)
-            stream << ", "<<(*saVec)[0][i];
-        stream <<"];" <<"\n";
-
-        stream << "time = ['x'";
-        for (int i=0; i<Periods->size(); i++)
-            stream << ", "<<(*Periods)[i];
-        stream <<"];" <<"\n";
-
-
-        int eleID = elementModel->getSize()+1;
-        for (int j=0;j<saVec->size();j++)
-        {
-            eleID -= 1;
-            //stream << "n1 = ['Node 1'";
-            stream << "n"+QString::number(eleID)+" = ['Node "+QString::number(eleID)+"'";
-            //stream << "n"+QString::number(eleID)+" = ['Node marked by <'";
-            for (int i=0; i<(*saVec)[j].size(); i++)
-                stream << ", "<<(*saVec)[j][i];
-            stream <<"];" <<"\n";
-        }
-
-    }else
-        return "";
-
-
-    return text;
-
-
-}
-
-
-QString TabManager::loadPWPResponse()
-{
-
-    QFile File(postProcessor->getPWPFileName());
-
-    QVector<QVector<double>> v;
-    if(File.open(QIODevice::ReadOnly)) {
-        QTextStream in(&File);
-        int lineCount = 0;
-        int numCols = 0;
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            thisLine.removeAll("");
-            int sizeThisLine = thisLine.size();
-            lineCount += 1;
-            if (lineCount==1)
-                numCols = sizeThisLine;
-            if (sizeThisLine != numCols && lineCount>1)
-            {
-                lineCount -= 1;
-                break;
-            }
-            else
-            {
-                //thisLine.removeAll("");
-                for (int i=0; i<thisLine.size();i++)// TODO: 3D?
-                {
-                    if (lineCount==1)
-                    {
-                        QVector<double> tmpV;
-                        v.append(tmpV);
-                    }
-                    v[i].append((thisLine[i].trimmed().toDouble()));
-                }
-            }
-        }
-        File.close();
-    }
-
-    QString text;
-    QTextStream stream(&text);
-
-    if(v.size()>0)
-    {
-
-        //int overStep = int(floor(v[0].size()/maxStepToShow));
-        stream << "xnew = ['x'";
-        for (int i=0; i<v[0].size(); i+=overStep)
-            stream << ", "<<v[0][i];
-        stream <<"];" <<"\n";
-
-        stream << "ynew = ['Rock'";
-        for (int i=0; i<v[2].size(); i+=overStep)
-            stream << ", "<<v[2][i];
-        stream <<"];" <<"\n";
-
-
-        stream << "time = ['x'";
-        for (int i=0; i<v[0].size(); i+=overStep)
-            stream << ", "<<v[0][i];
-        stream <<"];" <<"\n";
-
-
-        int eleID = elementModel->getSize();
-        int startind = simulationD==3 ? 8 : 4;
-        int thisstep = simulationD==3 ? 4 : 2;
-        for (int j=startind;j<v.size();j+=thisstep)
-        {
-            eleID -= 1;
-            //stream << "n1 = ['Node 1'";
-            stream << "pwp"+QString::number(eleID)+" = ['Node "+QString::number(eleID)+"'";
-            //stream << "pwp"+QString::number(eleID)+" = ['Node marked by <'";
-            for (int i=0; i<v[j].size(); i+=overStep)
-                stream << ", "<<v[j][i];
-            stream <<"];" <<"\n";
-        }
-    }
-
-
-    return text;
-
-}
-
-QString TabManager::loadruPWPResponse()
-{
-
-    QFile File(postProcessor->getPWPFileName());
-
-    QVector<QVector<double>> v;
-    if(File.open(QIODevice::ReadOnly)) {
-        QTextStream in(&File);
-        int lineCount = 0;
-        int numCols = 0;
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            thisLine.removeAll("");
-            int sizeThisLine = thisLine.size();
-            lineCount += 1;
-            if (lineCount==1)
-                numCols = sizeThisLine;
-            if (sizeThisLine != numCols && lineCount>1)
-            {
-                lineCount -= 1;
-                break;
-            }
-            else
-            {
-                //thisLine.removeAll("");
-                for (int i=0; i<thisLine.size();i++)// TODO: 3D?
-                {
-                    if (lineCount==1)
-                    {
-                        QVector<double> tmpV;
-                        v.append(tmpV);
-                    }
-                    v[i].append((thisLine[i].trimmed().toDouble()));
-                }
-            }
-        }
-        File.close();
-    }
-
-    QString text;
-    QTextStream stream(&text);
-    QVector<double> v1 = postProcessor->getInitialStress();
-
-    if(v.size()>0)
-    {
-
-        //int overStep = int(floor(v[0].size()/maxStepToShow));
-        stream << "time = ['x'";
-        for (int i=0; i<v[0].size(); i+=overStep)
-            stream << ", "<<v[0][i];
-        stream <<"];" <<"\n";
-
-
-        int eleID = elementModel->getSize();
-        int eleInd = -1;
-        int jinit = simulationD==3 ? 8 : 4;
-        int jstep = simulationD==3 ? 4 : 2;
-        for (int j=jinit;j<v.size();j+=jstep)
-        {
-            eleID -= 1;
-            //stream << "n1 = ['Node 1'";
-            stream << "rupwp"+QString::number(eleID)+" = ['Element "+QString::number(eleID)+"'";
-            eleInd += 1;
-
-            for (int i=0; i<v[j].size(); i+=overStep)
-            {
-                /*
-                double thisepwp = (v[j][i]-v[j][0]);
-                double thissigma = m_vStress[eleInd*3+1+2][i];
-                if(fabs(thisepwp)<1.e-16)
-                    stream << ", "<<0;
-                else{
-                    if(fabs(thissigma)<1e-16)
-                    {
-                        thissigma = 1e-16;
-                        stream << ", "<<thisepwp/thissigma;
-                    }else
-                        stream << ", "<<thisepwp/thissigma;
-                }
-                */
-
-                double thisepwp = - (v[j][i]-v[j][0]) / v1[eleInd];
-                stream << ", "<<thisepwp;
-            }
-            stream <<"];" <<"\n";
-        }
-    }
-
-
-    return text;
-
-}
-
-
-QVector<QVector<double>> TabManager::getElemResVec(QString fileName)
+void TabManager::setSimulationD(int d)
 {
-    QFile File(fileName);
-
-    QVector<QVector<double>> v;
-    if(File.open(QIODevice::ReadOnly)) {
-        QTextStream in(&File);
-        int lineCount = 0;
-        int numCols = 0;
-        while(!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList thisLine = line.split(" ");
-            thisLine.removeAll("");
-            int sizeThisLine = thisLine.size();
-            lineCount += 1;
-            if (lineCount==1)
-                numCols = sizeThisLine;
-            if (sizeThisLine != numCols && lineCount>1)
-            {
-                lineCount -= 1;
-                break;
-            }
-            else
-            {
-                //thisLine.removeAll("");
-                for (int i=0; i<thisLine.size();i++)// TODO: 3D?
-                {
-                    if (lineCount==1)
-                    {
-                        QVector<double> tmpV;
-                        v.append(tmpV);
-                    }
-                    v[i].append((thisLine[i].trimmed().toDouble()));
-                }
-            }
-        }
-        File.close();
-    }
-    return v;
+    simulationD = d;
+    plotData->setSimulationD(d);
 }
 
-QString TabManager::loadEleResponse(QString motion)
+void TabManager::registerPlotData(QWebChannel *channel)
 {
-
-    QString fileName;
-    QString stressFileName = postProcessor->getStressFileName();
-    QString strainFileName = postProcessor->getStrainFileName();
-    QVector<QVector<double>> vStress = getElemResVec(stressFileName);
-    QVector<QVector<double>> vStrain = getElemResVec(strainFileName);
-
-    if (motion=="strain")
-    {
-        fileName = postProcessor->getStrainFileName();
-        vStrain = getElemResVec(fileName);
-    }
-    else if (motion=="stress")
-    {
-        fileName = postProcessor->getStressFileName();
-        vStress = getElemResVec(fileName);
-        m_vStress.clear();
-        m_vStress = vStress;
-    }
-    else if (motion=="stressstrain")
-    {
-        QString stressFileName = postProcessor->getStressFileName();
-        QString strainFileName = postProcessor->getStrainFileName();
-        vStress = getElemResVec(stressFileName);
-        vStrain = getElemResVec(strainFileName);
-    }
-
-    QVector<QVector<double>> v;
-
-
-
-    QString text;
-    QTextStream stream(&text);
-
-    if(vStress.size()>0)
-    {
-        //int overStep = int(floor(vStress[0].size()/maxStepToShow));
-        stream << "time = ['x'";
-        for (int i=0; i<vStress[0].size(); i+=overStep)
-            stream << ", "<<vStress[0][i];
-        stream <<"];" <<"\n";
-
-        QString outTitle;
-        if(motion=="strain")
-        {
-            outTitle = "Strain";
-            v = vStrain;
-        }
-        else if(motion=="stress")
-        {
-            outTitle="Stress";
-            v = vStress;
-        }
-        else if(motion=="stressstrain")
-            outTitle="StressStrain";
-
-        int startind = simulationD==3 ? 4 : 3;
-        int thisstep = simulationD==3 ? 6 : 3;
-        if(motion!="stressstrain")
-        {
-            int eleID = elementModel->getSize();
-            for (int j=startind;j<v.size();j+=thisstep)
-            {
-                eleID -= 1;
-                //stream << "n1 = ['Node 1'";
-                if(simulationD==2)
-                {
-                    stream << outTitle+QString::number(eleID)+" = ['Element "+QString::number(eleID)+"'";
-                    //stream << "pwp"+QString::number(eleID)+" = ['Node marked by <'";
-                    for (int i=0; i<v[j].size(); i+=overStep)
-                        stream << ", "<<v[j][i];
-                    stream <<"];" <<"\n";
-                }
-                else
-                {
-                    stream << outTitle+"12"+QString::number(eleID)+" = ['Element "+QString::number(eleID)+" (12)'";
-                    //stream << "pwp"+QString::number(eleID)+" = ['Node marked by <'";
-                    for (int i=0; i<v[j].size(); i+=overStep)
-                        stream << ", "<<v[j][i];
-                    stream <<"];" <<"\n";
-                    stream << outTitle+"23"+QString::number(eleID)+" = ['Element "+QString::number(eleID)+" (23)'";
-                    //stream << "pwp"+QString::number(eleID)+" = ['Node marked by <'";
-                    for (int i=0; i<v[j+1].size(); i+=overStep)
-                        stream << ", "<<v[j+1][i];
-                    stream <<"];" <<"\n";
-                    stream << outTitle+"13"+QString::number(eleID)+" = ['Element "+QString::number(eleID)+" (13)'";
-                    //stream << "pwp"+QString::number(eleID)+" = ['Node marked by <'";
-                    for (int i=0; i<v[j+2].size(); i+=overStep)
-                        stream << ", "<<v[j+2][i];
-                    stream <<"];" <<"\n";
-                }
-            }
-        }else{
-
-            int eleID = elementModel->getSize();
-            for (int j=startind;j<vStress.size();j+=thisstep)
-            {
-                eleID -= 1;
-                if(simulationD==2)
-                {
-                    stream << "Stress"+QString::number(eleID)+" = ['Element "+QString::number(eleID)+"'";
-                    for (int i=0; i<vStress[j].size(); i+=overStep)
-                    {
-                        stream << ", "<<vStress[j][i] ;
-                    }
-                    stream <<"];" <<"\n";
-
-                    stream << "Strain"+QString::number(eleID)+" = ['x'";
-                    for (int i=0; i<vStrain[j].size(); i+=overStep)
-                    {
-                        stream << ", "<<vStrain[j][i] ;
-                    }
-                    stream <<"];" <<"\n";
-                }else {
-                    stream << "Stress12"+QString::number(eleID)+" = ['Element "+QString::number(eleID)+" (12)'";
-                    for (int i=0; i<vStress[j].size(); i+=overStep)
-                    {
-                        stream << ", "<<vStress[j][i] ;
-                    }
-                    stream <<"];" <<"\n";
-                    stream << "Stress23"+QString::number(eleID)+" = ['Element "+QString::number(eleID)+" (23)'";
-                    for (int i=0; i<vStress[j+1].size(); i+=overStep)
-                    {
-                        stream << ", "<<vStress[j+1][i] ;
-                    }
-                    stream <<"];" <<"\n";
-                    stream << "Stress13"+QString::number(eleID)+" = ['Element "+QString::number(eleID)+" (13)'";
-                    for (int i=0; i<vStress[j+2].size(); i+=overStep)
-                    {
-                        stream << ", "<<vStress[j+2][i] ;
-                    }
-                    stream <<"];" <<"\n";
-
-                   //stream << "Strain12"+QString::number(eleID)+" = ['Elementx "+QString::number(eleID)+" (12)'";
-                    stream << "Strain12"+QString::number(eleID)+" = ['x"+QString::number(eleID)+"12'";
-                    for (int i=0; i<vStrain[j].size(); i+=overStep)
-                    {
-                        stream << ", "<<vStrain[j][i] ;
-                    }
-                    stream <<"];" <<"\n";
-
-                    //stream << "Strain12"+QString::number(eleID)+" = ['Elementx "+QString::number(eleID)+" (13)'";
-                    stream << "Strain23"+QString::number(eleID)+" = ['x"+QString::number(eleID)+"23'";
-                    for (int i=0; i<vStrain[j+1].size(); i+=overStep)
-                    {
-                        stream << ", "<<vStrain[j+1][i] ;
-                    }
-                    stream <<"];" <<"\n";
-
-                    //stream << "Strain12"+QString::number(eleID)+" = ['Elementx "+QString::number(eleID)+" (23)'";
-                    stream << "Strain13"+QString::number(eleID)+" = ['x"+QString::number(eleID)+"13'";
-                    for (int i=0; i<vStrain[j+1].size(); i+=overStep)
-                    {
-                        stream << ", "<<vStrain[j+1][i] ;
-                    }
-                    stream <<"];" <<"\n";
-
-                }
-            }
-        }
-    }
-
-
-    return text;
-
-
-
+    channel->registerObject(QStringLiteral("elementModel"), elementModel);
+    channel->registerObject(QStringLiteral("plotData"), plotData);
 }
 
 bool TabManager::writeSurfaceMotion()
@@ -2673,7 +1409,7 @@ void TabManager::onTableViewClicked(const QModelIndex &index){
     //tab->insertTab(0,FEMWidget,"Quickstart");
     //tab->insertTab(1,FEMWidget,"Configure");
     tab->insertTab(1,currentWidget,"Layer properties");
-   // tab->insertTab(2,GMView,"Response");
+    tab->insertTab(2,GMView,"Response");
     //tab->insertTab(3,quickstart,"Chat");
     tab->setCurrentIndex(1);
 
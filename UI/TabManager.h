@@ -9,6 +9,9 @@ class QTabWidget;
 class QDialog;
 class QLineEdit;
 class QLabel;
+class QWebChannel;
+class QWebEngineView;
+class PlotDataProvider;
 
 #include <QDialog>
 #include <QModelIndex>
@@ -23,7 +26,6 @@ public:
     explicit TabManager(QWidget *parent = nullptr);
     TabManager(BonzaTableView *tableView,ElementModel *emodel,QWidget *parent = nullptr);
     void init(QTabWidget* theTab);
-    void initGMTab();
     void fillMatTab(QString ,const QModelIndex &index);
     void cleanForm(QVector<QLineEdit*> currentEdts);
     void checkDefaultFEM(QString thisMatType,const QModelIndex &index);
@@ -33,33 +35,18 @@ public:
     void reFreshGMTab();
     void writeGM();
     void writeGMVintage();
-    QString loadGMtoStringVintage();
     bool writeSurfaceMotion();
-    QString loadGMtoString();
-    QString loadMotions2String(QString);
-    QString loadPWPResponse();
-    QString loadruPWPResponse();
-    QString loadNodeSa();
-    QString loadEleResponse(QString);
-    QString loadNodeResponse(QString);
     QTabWidget* getTab(){return tab;}
     void hideConfigure();
     QString openseespath(){return openseesPathStr;}
     QString rockmotionpath(){return GMPathStr;}
-    void updateVelHtml();
-    void updateDispHtml();
-    void updateAccHtml();
-    void updatePWPHtml();
-    void updateRupwpHtml();
-    void updateSaHtml();
-    void updateStrainHtml();
-    void updateStressHtml();
-    void updateStressStrainHtml();
   //    void reFreshGMView(){GMView->show();}
     void setPM4SandToolTps();
     void updatePostProcessor(PostProcessor *postProcessort);
+    // serves the result charts of results.html
+    PlotDataProvider *plotDataProvider() {return plotData;}
+    void registerPlotData(QWebChannel *channel);
   //    void setGMViewLoaded(){GMViewLoaded = true;}
-    QVector<QVector<double>> getElemResVec(QString);
     QCheckBox *dimCheckBox;
 
 signals:
@@ -92,7 +79,7 @@ public slots:
     int getCurrentD() {return currentD;}
     int getSimulationD () {return simulationD;}
     void setCurrentD(int d) { currentD = d;}
-    void setSimulationD (int d) { simulationD = d;}
+    void setSimulationD (int d);
     bool is2Dmotion(){ return dimCheckBox->isChecked() ? true : false; }
     bool updateConfigureTabFromOutside(QString, QString);
 
@@ -106,6 +93,7 @@ private:
     BonzaTableModel *tableModel = nullptr;
     ElementModel* elementModel = nullptr;
     PostProcessor *postProcessor = nullptr;
+    PlotDataProvider *plotData = nullptr;
 
     //QFile uiFilePM4Sand;
     //QFile uiFileElasticIsotropic;
@@ -128,7 +116,7 @@ private:
     QDialog* ElasticRandomWidget = nullptr;
 
     QWidget *quickstart = nullptr;
-  //    QWebEngineView *GMView;
+    QWebEngineView *GMView = nullptr;
     QString GMPathStr;
 
     QWidget* currentWidget = nullptr;
@@ -209,21 +197,6 @@ private:
 
     QString thisMatType;
     QString qsHtmlName;
-    QString GMTabHtmlName;
-    QString accHtmlName;
-    QString dispHtmlName;
-    QString pwpHtmlName;
-    QString rupwpHtmlName;
-    QString strainHtmlName;
-    QString stressHtmlName;
-
-    QString GMTabHtmlNameTmp;
-    QString accHtmlNameTmp;
-    QString dispHtmlNameTmp;
-    QString pwpHtmlNameTmp;
-    QString rupwpHtmlNameTmp;
-    QString strainHtmlNameTmp;
-    QString stressHtmlNameTmp;
 
 
     QString openseesPathStr;
@@ -235,10 +208,9 @@ private:
 
   //    bool GMViewLoaded = false;
 
-    int maxStepToShow = 300;
-    int overStep = 1;
-
-    QVector<QVector<double>> m_vStress;
+    // samples per trace in the charts are limited to 4 per bucket (see MinMaxPyramid.h),
+    // about one bucket per pixel column of the chart
+    int plotBuckets = 500;
 
     int currentD = 2; // 2 is 2D, 3 is 3D
     int simulationD = 2; // dim in previous simulation
@@ -0,0 +1,91 @@
+# Stand-in for the OpenSees commands model.tcl uses, enough to follow the
+# gravity checkpoint logic without OpenSees: the domain is a list of node and
+# element tags and a time, database/save/restore write and read it, and the
+# commands that need a model builder fail without one, as in OpenSees after
+# wipe or restore.
+
+set stub(builder) {}
+set stub(nodes) {}
+set stub(elements) {}
+set stub(time) 0.0
+set stub(database) {}
+set stub(analyzed) 0
+
+proc stubNeedsBuilder {cmd} {
+    global stub
+    if {$stub(builder) eq {}} {
+        error "$cmd: no model builder (model BasicBuilder) defined"
+    }
+}
+
+proc wipe {} {
+    global stub
+    set stub(builder) {}
+    set stub(nodes) {}
+    set stub(elements) {}
+    set stub(time) 0.0
+    set stub(database) {}
+}
+
+proc model {type args} {
+    global stub
+    array set opt $args
+    set stub(builder) [list $opt(-ndm) $opt(-ndf)]
+}
+
+proc node {tag args} {
+    global stub
+    stubNeedsBuilder node
+    set ndm [lindex $stub(builder) 0]
+    if {[llength $args] < $ndm} {
+        error "node $tag: $ndm coordinates expected"
+    }
+    lappend stub(nodes) $tag
+}
+
+proc element {type tag args} {
+    global stub
+    stubNeedsBuilder element
+    lappend stub(elements) $tag
+}
+
+foreach cmd {fix equalDOF uniaxialMaterial nDMaterial pattern mass timeSeries} {
+    proc $cmd {args} "stubNeedsBuilder $cmd"
+}
+
+proc database {type fileName} {
+    global stub
+    set stub(database) $fileName
+}
+
+proc save {commitTag} {
+    global stub
+    set f [open $stub(database) w]
+    puts $f [list $stub(nodes) $stub(elements) $stub(time)]
+    close $f
+}
+
+proc restore {commitTag} {
+    global stub
+    set f [open $stub(database) r]
+    set state [read $f]
+    close $f
+    lassign $state stub(nodes) stub(elements) stub(time)
+}
+
+proc getNodeTags {} { global stub; return $stub(nodes) }
+proc getEleTags {} { global stub; return $stub(elements) }
+proc getTime {} { global stub; return $stub(time) }
+proc setTime {t} { global stub; set stub(time) $t }
+
+proc analyze {numSteps {dt 0.0}} {
+    global stub
+    set stub(time) [expr {$stub(time) + $numSteps * $dt}]
+    incr stub(analyzed) $numSteps
+    return 0
+}
+
+proc testIter {} { return 2 }
+
+# the other commands (analysis options, recorders, parameters) are accepted
+proc unknown {args} { return 0 }
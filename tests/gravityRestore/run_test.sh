@@ -0,0 +1,19 @@
+#!/bin/sh
+# Restored-run test of the gravity checkpoint (basicSettings "reuseGravity").
+#   tests/gravityRestore/run_test.sh path/to/s3hark
+# Writes model.tcl for the 2D fixture profile and runs it with test_restore.tcl.
+
+S3HARK=${1:-bin/s3hark}
+HERE=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+mkdir -p "$WORK/work/out_tcl"
+cp "$HERE/Rock-x.vel" "$HERE/Rock-x.time" "$WORK/work/"
+"$S3HARK" "$HERE/SRT.json" "$WORK/work" "$WORK/work/out_tcl" "$WORK/log" > "$WORK/s3hark.out" 2>&1
+if [ ! -f "$WORK/work/model.tcl" ]; then
+    cat "$WORK/s3hark.out"
+    echo "FAIL model.tcl was not written"
+    exit 1
+fi
+tclsh "$HERE/test_restore.tcl" "$WORK/work/model.tcl"
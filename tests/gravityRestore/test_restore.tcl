@@ -0,0 +1,77 @@
+# tclsh test_restore.tcl model.tcl
+#
+# Sources model.tcl (written with a gravity checkpoint directory) three times
+# with the OpenSees stand-in of opensees_stub.tcl: the first run saves the
+# checkpoint, the second restores it and must still build the compliant base
+# and run the dynamic stage, the third finds a checkpoint that does not match
+# and runs gravity again. A fourth run with checkpointDir set by the caller
+# (a batch job whose shared gravity stage failed) saves its own checkpoint.
+
+set script [file normalize [lindex $argv 0]]
+set stubFile [file join [file dirname [file normalize [info script]]] opensees_stub.tcl]
+set failures 0
+
+# one OpenSees run: returns {restored gravitySteps finished error}
+proc runModel {script stubFile {setup {}}} {
+    set i [interp create]
+    $i eval [list source $stubFile]
+    $i eval $setup
+    $i eval {
+        set finished 0
+        proc exit {args} { global finished; set finished 1; return -code return }
+        # the messages of the run to stdout are dropped, files are written
+        rename puts stubPuts
+        proc puts {args} {
+            if {[llength $args] > 1 && [lindex $args 0] ne "-nonewline"} {
+                stubPuts {*}$args
+            }
+        }
+    }
+    $i eval [list cd [file dirname $script]]
+    set err {}
+    if {[catch {$i eval [list source $script]} msg]} {
+        set err $msg
+    } else {
+        # the 3D script ends without exit
+        $i eval {set finished 1}
+    }
+    set result [list [$i eval {expr {[info exists restored] ? $restored : -1}}] \
+                     [$i eval {set stub(analyzed)}] [$i eval {set finished}] $err]
+    interp delete $i
+    return $result
+}
+
+proc check {name condition} {
+    global failures
+    if {[uplevel 1 [list expr $condition]]} {
+        puts "ok   $name"
+    } else {
+        puts "FAIL $name"
+        incr failures
+    }
+}
+
+file delete -force [file join [file dirname $script] gravity]
+
+lassign [runModel $script $stubFile] restored steps finished err
+check "first run saves the checkpoint ($err)" {$err eq {} && $finished && !$restored}
+set fullSteps $steps
+
+lassign [runModel $script $stubFile] restored steps finished err
+check "second run restores and finishes ($err)" {$err eq {} && $finished && $restored}
+check "second run skips the gravity steps" {$steps < $fullSteps}
+
+foreach done [glob [file join [file dirname $script] gravity * done]] {
+    set f [open $done w]
+    puts $f "[lindex [split [file dirname $done] /] end] 1 1 0.0"
+    close $f
+}
+lassign [runModel $script $stubFile] restored steps finished err
+check "a checkpoint that does not match runs gravity again ($err)" {$err eq {} && $finished && !$restored && $steps == $fullSteps}
+
+set own [file join [file dirname $script] ownGravity]
+file delete -force $own
+lassign [runModel $script $stubFile [list set checkpointDir $own]] restored steps finished err
+check "a caller's checkpointDir gets its own checkpoint ($err)" {$err eq {} && $finished && !$restored && [llength [glob -nocomplain [file join $own * done]]] == 1}
+
+exit [expr {$failures != 0}]